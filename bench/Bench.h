@@ -0,0 +1,43 @@
+#ifndef Bench_h
+#define Bench_h
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+// Shared bits of the benchmarks. Each benchmark checks its own results and
+// exits non-zero if one is wrong, so a fast but broken path never reports a
+// number.
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+    // Fastest of `runs` calls of fn(), in nanoseconds. The minimum is the
+    // figure least disturbed by whatever else the machine is doing.
+    template<typename Fn>
+    double bestOf(const int runs, Fn &&fn) {
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < runs; ++run) {
+            const auto start = Clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        return best;
+    }
+
+    inline bool check(const bool ok, const char *what) {
+        if (!ok) {
+            std::printf("FAILED: %s\n", what);
+        }
+        return ok;
+    }
+
+    // Keeps a computed value alive so the optimizer cannot drop the work.
+    template<typename T>
+    void keep(const T &value) {
+        static volatile T sink;
+        sink = value;
+    }
+}
+
+#endif
@@ -0,0 +1,249 @@
+// Size and speed of SeriesCodec on series shaped like the ones MetricHistory
+// and SnapshotRecorder store, after checking that random series round-trip
+// bit for bit. Given a recording's base path (as given to processlited
+// --record), it also reports the bytes per sample of every process's series
+// in that recording.
+
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <ranges>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Bench.h"
+#include "Recording/SeriesCodec.h"
+#include "Recording/SnapshotReader.h"
+
+namespace {
+    constexpr size_t Samples = 600;  // one MetricHistory ring
+    constexpr int Runs = 2000;
+
+    bool roundTrips(std::mt19937_64 &rng) {
+        for (int trial = 0; trial < 2000; ++trial) {
+            const size_t count = rng() % 700;
+
+            // Runs, repeats, zeros and arbitrary bit patterns (NaNs included).
+            std::vector<double> doubles(count);
+            double value = 0;
+            for (double &x: doubles) {
+                switch (rng() % 4) {
+                    case 0: value = static_cast<double>(rng() % 10000) / 100.0; break;
+                    case 1: value = std::bit_cast<double>(rng()); break;
+                    case 2: value = 0; break;
+                    default: break;
+                }
+                x = value;
+            }
+            std::vector<uint8_t> bytes;
+            codec::encodeDoubles(doubles, bytes);
+            std::vector<double> decoded(count);
+            if (codec::decodeDoubles(bytes, count, decoded.data()) != (count ? bytes.size() : 0)) {
+                return false;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (std::bit_cast<uint64_t>(decoded[i]) != std::bit_cast<uint64_t>(doubles[i])) {
+                    return false;
+                }
+            }
+
+            std::vector<uint64_t> integers(count);
+            uint64_t counter = rng();
+            for (uint64_t &x: integers) {
+                if (rng() % 3) {
+                    counter += rng() % 1000;
+                }
+                if (rng() % 50 == 0) {
+                    counter = rng();
+                }
+                x = counter;
+            }
+            for (const auto order: {codec::IntegerOrder::Delta, codec::IntegerOrder::DeltaOfDelta}) {
+                bytes.clear();
+                codec::encodeIntegers(std::span<const uint64_t>(integers), order, bytes);
+                std::vector<uint64_t> back(count);
+                if (codec::decodeIntegers(bytes, count, order, back.data()) != bytes.size() || back != integers) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void report(const char *series, const size_t rawBytes, const size_t encodedBytes, const double encodeNs,
+                const double decodeNs) {
+        std::printf("%-10s %5zu -> %4zu bytes (%5.1fx)  encode %6.1f M samples/s  decode %6.1f M samples/s\n",
+                    series, rawBytes, encodedBytes, static_cast<double>(rawBytes) / static_cast<double>(encodedBytes),
+                    Samples / encodeNs * 1e3, Samples / decodeNs * 1e3);
+    }
+
+    // One process's samples over its life in the recording.
+    struct RecordedSeries {
+        std::vector<double> cpu;
+        std::vector<uint64_t> ram;
+        std::vector<double> io;
+    };
+
+    struct SeriesTotals {
+        size_t samples = 0;
+        size_t cpuBytes = 0;
+        size_t ramBytes = 0;
+        size_t ioBytes = 0;
+    };
+
+    // Encodes each series the way MetricHistory::compressSeries does, after
+    // checking it decodes back to the same samples.
+    bool encodeSeries(const RecordedSeries &series, SeriesTotals &totals) {
+        const size_t count = series.cpu.size();
+        std::vector<uint8_t> bytes;
+        std::vector<double> doubles(count);
+        codec::encodeDoubles(series.cpu, bytes);
+        if (codec::decodeDoubles(bytes, count, doubles.data()) != bytes.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (std::bit_cast<uint64_t>(doubles[i]) != std::bit_cast<uint64_t>(series.cpu[i])) {
+                return false;
+            }
+        }
+        totals.cpuBytes += bytes.size();
+
+        bytes.clear();
+        codec::encodeIntegers(std::span<const uint64_t>(series.ram), codec::IntegerOrder::Delta, bytes);
+        std::vector<uint64_t> integers(count);
+        if (codec::decodeIntegers(bytes, count, codec::IntegerOrder::Delta, integers.data()) != bytes.size() ||
+            integers != series.ram) {
+            return false;
+        }
+        totals.ramBytes += bytes.size();
+
+        bytes.clear();
+        codec::encodeDoubles(series.io, bytes);
+        totals.ioBytes += bytes.size();
+        totals.samples += count;
+        return true;
+    }
+
+    // Rebuilds every process's series from the recording's ticks. A PID's
+    // series ends when the PID is removed, so a reused PID starts a new one.
+    bool reportRecording(const std::wstring &basePath) {
+        SnapshotReader reader(basePath);
+        if (!reader.isOpen()) {
+            std::printf("cannot open the recording\n");
+            return false;
+        }
+        std::unordered_map<uint32_t, RecordedSeries> open;
+        SeriesTotals totals;
+        uint64_t ticks = 0;
+        bool ok = true;
+        SnapshotReader::Tick tick;
+        while (reader.next(tick)) {
+            ++ticks;
+            for (const uint32_t pid: tick.removed) {
+                if (const auto it = open.find(pid); it != open.end()) {
+                    ok &= encodeSeries(it->second, totals);
+                    open.erase(it);
+                }
+            }
+            for (size_t row = 0; row < tick.pids.size(); ++row) {
+                RecordedSeries &series = open[tick.pids[row]];
+                series.cpu.push_back(tick.cpu[row]);
+                series.ram.push_back(tick.ram[row]);
+                series.io.push_back(tick.io[row]);
+            }
+        }
+        for (const auto &series: open | std::views::values) {
+            ok &= encodeSeries(series, totals);
+        }
+        if (!bench::check(ok, "recorded series do not round-trip")) {
+            return false;
+        }
+        if (totals.samples == 0) {
+            std::printf("recording has no samples\n");
+            return true;
+        }
+
+        const auto perSample = [&totals](const size_t bytes) {
+            return static_cast<double>(bytes) / static_cast<double>(totals.samples);
+        };
+        std::printf("recording: %llu ticks, %zu samples per metric\n", static_cast<unsigned long long>(ticks),
+                    totals.samples);
+        std::printf("%-10s %5.2f bytes/sample (%5.1fx)\n", "cpu", perSample(totals.cpuBytes),
+                    8.0 / perSample(totals.cpuBytes));
+        std::printf("%-10s %5.2f bytes/sample (%5.1fx)\n", "ram", perSample(totals.ramBytes),
+                    8.0 / perSample(totals.ramBytes));
+        std::printf("%-10s %5.2f bytes/sample (%5.1fx)\n", "io", perSample(totals.ioBytes),
+                    8.0 / perSample(totals.ioBytes));
+        return true;
+    }
+}
+
+int wmain(const int argc, wchar_t **argv) {
+    std::mt19937_64 rng(7);
+    if (!bench::check(roundTrips(rng), "series do not round-trip")) {
+        return 1;
+    }
+
+    // A mostly idle process: a short burst once a minute, zero otherwise.
+    std::vector<double> cpu(Samples);
+    for (size_t i = 0; i < Samples; ++i) {
+        cpu[i] = i % 60 < 5 ? static_cast<double>(rng() % 500) / 10.0 : 0.0;
+    }
+    // A working set that grows by a page now and then.
+    std::vector<uint64_t> ram(Samples);
+    uint64_t workingSet = 48ull << 20;
+    for (uint64_t &x: ram) {
+        workingSet += rng() % 3 == 0 ? 4096 : 0;
+        x = workingSet;
+    }
+    // FILETIME ticks one second apart, with the odd late one.
+    std::vector<int64_t> timestamps(Samples);
+    for (size_t i = 0; i < Samples; ++i) {
+        timestamps[i] = 133000000000000000ll + static_cast<int64_t>(i) * 10000000ll + (i % 97 == 0 ? 15000 : 0);
+    }
+
+    std::vector<uint8_t> bytes;
+    std::vector<double> doubles(Samples);
+    const double cpuEncode = bench::bestOf(Runs, [&] {
+        bytes.clear();
+        codec::encodeDoubles(cpu, bytes);
+    });
+    const double cpuDecode = bench::bestOf(Runs, [&] { codec::decodeDoubles(bytes, Samples, doubles.data()); });
+    if (!bench::check(doubles == cpu, "cpu series")) {
+        return 1;
+    }
+    report("cpu", Samples * sizeof(double), bytes.size(), cpuEncode, cpuDecode);
+
+    std::vector<uint64_t> integers(Samples);
+    const double ramEncode = bench::bestOf(Runs, [&] {
+        bytes.clear();
+        codec::encodeIntegers(std::span<const uint64_t>(ram), codec::IntegerOrder::Delta, bytes);
+    });
+    const double ramDecode = bench::bestOf(Runs, [&] {
+        codec::decodeIntegers(bytes, Samples, codec::IntegerOrder::Delta, integers.data());
+    });
+    if (!bench::check(integers == ram, "ram series")) {
+        return 1;
+    }
+    report("ram", Samples * sizeof(uint64_t), bytes.size(), ramEncode, ramDecode);
+
+    std::vector<int64_t> times(Samples);
+    const double timeEncode = bench::bestOf(Runs, [&] {
+        bytes.clear();
+        codec::encodeIntegers(timestamps, codec::IntegerOrder::DeltaOfDelta, bytes);
+    });
+    const double timeDecode = bench::bestOf(Runs, [&] {
+        codec::decodeIntegers(bytes, Samples, codec::IntegerOrder::DeltaOfDelta, times.data());
+    });
+    if (!bench::check(times == timestamps, "timestamp series")) {
+        return 1;
+    }
+    report("timestamp", Samples * sizeof(int64_t), bytes.size(), timeEncode, timeDecode);
+
+    if (argc > 1 && !reportRecording(argv[1])) {
+        return 1;
+    }
+    return 0;
+}
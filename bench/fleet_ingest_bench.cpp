@@ -0,0 +1,162 @@
+// Ingest rate of one Aggregator fed by several AgentSink connections over
+// loopback, each streaming a busy host's diffs as fast as its tick thread can
+// encode them. Reports frames, bytes and rows applied per second, counted
+// until the last agent's final tick is in, after checking that every host
+// ended up connected with its whole table.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "Fleet/AgentSink.h"
+#include "Fleet/Aggregator.h"
+
+namespace {
+    constexpr size_t Agents = 8;
+    constexpr size_t Processes = 1000;  // per host
+    constexpr uint64_t Ticks = 2000;    // per host
+    constexpr size_t ChurnPerTick = 3;
+    constexpr auto Timeout = std::chrono::seconds(60);
+
+    ProcessInfo makeProcess(const DWORD pid, std::mt19937_64 &rng) {
+        ProcessInfo info(pid);
+        info.parentPid = 4;
+        info.name = L"worker" + std::to_wstring(pid % 97) + L".exe";
+        info.path = L"C:\\Program Files\\Vendor\\" + std::wstring(info.name);
+        info.commandLine = info.path + L" --job " + std::to_wstring(pid);
+        info.cpuUsage = static_cast<double>(rng() % 1000) / 10.0;
+        info.ramUsage = (16 + rng() % 512) << 20;
+        return info;
+    }
+
+    // A tick thread: the whole table once, then Ticks - 1 diffs where a third
+    // of the processes move and a few are replaced.
+    void feed(AgentSink &agent, const uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<DWORD> live;
+        DWORD nextPid = 100;
+        ProcessUpdateData update;
+        for (size_t i = 0; i < Processes; ++i, nextPid += 4) {
+            update.added.push_back(makeProcess(nextPid, rng));
+            live.push_back(nextPid);
+        }
+        agent.onUpdate(update);
+
+        for (uint64_t tick = 1; tick < Ticks; ++tick) {
+            update.added.clear();
+            update.removed_pids.clear();
+            update.updated.clear();
+            for (size_t i = 0; i < ChurnPerTick; ++i, nextPid += 4) {
+                DWORD &slot = live[rng() % live.size()];
+                update.removed_pids.push_back(slot);
+                update.added.push_back(makeProcess(nextPid, rng));
+                slot = nextPid;
+            }
+            for (const DWORD pid: live) {
+                if (rng() % 3 == 0) {
+                    constexpr uint8_t All = ProcessDelta::Cpu | ProcessDelta::Ram | ProcessDelta::Io;
+                    update.updated.push_back(ProcessDelta{pid, All, static_cast<double>(rng() % 1000) / 10.0,
+                                                          static_cast<SIZE_T>((16 + rng() % 512) << 20),
+                                                          static_cast<double>(rng() % 100000)});
+                }
+            }
+            agent.onUpdate(update);
+        }
+    }
+
+    // Polls until done() or Timeout; false on timeout.
+    template<typename Done>
+    bool waitFor(Done done) {
+        const auto deadline = std::chrono::steady_clock::now() + Timeout;
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+int main() {
+    Aggregator aggregator;
+    if (!bench::check(aggregator.listen(0, true), "aggregator listens on loopback")) {
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<AgentSink>> agents;
+    for (size_t i = 0; i < Agents; ++i) {
+        AgentSink::Options options;
+        options.address = "127.0.0.1";
+        options.port = aggregator.port();
+        options.hostName = L"bench-" + std::to_wstring(i);
+        options.reconnectDelay = std::chrono::milliseconds(50);
+        agents.push_back(std::make_unique<AgentSink>(options));
+    }
+    // An agent only queues frames once connected; the aggregator knows the
+    // host once the hello is in.
+    const bool connected = waitFor([&] {
+        for (const auto &agent: agents) {
+            if (!agent->connected()) {
+                return false;
+            }
+        }
+        return aggregator.hosts().size() == Agents;
+    });
+    if (!bench::check(connected, "every agent connects")) {
+        return 1;
+    }
+
+    const uint64_t framesBefore = aggregator.framesReceived();
+    const uint64_t bytesBefore = aggregator.bytesReceived();
+    const uint64_t rowsBefore = aggregator.rowsApplied();
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> feeders;
+        for (size_t i = 0; i < Agents; ++i) {
+            feeders.emplace_back([&agent = *agents[i], i] { feed(agent, 48 + i); });
+        }
+    }
+    const bool delivered = waitFor([&] {
+        for (const Aggregator::Host &host: aggregator.hosts()) {
+            if (host.lastTick != Ticks) {
+                return false;
+            }
+        }
+        return true;
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!bench::check(delivered, "every agent's last tick arrives")) {
+        return 1;
+    }
+
+    uint64_t resyncs = 0;
+    bool whole = true;
+    for (const Aggregator::Host &host: aggregator.hosts()) {
+        whole = whole && host.connected && host.processes == Processes && host.connections == 1;
+        resyncs += host.resyncs;
+    }
+    if (!bench::check(whole, "every host holds its whole table") ||
+        !bench::check(aggregator.topK(MetricHistory::Metric::Cpu, 10).size() == 10, "fleet top-K")) {
+        return 1;
+    }
+
+    const auto frames = static_cast<double>(aggregator.framesReceived() - framesBefore);
+    const auto bytes = static_cast<double>(aggregator.bytesReceived() - bytesBefore);
+    const auto rows = static_cast<double>(aggregator.rowsApplied() - rowsBefore);
+    std::printf("%zu agents x %llu ticks x %zu processes in %.2f s: %.0f frames/s, %.1f MB/s, %.2f M rows/s, "
+                "%llu resyncs\n",
+                Agents, static_cast<unsigned long long>(Ticks), Processes, seconds, frames / seconds,
+                bytes / seconds / 1e6, rows / seconds / 1e6, static_cast<unsigned long long>(resyncs));
+
+    for (const auto &agent: agents) {
+        agent->close();
+    }
+    aggregator.stop();
+    return 0;
+}
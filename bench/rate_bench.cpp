@@ -0,0 +1,100 @@
+// Rows per second of each rate kernel this machine can run, over a batch
+// the size of a very busy system's counters, after checking that every
+// kernel gives bit for bit what the scalar loop gives, wrapped counters and
+// rows without a previous reading included.
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Bench.h"
+#include "Collection/RateKernels.h"
+
+namespace {
+    constexpr size_t Rows = 100000;
+    constexpr int Runs = 200;
+
+    const char *nameOf(const rates::Kernel kernel) {
+        switch (kernel) {
+            case rates::Kernel::Avx2: return "avx2";
+            case rates::Kernel::Sse2: return "sse2";
+            default: return "scalar";
+        }
+    }
+
+    bool sameBits(const std::vector<double> &a, const std::vector<double> &b) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::bit_cast<uint64_t>(a[i]) != std::bit_cast<uint64_t>(b[i])) {
+                return false;
+            }
+        }
+        return a.size() == b.size();
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> previous(Rows), current(Rows), wallDelta(Rows);
+    for (size_t i = 0; i < Rows; ++i) {
+        previous[i] = rng() % 4 == 0 ? rng() : rng() % (1ull << 40);
+        // Mostly small steps, some wrapping past 2^64, some huge jumps.
+        switch (rng() % 8) {
+            case 0: current[i] = previous[i] - rng() % 1000; break;
+            case 1: current[i] = rng(); break;
+            default: current[i] = previous[i] + rng() % 100000000; break;
+        }
+        // A tenth of the rows are new this tick; a few wall deltas are odd sizes.
+        wallDelta[i] = rng() % 10 == 0 ? 0 : rng() % 50 == 0 ? rng() : 10000000 + rng() % 100000;
+    }
+
+    std::vector<rates::Kernel> kernels{rates::Kernel::Scalar};
+    if (rates::best() != rates::Kernel::Scalar) {
+        kernels.push_back(rates::Kernel::Sse2);
+    }
+    if (rates::best() == rates::Kernel::Avx2) {
+        kernels.push_back(rates::Kernel::Avx2);
+    }
+
+    constexpr double Scale = 100.0 / 16;  // CPU % on 16 processors
+    std::vector<double> expected(Rows);
+    rates::compute(rates::Kernel::Scalar, previous.data(), current.data(), wallDelta.data(), Scale, expected.data(),
+                   Rows);
+
+    std::vector<double> out(Rows);
+    for (const rates::Kernel kernel: kernels) {
+        // Every length up to two full vectors, for the scalar tails.
+        for (size_t n = 0; n <= 9; ++n) {
+            std::fill(out.begin(), out.end(), -1.0);
+            rates::compute(kernel, previous.data(), current.data(), wallDelta.data(), Scale, out.data(), n);
+            if (!bench::check(sameBits(std::vector<double>(out.begin(), out.begin() + static_cast<ptrdiff_t>(n)),
+                                       std::vector<double>(expected.begin(), expected.begin() + static_cast<ptrdiff_t>(n))) &&
+                              out[n] == -1.0,
+                              "short batch differs from the scalar kernel")) {
+                std::printf("  kernel %s, %zu rows\n", nameOf(kernel), n);
+                return 1;
+            }
+        }
+        rates::compute(kernel, previous.data(), current.data(), wallDelta.data(), Scale, out.data(), Rows);
+        if (!bench::check(sameBits(out, expected), "kernel differs from the scalar kernel")) {
+            std::printf("  kernel %s\n", nameOf(kernel));
+            return 1;
+        }
+    }
+    std::fill(out.begin(), out.end(), -1.0);
+    rates::compute(previous.data(), current.data(), wallDelta.data(), Scale, out.data(), Rows);
+    if (!bench::check(sameBits(out, expected), "dispatched kernel differs from the scalar kernel")) {
+        return 1;
+    }
+
+    for (const rates::Kernel kernel: kernels) {
+        const double ns = bench::bestOf(Runs, [&] {
+            rates::compute(kernel, previous.data(), current.data(), wallDelta.data(), Scale, out.data(), Rows);
+            bench::keep(out[Rows - 1]);
+        });
+        std::printf("%-6s %s %zu rows: %7.1f us, %7.1f M rows/s\n", nameOf(kernel),
+                    kernel == rates::best() ? "*" : " ", Rows, ns / 1e3, Rows / ns * 1e3);
+    }
+    return 0;
+}
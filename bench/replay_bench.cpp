@@ -0,0 +1,150 @@
+// Ticks per second of the whole collect -> diff -> publish path, driven by
+// ReplayDriver from a recording so every run sees the same tables. With no
+// argument a synthetic recording is written to %TEMP% first and the replayed
+// diffs are checked against what was recorded; with a recording's base path
+// (as given to processlited --record) that recording is replayed instead.
+
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <windows.h>
+
+#include "Bench.h"
+#include "ProcessMonitor.h"
+#include "Collection/ReplayDriver.h"
+#include "Collection/ReplayProcessSource.h"
+#include "Concurrency/TaskManager.h"
+#include "Recording/RecordingFormat.h"
+#include "Recording/SnapshotRecorder.h"
+
+namespace {
+    constexpr size_t Processes = 2000;
+    constexpr uint64_t Ticks = 600;
+    constexpr size_t ChurnPerTick = 5;  // processes replaced every tick
+
+    struct Recorded {
+        uint64_t ticks = 0;
+        uint64_t added = 0;
+        uint64_t removed = 0;
+    };
+
+    ProcessInfo makeProcess(const DWORD pid, std::mt19937_64 &rng) {
+        ProcessInfo info(pid);
+        info.parentPid = 4;
+        info.name = L"worker" + std::to_wstring(pid % 97) + L".exe";
+        info.path = L"C:\\Program Files\\Vendor\\" + std::wstring(info.name);
+        info.commandLine = info.path + L" --job " + std::to_wstring(pid);
+        info.ramUsage = (16 + rng() % 512) << 20;
+        return info;
+    }
+
+    // A table where a third of the processes move every tick and a few are
+    // replaced, with PIDs never reused so every add and removal is one record.
+    bool writeRecording(const std::wstring &basePath, Recorded &recorded) {
+        SnapshotRecorder recorder(basePath);
+        if (!recorder.isOpen()) {
+            return false;
+        }
+        std::mt19937_64 rng(29);
+        std::unordered_map<DWORD, ProcessInfo> table;
+        DWORD nextPid = 100;
+        ProcessUpdateData diff;
+        for (size_t i = 0; i < Processes; ++i, nextPid += 4) {
+            diff.added.push_back(table.emplace(nextPid, makeProcess(nextPid, rng)).first->second);
+        }
+
+        for (uint64_t tick = 0; tick < Ticks; ++tick) {
+            if (tick > 0) {
+                for (size_t i = 0; i < ChurnPerTick; ++i, nextPid += 4) {
+                    auto victim = table.begin();
+                    std::advance(victim, static_cast<ptrdiff_t>(rng() % table.size()));
+                    diff.removed_pids.push_back(victim->first);
+                    table.erase(victim);
+                    diff.added.push_back(table.emplace(nextPid, makeProcess(nextPid, rng)).first->second);
+                }
+                for (auto &[pid, info]: table) {
+                    if (rng() % 3 == 0) {
+                        info.cpuUsage = static_cast<double>(rng() % 1000) / 10.0;
+                        info.ramUsage += 4096;
+                        info.ioRate = static_cast<double>(rng() % 100000);
+                        constexpr uint8_t All = ProcessDelta::Cpu | ProcessDelta::Ram | ProcessDelta::Io;
+                        diff.updated.push_back(ProcessDelta{pid, All, info.cpuUsage, info.ramUsage, info.ioRate});
+                    }
+                }
+            }
+            if (!recorder.recordTick(table, diff)) {
+                return false;
+            }
+            recorded.added += diff.added.size();
+            recorded.removed += diff.removed_pids.size();
+            diff = ProcessUpdateData{};
+        }
+        recorded.ticks = recorder.ticksRecorded();
+        return true;
+    }
+
+    void removeRecording(const std::wstring &basePath) {
+        for (uint64_t index = 0; DeleteFileW(recording::segmentPath(basePath, index).c_str()); ++index) {
+        }
+    }
+}
+
+int wmain(const int argc, wchar_t **argv) {
+    std::wstring basePath;
+    Recorded recorded;
+    const bool synthetic = argc < 2;
+    if (synthetic) {
+        wchar_t temp[MAX_PATH];
+        if (!GetTempPathW(MAX_PATH, temp)) {
+            return 1;
+        }
+        basePath = std::wstring(temp) + L"processlite-replay-bench-" + std::to_wstring(GetCurrentProcessId());
+        if (!bench::check(writeRecording(basePath, recorded), "cannot write the synthetic recording")) {
+            removeRecording(basePath);
+            return 1;
+        }
+    } else {
+        basePath = argv[1];
+    }
+
+    auto source = std::make_unique<ReplayProcessSource>(basePath, ReplayOptions{ReplayPacing::AsFastAsPossible});
+    if (!bench::check(source->isOpen(), "cannot open the recording")) {
+        if (synthetic) {
+            removeRecording(basePath);
+        }
+        return 1;
+    }
+    ReplayDriver::Result result;
+    uint64_t ticksReplayed = 0;
+    {
+        // The monitor owns the source, and with it the mapped segments.
+        const ReplayProcessSource &replay = *source;
+        TaskManager taskManager;
+        ProcessMonitor monitor(taskManager, nullptr, nullptr, std::move(source), std::chrono::milliseconds(0));
+        result = ReplayDriver(monitor, replay).run();
+        ticksReplayed = replay.ticksReplayed();
+    }
+    if (synthetic) {
+        removeRecording(basePath);
+        if (!bench::check(ticksReplayed == recorded.ticks && result.ticks == recorded.ticks, "ticks replayed") ||
+            !bench::check(result.added == recorded.added, "added processes") ||
+            !bench::check(result.removed == recorded.removed, "removed processes")) {
+            return 1;
+        }
+    }
+
+    std::printf("%llu ticks: %.0f ticks/s, %.1f us/tick mean, %.1f us worst; %llu added, %llu removed, "
+                "%llu updated (%.2f M rows/s)\n",
+                static_cast<unsigned long long>(ticksReplayed), result.ticksPerSecond(),
+                result.ticks ? static_cast<double>(result.total.count()) / static_cast<double>(result.ticks) / 1e3 : 0.0,
+                static_cast<double>(result.worstTick.count()) / 1e3,
+                static_cast<unsigned long long>(result.added), static_cast<unsigned long long>(result.removed),
+                static_cast<unsigned long long>(result.updated),
+                result.total.count() ? static_cast<double>(result.added + result.removed + result.updated) * 1e3 /
+                                       static_cast<double>(result.total.count())
+                                     : 0.0);
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Reader latency of the shared-memory snapshot region (SnapshotRegion.h)
+// against a live SharedSnapshotSink, and how often writer overlap makes a
+// reader retry. Readers run plsnap_begin/plsnap_validate alone (a peek at the
+// tick), an in-place scan of every row between them, and plsnap_read, first
+// against a writer ticking every millisecond and then against one
+// publishing back to back. Every tick sets every row's cpu to the tick
+// number, so a table that validates with mixed values was torn, which fails
+// the benchmark.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <windows.h>
+
+#include "Bench.h"
+#include "Export/SharedSnapshotSink.h"
+#include "Export/SnapshotRegion.h"
+
+namespace {
+    constexpr size_t Processes = 2000;
+    constexpr size_t ChurnPerTick = 20;
+    constexpr size_t Readers = 2;
+    constexpr auto PhaseLength = std::chrono::seconds(2);
+
+    struct ReaderStats {
+        std::vector<double> peekNs;
+        std::vector<double> scanNs;
+        std::vector<double> copyNs;
+        uint64_t retries = 0;  // plsnap_validate failures
+        uint64_t torn = 0;     // validated tables whose rows disagree
+    };
+
+    double since(const bench::Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(bench::Clock::now() - start).count();
+    }
+
+    bool sameTick(const plsnap_process *rows, const uint32_t count) {
+        for (uint32_t i = 1; i < count; ++i) {
+            if (rows[i].cpu != rows[0].cpu) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void read(const plsnap_view &view, const std::atomic<bool> &stop, ReaderStats &stats) {
+        std::vector<plsnap_process> copy(Processes);
+        while (!stop.load(std::memory_order_relaxed)) {
+            LONG64 ticket;
+            auto start = bench::Clock::now();
+            const plsnap_slot *slot = plsnap_begin(&view, &ticket);
+            bench::keep(slot->tick);
+            if (!plsnap_validate(slot, ticket)) {
+                ++stats.retries;
+            }
+            stats.peekNs.push_back(since(start));
+
+            start = bench::Clock::now();
+            while (true) {
+                slot = plsnap_begin(&view, &ticket);
+                const uint32_t count = std::min<uint32_t>(slot->count, view.header->capacity);
+                const bool consistent = sameTick(plsnap_rows(slot), count);
+                if (plsnap_validate(slot, ticket)) {
+                    stats.torn += consistent ? 0 : 1;
+                    break;
+                }
+                ++stats.retries;
+            }
+            stats.scanNs.push_back(since(start));
+
+            start = bench::Clock::now();
+            const int count = plsnap_read(&view, copy.data(), static_cast<uint32_t>(copy.size()), nullptr);
+            stats.copyNs.push_back(since(start));
+            stats.torn += count >= 0 && sameTick(copy.data(), static_cast<uint32_t>(count)) ? 0 : 1;
+        }
+    }
+
+    double percentile(std::vector<double> &samples, const double p) {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        const auto at = samples.begin() + static_cast<ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), at, samples.end());
+        return *at;
+    }
+
+    // One writer tick: every row's cpu becomes the tick, and a few processes
+    // are replaced.
+    struct Writer {
+        SharedSnapshotSink &sink;
+        std::vector<DWORD> live;
+        DWORD nextPid = 100;
+        uint64_t tick = 0;
+        ProcessUpdateData update;
+
+        ProcessInfo process(const DWORD pid) const {
+            ProcessInfo info(pid);
+            info.name = L"worker" + std::to_wstring(pid % 97) + L".exe";
+            info.cpuUsage = static_cast<double>(tick);
+            info.ramUsage = 64 << 20;
+            return info;
+        }
+
+        void step() {
+            ++tick;
+            update.added.clear();
+            update.removed_pids.clear();
+            update.updated.clear();
+            if (live.empty()) {
+                for (size_t i = 0; i < Processes; ++i, nextPid += 4) {
+                    live.push_back(nextPid);
+                    update.added.push_back(process(nextPid));
+                }
+            } else {
+                for (size_t i = 0; i < ChurnPerTick; ++i, nextPid += 4) {
+                    DWORD &slot = live[(tick * 7919 + i * 104729) % live.size()];
+                    update.removed_pids.push_back(slot);
+                    slot = nextPid;
+                    update.added.push_back(process(nextPid));
+                }
+                for (const DWORD pid: live) {
+                    update.updated.push_back(ProcessDelta{pid, ProcessDelta::Cpu, static_cast<double>(tick)});
+                }
+            }
+            sink.onUpdate(update);
+        }
+    };
+
+    bool runPhase(const char *label, const plsnap_view &view, Writer &writer, const bool paced) {
+        std::atomic<bool> stop{false};
+        std::vector<ReaderStats> stats(Readers);
+        const uint64_t firstTick = writer.tick;
+        {
+            std::vector<std::jthread> readers;
+            for (ReaderStats &reader: stats) {
+                readers.emplace_back([&] { read(view, stop, reader); });
+            }
+            const auto end = bench::Clock::now() + PhaseLength;
+            while (bench::Clock::now() < end) {
+                writer.step();
+                if (paced) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            stop.store(true);
+        }
+
+        ReaderStats all;
+        for (ReaderStats &reader: stats) {
+            all.peekNs.insert(all.peekNs.end(), reader.peekNs.begin(), reader.peekNs.end());
+            all.scanNs.insert(all.scanNs.end(), reader.scanNs.begin(), reader.scanNs.end());
+            all.copyNs.insert(all.copyNs.end(), reader.copyNs.begin(), reader.copyNs.end());
+            all.retries += reader.retries;
+            all.torn += reader.torn;
+        }
+        if (!bench::check(all.torn == 0, "a validated table was torn")) {
+            return false;
+        }
+        const double ticksPerSecond = static_cast<double>(writer.tick - firstTick) /
+                                      std::chrono::duration<double>(PhaseLength).count();
+        std::printf("%s: %.0f ticks/s, %zu reads, %llu retries\n", label, ticksPerSecond, all.scanNs.size(),
+                    static_cast<unsigned long long>(all.retries));
+        std::printf("  peek  p50 %8.2f us  p99 %8.2f us\n", percentile(all.peekNs, 0.5) / 1e3,
+                    percentile(all.peekNs, 0.99) / 1e3);
+        std::printf("  scan  p50 %8.2f us  p99 %8.2f us\n", percentile(all.scanNs, 0.5) / 1e3,
+                    percentile(all.scanNs, 0.99) / 1e3);
+        std::printf("  copy  p50 %8.2f us  p99 %8.2f us\n", percentile(all.copyNs, 0.5) / 1e3,
+                    percentile(all.copyNs, 0.99) / 1e3);
+        return true;
+    }
+}
+
+int main() {
+    SharedSnapshotSink::Options options;
+    options.name = L"Local\\processlite-bench-" + std::to_wstring(GetCurrentProcessId());
+    options.capacity = static_cast<uint32_t>(Processes + ChurnPerTick);
+    SharedSnapshotSink sink(options);
+    if (!bench::check(sink.isOpen(), "cannot create the region")) {
+        return 1;
+    }
+    Writer writer{sink};
+    writer.step();
+
+    plsnap_view view;
+    if (!bench::check(plsnap_open(&view, options.name.c_str()), "cannot open the region")) {
+        return 1;
+    }
+    plsnap_slot info;
+    std::vector<plsnap_process> rows(Processes);
+    if (!bench::check(plsnap_read(&view, rows.data(), static_cast<uint32_t>(rows.size()), &info) ==
+                      static_cast<int>(Processes) && info.total == Processes && sameTick(rows.data(), Processes),
+                      "first table")) {
+        plsnap_close(&view);
+        return 1;
+    }
+
+    const bool ok = runPhase("writer every 1 ms", view, writer, true) &&
+                    runPhase("writer back to back", view, writer, false);
+    plsnap_close(&view);
+    sink.close();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// Per-process cost of walking the process table in place with
+// ProcessTableReader, over a synthetic SystemProcessInformation buffer of
+// Processes entries with their threads, laid out as the kernel lays it out.
+// Checks the NextEntryOffset walk first: every entry and thread is visited
+// once, and a torn or truncated buffer ends the walk instead of overrunning.
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "Collection/ProcessTableReader.h"
+
+namespace {
+    constexpr size_t Processes = 4000;
+    constexpr int Runs = 200;
+
+    constexpr size_t align8(const size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+    struct Expected {
+        size_t processes = 0;
+        size_t threads = 0;
+        uint64_t pidSum = 0;
+        uint64_t cpuSum = 0;
+        uint64_t ioSum = 0;
+        size_t nameChars = 0;
+        std::vector<size_t> offsets;  // of every entry
+    };
+
+    // Entries of 1 to 64 threads, each followed by its threads and then its
+    // image name, NextEntryOffset rounded up to 8 as the kernel does.
+    std::vector<std::byte> buildTable(std::mt19937_64 &rng, Expected &expected) {
+        std::vector<ULONG> threadCounts(Processes);
+        std::vector<std::wstring> names(Processes);
+        size_t total = 0;
+        for (size_t i = 0; i < Processes; ++i) {
+            threadCounts[i] = static_cast<ULONG>(1 + rng() % 64);
+            names[i] = L"process" + std::to_wstring(i) + L".exe";
+            total += align8(sizeof(SystemProcessEntry) + threadCounts[i] * sizeof(SystemThreadEntry) +
+                            names[i].size() * sizeof(wchar_t));
+        }
+
+        std::vector<std::byte> buffer(total);
+        size_t offset = 0;
+        for (size_t i = 0; i < Processes; ++i) {
+            const size_t threadBytes = threadCounts[i] * sizeof(SystemThreadEntry);
+            const size_t bytes = align8(sizeof(SystemProcessEntry) + threadBytes + names[i].size() * sizeof(wchar_t));
+            const DWORD pid = static_cast<DWORD>(4 + i * 4);
+
+            SystemProcessEntry entry{};
+            entry.NextEntryOffset = i + 1 < Processes ? static_cast<ULONG>(bytes) : 0;
+            entry.NumberOfThreads = threadCounts[i];
+            entry.UniqueProcessId = reinterpret_cast<HANDLE>(static_cast<ULONG_PTR>(pid));
+            entry.InheritedFromUniqueProcessId = reinterpret_cast<HANDLE>(static_cast<ULONG_PTR>(4));
+            entry.KernelTime.QuadPart = static_cast<LONGLONG>(rng() % 10000000);
+            entry.UserTime.QuadPart = static_cast<LONGLONG>(rng() % 10000000);
+            entry.WorkingSetSize = (rng() % 512) << 20;
+            entry.ReadTransferCount.QuadPart = static_cast<LONGLONG>(rng() % 1000000);
+            entry.WriteTransferCount.QuadPart = static_cast<LONGLONG>(rng() % 1000000);
+            auto *name = reinterpret_cast<wchar_t *>(buffer.data() + offset + sizeof(SystemProcessEntry) + threadBytes);
+            std::memcpy(name, names[i].data(), names[i].size() * sizeof(wchar_t));
+            entry.ImageName.Buffer = name;
+            entry.ImageName.Length = static_cast<USHORT>(names[i].size() * sizeof(wchar_t));
+            entry.ImageName.MaximumLength = entry.ImageName.Length;
+            std::memcpy(buffer.data() + offset, &entry, sizeof(entry));
+
+            for (ULONG t = 0; t < threadCounts[i]; ++t) {
+                SystemThreadEntry thread{};
+                thread.ClientId.UniqueThread = reinterpret_cast<HANDLE>(static_cast<ULONG_PTR>(pid + 1 + t));
+                thread.KernelTime.QuadPart = static_cast<LONGLONG>(rng() % 1000000);
+                thread.ContextSwitches = static_cast<ULONG>(rng() % 100000);
+                std::memcpy(buffer.data() + offset + sizeof(SystemProcessEntry) + t * sizeof(SystemThreadEntry),
+                            &thread, sizeof(thread));
+            }
+
+            ++expected.processes;
+            expected.threads += threadCounts[i];
+            expected.pidSum += pid;
+            expected.cpuSum += static_cast<uint64_t>(entry.KernelTime.QuadPart) +
+                               static_cast<uint64_t>(entry.UserTime.QuadPart);
+            expected.ioSum += static_cast<uint64_t>(entry.ReadTransferCount.QuadPart) +
+                              static_cast<uint64_t>(entry.WriteTransferCount.QuadPart);
+            expected.nameChars += names[i].size();
+            expected.offsets.push_back(offset);
+            offset += bytes;
+        }
+        return buffer;
+    }
+
+    // What LiveProcessSource reads of every record each tick.
+    struct Walked {
+        size_t processes = 0;
+        size_t threads = 0;
+        uint64_t pidSum = 0;
+        uint64_t cpuSum = 0;
+        uint64_t ioSum = 0;
+        uint64_t workingSet = 0;
+        size_t nameChars = 0;
+    };
+
+    Walked walk(const ProcessTableReader &table) {
+        Walked walked;
+        for (const ProcessTableReader::Record record: table) {
+            ++walked.processes;
+            walked.pidSum += record.pid() + record.parentPid();
+            walked.cpuSum += record.cpuTime();
+            walked.ioSum += record.ioBytes();
+            walked.workingSet += record.workingSet();
+            walked.nameChars += record.imageName().size();
+            walked.threads += record.threads().size();
+        }
+        return walked;
+    }
+
+    // ProcessTableReader that adopted a copy of `buffer`, cut to `length`
+    // bytes, optionally with one entry's NextEntryOffset pointing past the end.
+    size_t walkDamaged(const std::vector<std::byte> &buffer, const size_t length, const size_t badEntry = SIZE_MAX) {
+        std::vector<std::byte> copy(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(length));
+        if (badEntry != SIZE_MAX) {
+            const ULONG pastEnd = static_cast<ULONG>(length - badEntry + 8);
+            std::memcpy(copy.data() + badEntry, &pastEnd, sizeof(pastEnd));
+        }
+        ProcessTableReader table;
+        table.assign(std::move(copy), 0);
+        const size_t walked = walk(table).processes;
+        return table.size() == walked ? walked : SIZE_MAX;
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(41);
+    Expected expected;
+    std::vector<std::byte> buffer = buildTable(rng, expected);
+    const std::vector<std::byte> pristine = buffer;
+
+    ProcessTableReader table;
+    table.assign(std::move(buffer), 133000000000000000ull);
+    const Walked walked = walk(table);
+    if (!bench::check(table.size() == expected.processes && walked.processes == expected.processes,
+                      "every entry is visited once") ||
+        !bench::check(walked.threads == expected.threads, "every thread is visited once") ||
+        !bench::check(walked.pidSum == expected.pidSum + 4 * expected.processes, "pids") ||
+        !bench::check(walked.cpuSum == expected.cpuSum && walked.ioSum == expected.ioSum, "times and I/O") ||
+        !bench::check(walked.nameChars == expected.nameChars, "image names")) {
+        return 1;
+    }
+
+    // Cut inside entry 10: the walk stops before it. A NextEntryOffset past
+    // the end stops it after that entry.
+    const size_t cut = expected.offsets[10] + sizeof(SystemProcessEntry) / 2;
+    if (!bench::check(walkDamaged(pristine, cut) == 10, "truncated table ends the walk") ||
+        !bench::check(walkDamaged(pristine, expected.offsets[20], expected.offsets[5]) == 6,
+                      "torn NextEntryOffset ends the walk")) {
+        return 1;
+    }
+
+    const double ns = bench::bestOf(Runs, [&] { bench::keep(walk(table).cpuSum); });
+    std::printf("%zu processes, %zu threads, %zu KiB: %.1f us per walk, %.1f ns per process\n", expected.processes,
+                expected.threads, pristine.size() / 1024, ns / 1e3, ns / static_cast<double>(expected.processes));
+    return 0;
+}
@@ -0,0 +1,380 @@
+#include <chrono>
+#include <cwchar>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <windows.h>
+
+#include "Daemon/Collector.h"
+#include "Daemon/SummarySink.h"
+#include "Export/MetricsServer.h"
+#include "Export/OpenMetricsSink.h"
+#include "Export/SharedSnapshotSink.h"
+#include "Export/StreamExportSink.h"
+#include "Export/TextEncoding.h"
+#include "Fleet/AgentSink.h"
+#include "Fleet/Aggregator.h"
+#include "Fleet/FleetProtocol.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+    HANDLE g_stop_requested = nullptr;
+    HANDLE g_stopped = nullptr;
+
+    BOOL WINAPI onConsoleControl(const DWORD event) {
+        SetEvent(g_stop_requested);
+        switch (event) {
+            case CTRL_CLOSE_EVENT:
+            case CTRL_LOGOFF_EVENT:
+            case CTRL_SHUTDOWN_EVENT:
+                // The process is terminated when this returns; give main a
+                // chance to flush the sinks and seal the recording first.
+                WaitForSingleObject(g_stopped, 4500);
+                break;
+            default:
+                break;
+        }
+        return TRUE;
+    }
+
+    void printUsage() {
+        std::wcerr <<
+            L"usage: processlited [options]\n"
+            L"  --interval MS      tick interval (default 1000)\n"
+            L"  --record PATH      record every tick to PATH.<n> segment files\n"
+            L"  --replay PATH      replay a recording instead of the live system\n"
+            L"  --speed X          replay X times faster than recorded\n"
+            L"  --loop             restart the recording when it ends\n"
+            L"  --alert RULE       add an alert rule, e.g. \"cpu > 90% for 30s\" (repeatable)\n"
+            L"  --metrics PORT     serve OpenMetrics on http://127.0.0.1:PORT/metrics\n"
+            L"  --metrics-socket PATH  serve OpenMetrics on an AF_UNIX socket instead\n"
+            L"  --export PATH      stream every tick to PATH, a \\\\.\\pipe\\ name or - for stdout\n"
+            L"  --export-format F  ndjson (default) or columnar\n"
+            L"  --export-table     export the whole table each tick instead of the diff\n"
+            L"  --shm NAME         publish the table to a shared-memory region for local readers\n"
+            L"                     (see SnapshotRegion.h), e.g. Local\\processlite.snapshot\n"
+            L"  --agent HOST[:PORT]  stream every tick to a fleet aggregator (default port 9417)\n"
+            L"  --host-name NAME   this machine's name at the aggregator (default: computer name)\n"
+            L"  --aggregate PORT   run as the fleet aggregator instead of collecting; with\n"
+            L"                     --metrics, serve /hosts, /top?by=cpu&k=N and /query?q=...\n"
+            L"  --summary SECONDS  summary line period (default 60)\n"
+            L"  --threads N        worker threads (default 1)\n";
+    }
+
+    struct DaemonOptions {
+        std::chrono::seconds summaryPeriod{60};
+        int metricsPort = -1;  // -1: off
+        std::wstring metricsSocket;
+        std::wstring exportPath;
+        StreamExportSink::Options exportOptions;
+        SharedSnapshotSink::Options sharedOptions;
+        bool shared = false;
+        AgentSink::Options agentOptions;  // no address: off
+        int aggregatePort = -1;           // -1: collect instead
+    };
+
+    // HOST, HOST:PORT or [IPv6]:PORT.
+    bool parseAgentAddress(const std::wstring_view text, AgentSink::Options &options) {
+        std::wstring_view host = text;
+        std::wstring_view port;
+        if (text.starts_with(L'[')) {
+            const size_t close = text.find(L']');
+            if (close == std::wstring_view::npos || (close + 1 < text.size() && text[close + 1] != L':')) {
+                return false;
+            }
+            host = text.substr(1, close - 1);
+            port = text.substr(std::min(close + 2, text.size()));
+        } else if (const size_t colon = text.rfind(L':'); colon != std::wstring_view::npos &&
+                                                           text.find(L':') == colon) {
+            host = text.substr(0, colon);
+            port = text.substr(colon + 1);
+        }
+        options.port = fleet::DefaultPort;
+        if (!port.empty()) {
+            const std::wstring digits(port);
+            wchar_t *end = nullptr;
+            const unsigned long value = std::wcstoul(digits.c_str(), &end, 10);
+            if (*end != L'\0' || value == 0 || value > 65535) {
+                return false;
+            }
+            options.port = static_cast<uint16_t>(value);
+        }
+        options.address = toUtf8(host);
+        return !options.address.empty();
+    }
+
+    bool parseArguments(const int argc, wchar_t **argv, Collector::Options &options, DaemonOptions &daemon) {
+        for (int i = 1; i < argc; ++i) {
+            const std::wstring arg = argv[i];
+            const wchar_t *value = i + 1 < argc ? argv[i + 1] : nullptr;
+            const auto number = [&](double &out) {
+                wchar_t *end = nullptr;
+                out = value ? std::wcstod(value, &end) : 0.0;
+                return value && end != value && *end == L'\0' && out > 0.0;
+            };
+
+            double n = 0.0;
+            if (arg == L"--loop") {
+                options.replay.loop = true;
+                continue;
+            }
+            if (arg == L"--export-table") {
+                daemon.exportOptions.content = StreamExportSink::Content::Table;
+                continue;
+            }
+            if (!value) {
+                std::wcerr << L"missing value for " << arg << L"\n";
+                return false;
+            }
+            if (arg == L"--record") {
+                options.recordPath = value;
+            } else if (arg == L"--replay") {
+                options.replayPath = value;
+            } else if (arg == L"--alert") {
+                options.alertRules.emplace_back(value);
+            } else if (arg == L"--interval" && number(n)) {
+                options.interval = std::chrono::milliseconds(static_cast<int64_t>(n));
+            } else if (arg == L"--speed" && number(n)) {
+                options.replay.pacing = ReplayPacing::Accelerated;
+                options.replay.speedFactor = n;
+            } else if (arg == L"--summary" && number(n)) {
+                daemon.summaryPeriod = std::chrono::seconds(static_cast<int64_t>(n));
+            } else if (arg == L"--metrics" && number(n) && n < 65536) {
+                daemon.metricsPort = static_cast<int>(n);
+            } else if (arg == L"--metrics-socket") {
+                daemon.metricsSocket = value;
+            } else if (arg == L"--export") {
+                daemon.exportPath = value;
+            } else if (arg == L"--export-format" && (std::wstring_view(value) == L"ndjson" ||
+                                                     std::wstring_view(value) == L"columnar")) {
+                daemon.exportOptions.format = std::wstring_view(value) == L"ndjson"
+                                                  ? StreamExportSink::Format::Ndjson
+                                                  : StreamExportSink::Format::Columnar;
+            } else if (arg == L"--shm") {
+                daemon.shared = true;
+                daemon.sharedOptions.name = value;
+            } else if (arg == L"--agent") {
+                if (!parseAgentAddress(value, daemon.agentOptions)) {
+                    std::wcerr << L"invalid aggregator address " << value << L"\n";
+                    return false;
+                }
+            } else if (arg == L"--host-name") {
+                daemon.agentOptions.hostName = value;
+            } else if (arg == L"--aggregate" && number(n) && n < 65536) {
+                daemon.aggregatePort = static_cast<int>(n);
+            } else if (arg == L"--threads" && number(n)) {
+                options.workerThreads = static_cast<size_t>(n);
+            } else {
+                std::wcerr << L"invalid option " << arg << L" " << value << L"\n";
+                return false;
+            }
+            ++i;
+        }
+        if (options.interval <= 0ms) {
+            std::wcerr << L"--interval must be at least 1 ms\n";
+            return false;
+        }
+        if (daemon.summaryPeriod < 1s) {
+            std::wcerr << L"--summary must be at least 1 s\n";
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const std::string> processTable(const std::vector<Aggregator::Process> &processes) {
+        auto out = std::make_shared<std::string>("host\tpid\tname\tcpu\tram\tio\n");
+        for (const Aggregator::Process &process: processes) {
+            *out += std::format("{}\t{}\t{}\t{:.2f}\t{}\t{:.0f}\n", toUtf8(process.host), process.pid,
+                                toUtf8(process.name), process.cpu, process.ram, process.io);
+        }
+        return out;
+    }
+
+    void addFleetRoutes(MetricsServer &server, const Aggregator &aggregator) {
+        server.addRoute("/hosts", [&aggregator](std::string_view) {
+            auto out = std::make_shared<std::string>(
+                "host\tconnected\tprocesses\tframes\tbytes\tlast_tick\tresyncs\tconnections\n");
+            for (const Aggregator::Host &host: aggregator.hosts()) {
+                *out += std::format("{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\n", toUtf8(host.name), host.connected ? 1 : 0,
+                                    host.processes, host.frames, host.bytes, host.lastTick, host.resyncs,
+                                    host.connections);
+            }
+            return MetricsServer::RouteResponse{std::move(out)};
+        });
+        server.addRoute("/top", [&aggregator](const std::string_view query) {
+            const std::string by = MetricsServer::queryParameter(query, "by");
+            const std::string k = MetricsServer::queryParameter(query, "k");
+            const auto metric = by == "ram" ? MetricHistory::Metric::Ram
+                                : by == "io" ? MetricHistory::Metric::Io
+                                : MetricHistory::Metric::Cpu;
+            if (!by.empty() && by != "cpu" && by != "ram" && by != "io") {
+                return MetricsServer::RouteResponse{
+                    std::make_shared<const std::string>("by must be cpu, ram or io\n"), false};
+            }
+            const size_t count = k.empty() ? 10 : std::strtoul(k.c_str(), nullptr, 10);
+            return MetricsServer::RouteResponse{processTable(aggregator.topK(metric, std::min<size_t>(count, 1000)))};
+        });
+        server.addRoute("/query", [&aggregator](const std::string_view query) {
+            std::wstring text;
+            if (!assignUtf16(text, MetricsServer::queryParameter(query, "q"))) {
+                return MetricsServer::RouteResponse{std::make_shared<const std::string>("q is not UTF-8\n"), false};
+            }
+            std::string error;
+            const auto processes = aggregator.query(text, &error);
+            if (!processes) {
+                return MetricsServer::RouteResponse{std::make_shared<const std::string>(error + "\n"), false};
+            }
+            return MetricsServer::RouteResponse{processTable(*processes)};
+        });
+    }
+
+    // The fleet view: no collector, just agents' streams and a summary line.
+    int runAggregator(const DaemonOptions &daemon) {
+        Aggregator aggregator;
+        if (!aggregator.listen(static_cast<uint16_t>(daemon.aggregatePort))) {
+            return 1;
+        }
+        std::cout << "processlited: aggregating on port " << aggregator.port() << "; Ctrl+C to stop" << std::endl;
+
+        std::unique_ptr<MetricsServer> server;
+        if (daemon.metricsPort >= 0 || !daemon.metricsSocket.empty()) {
+            server = std::make_unique<MetricsServer>(nullptr);
+            addFleetRoutes(*server, aggregator);
+            if (!daemon.metricsSocket.empty() ? !server->listenUnix(daemon.metricsSocket)
+                                              : !server->listenTcp(static_cast<uint16_t>(daemon.metricsPort))) {
+                return 1;
+            }
+            if (daemon.metricsSocket.empty()) {
+                std::cout << "processlited: fleet queries on http://127.0.0.1:" << server->port() << "/hosts"
+                          << std::endl;
+            }
+        }
+
+        const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(daemon.summaryPeriod);
+        auto last = std::chrono::steady_clock::now();
+        uint64_t frames = 0, bytes = 0, rows = 0;
+        while (WaitForSingleObject(g_stop_requested, static_cast<DWORD>(period.count())) == WAIT_TIMEOUT) {
+            const auto now = std::chrono::steady_clock::now();
+            const double seconds = std::chrono::duration<double>(now - last).count();
+            size_t connected = 0, processes = 0;
+            const std::vector<Aggregator::Host> hosts = aggregator.hosts();
+            for (const Aggregator::Host &host: hosts) {
+                connected += host.connected ? 1 : 0;
+                processes += host.processes;
+            }
+            std::string top;
+            for (const Aggregator::Process &process: aggregator.topK(MetricHistory::Metric::Cpu, 3)) {
+                top += std::format(" {}/{}({}) {:.1f}%", toUtf8(process.host), toUtf8(process.name), process.pid,
+                                   process.cpu);
+            }
+            std::cout << std::format("[fleet] {}/{} hosts, {} processes, {:.0f} frames/s, {:.2f} MB/s, "
+                                     "{:.0f} rows/s; top cpu:{}\n",
+                                     connected, hosts.size(), processes,
+                                     (aggregator.framesReceived() - frames) / seconds,
+                                     (aggregator.bytesReceived() - bytes) / seconds / 1e6,
+                                     (aggregator.rowsApplied() - rows) / seconds, top.empty() ? " -" : top);
+            std::cout.flush();
+            frames = aggregator.framesReceived();
+            bytes = aggregator.bytesReceived();
+            rows = aggregator.rowsApplied();
+            last = now;
+        }
+
+        if (server) {
+            server->stop();
+        }
+        aggregator.stop();
+        std::cout << "processlited: stopped" << std::endl;
+        return 0;
+    }
+
+    int runCollector(const Collector::Options &options, const DaemonOptions &daemon) {
+        // With the export on stdout, everything else goes to stderr.
+        std::ostream &console = daemon.exportPath == L"-" ? std::cerr : std::cout;
+
+        Collector collector(options);
+        collector.addSink(std::make_shared<SummarySink>(console, daemon.summaryPeriod));
+        if (!daemon.exportPath.empty()) {
+            auto exporter = std::make_shared<StreamExportSink>(daemon.exportPath, daemon.exportOptions);
+            if (!exporter->isOpen()) {
+                return 1;
+            }
+            collector.addSink(std::move(exporter));
+        }
+        if (daemon.shared) {
+            auto shared = std::make_shared<SharedSnapshotSink>(daemon.sharedOptions);
+            if (!shared->isOpen()) {
+                return 1;
+            }
+            collector.addSink(std::move(shared));
+        }
+        if (!daemon.agentOptions.address.empty()) {
+            collector.addSink(std::make_shared<AgentSink>(daemon.agentOptions));
+        }
+
+        std::unique_ptr<MetricsServer> metricsServer;
+        if (daemon.metricsPort >= 0 || !daemon.metricsSocket.empty()) {
+            auto metrics = std::make_shared<OpenMetricsSink>(collector);
+            collector.addSink(metrics);
+            metricsServer = std::make_unique<MetricsServer>([metrics] { return metrics->payload(); });
+            if (!daemon.metricsSocket.empty()) {
+                if (!metricsServer->listenUnix(daemon.metricsSocket)) {
+                    return 1;
+                }
+            } else if (!metricsServer->listenTcp(static_cast<uint16_t>(daemon.metricsPort))) {
+                return 1;
+            } else {
+                console << "processlited: metrics on http://127.0.0.1:" << metricsServer->port() << "/metrics"
+                        << std::endl;
+            }
+        }
+
+        if (!collector.start()) {
+            return 1;
+        }
+        console << "processlited: collecting; Ctrl+C to stop" << std::endl;
+
+        // Only a finished replay needs polling; everything else ends with the event.
+        const DWORD wait = options.replayPath.empty() || options.replay.loop ? INFINITE : 1000;
+        while (WaitForSingleObject(g_stop_requested, wait) == WAIT_TIMEOUT) {
+            if (collector.finished()) {
+                break;
+            }
+        }
+
+        if (metricsServer) {
+            metricsServer->stop();
+        }
+        collector.stop();
+        console << "processlited: stopped" << std::endl;
+        return 0;
+    }
+}
+
+// Headless collector: the process monitor without a window, logging through
+// SummarySink until Ctrl+C, Ctrl+Break, console close, logoff or shutdown.
+int wmain(const int argc, wchar_t **argv) {
+    Collector::Options options;
+    DaemonOptions daemon;
+    if (!parseArguments(argc, argv, options, daemon)) {
+        printUsage();
+        return 2;
+    }
+
+    g_stop_requested = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    g_stopped = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!g_stop_requested || !g_stopped || !SetConsoleCtrlHandler(onConsoleControl, TRUE)) {
+        std::cerr << "processlited: cannot install the console control handler. Error: " << GetLastError()
+                  << std::endl;
+        return 1;
+    }
+
+    // Every exit from here on, failed startups included, releases a handler
+    // waiting out a console close.
+    const int status = daemon.aggregatePort >= 0 ? runAggregator(daemon) : runCollector(options, daemon);
+    SetEvent(g_stopped);
+    return status;
+}
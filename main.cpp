@@ -1,6 +1,7 @@
 #include <chrono>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <windows.h>
 #include <string>
 #include <thread>
@@ -73,6 +74,7 @@ private:
 
     std::unique_ptr<ListViewManager> list_view_manager_;
     std::unique_ptr<ProcessMonitor> process_monitor_;
+    std::optional<UpdateBus::Subscription> process_updates_;
     std::unique_ptr<ButtonManager> button_manager_;
     std::unique_ptr<SystemInfoPanel> system_info_panel_;
     std::unique_ptr<TaskManager> task_manager_;
@@ -131,6 +133,11 @@ private:
                         const std::wstring availRam = GetMemoryLoadPercentage();
                         // Post messages to update RAM
                         PostMessage(hwnd, WM_APP + 103, 0, reinterpret_cast<LPARAM>(new std::wstring(availRam)));
+
+                        if (const auto sample = process_monitor_->getSystemSample()) {
+                            PostMessage(hwnd, WM_APP + 105, 0,
+                                        reinterpret_cast<LPARAM>(new std::wstring(GetCpuUtilisation(*sample))));
+                        }
                     }
                 },
                 1000ms
@@ -175,6 +182,9 @@ private:
         message_handlers_[WM_APP + 104] = [this](const HWND hwnd, const WPARAM wp, const LPARAM lp) {
             return handleProcessListUpdate(hwnd, wp, lp);
         };
+        message_handlers_[WM_APP + 105] = [this](const HWND hwnd, const WPARAM wp, const LPARAM lp) {
+            return handleCpuUsageUpdate(hwnd, wp, lp);
+        };
     }
 
     // Message handlers
@@ -204,8 +214,10 @@ private:
             PostQuitMessage(0);
         }
 
-        fetchSystemInfo(hwnd);
+        // The system info task reads CPU usage from the monitor, so it goes second.
         process_monitor_ = std::make_unique<ProcessMonitor>(*task_manager_, hwnd, list_view_manager_->getHWND());
+        process_updates_.emplace(process_monitor_->subscribe());
+        fetchSystemInfo(hwnd);
         return 0;
     }
 
@@ -269,10 +281,26 @@ private:
         return 0;
     }
 
-    LRESULT handleProcessListUpdate(HWND, WPARAM, const LPARAM lParam) const {
-        if (list_view_manager_) {
-            const auto data(reinterpret_cast<ProcessUpdateData *>(lParam));
-            list_view_manager_->applyListViewUpdates(data);
+    LRESULT handleCpuUsageUpdate(HWND, WPARAM, const LPARAM lParam) const {
+        if (system_info_panel_) {
+            const std::unique_ptr<std::wstring> data(reinterpret_cast<std::wstring *>(lParam));
+            system_info_panel_->SetCpuUsage(*data);
+        }
+        return 0;
+    }
+
+    LRESULT handleProcessListUpdate(HWND, WPARAM, LPARAM) {
+        if (!process_updates_ || !list_view_manager_) {
+            return 0;
+        }
+        // Everything published since the last message; after falling behind,
+        // the list is rebuilt from the snapshot the subscription resumed at.
+        while (const UpdateBus::TickPtr tick = process_updates_->tryNext()) {
+            if (process_updates_->resynced()) {
+                list_view_manager_->reload(*tick->snapshot);
+            } else {
+                list_view_manager_->applyListViewUpdates(*tick->diff);
+            }
         }
         return 0;
     }
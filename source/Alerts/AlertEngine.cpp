@@ -0,0 +1,321 @@
+#include "AlertEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ranges>
+
+namespace {
+    // Below this many samples an anomaly detector has no baseline to judge by.
+    constexpr uint32_t MinAnomalySamples = 8;
+
+    // Smallest standard deviation a detector divides by, per metric, so a
+    // perfectly flat series does not turn the first wiggle into an infinite
+    // z-score: half a CPU percentage point, 1 MB, 1 KB/s.
+    constexpr double MinDeviation[] = {0.5, 1024.0 * 1024.0, 1024.0};
+
+    size_t index(const MetricHistory::Metric metric) {
+        return static_cast<size_t>(metric);
+    }
+}
+
+AlertEngine::RuleId AlertEngine::addRule(AlertRule rule, const std::unordered_map<DWORD, ProcessInfo> &processes,
+                                         const Clock::time_point now) {
+    if (rules_.empty()) {
+        seed(processes, now);
+    }
+
+    const RuleId id = next_id_++;
+    Rule &entry = rules_[id];
+    entry.rule = std::move(rule);
+    if (entry.rule.signal == AlertRule::Signal::Anomaly) {
+        const auto it = std::find_if(detectors_.begin(), detectors_.end(), [&](const Detector &detector) {
+            return detector.metric == entry.rule.metric && detector.window == entry.rule.window;
+        });
+        entry.detector = static_cast<size_t>(it - detectors_.begin());
+        if (it == detectors_.end()) {
+            detectors_.push_back(Detector{entry.rule.metric, entry.rule.window});
+        }
+    }
+    reindex();
+
+    if (entry.rule.signal == AlertRule::Signal::Value) {
+        const size_t m = index(entry.rule.metric);
+        for (const auto &[pid, tracked]: tracked_) {
+            if (entry.rule.holds(tracked.value[m])) {
+                evaluate(id, entry, pid, tracked, tracked.value[m], now, pending_events_);
+            }
+        }
+    }
+    return id;
+}
+
+void AlertEngine::removeRule(const RuleId id) {
+    const auto removed = rules_.find(id);
+    if (removed == rules_.end()) {
+        return;
+    }
+    const bool anomaly = removed->second.rule.signal == AlertRule::Signal::Anomaly;
+    const size_t detector = removed->second.detector;
+    rules_.erase(removed);
+    if (anomaly) {
+        dropUnusedDetector(detector);
+    }
+    reindex();
+    if (rules_.empty()) {
+        // Nothing left to feed; start from the monitor's table again with the next rule.
+        tracked_.clear();
+        detectors_.clear();
+        pending_events_.clear();
+    }
+}
+
+// A detector no rule reads any more would otherwise keep its per-process
+// state, and its slot in every Tracked, until the last rule goes.
+void AlertEngine::dropUnusedDetector(const size_t detector) {
+    for (const Rule &rule: rules_ | std::views::values) {
+        if (rule.rule.signal == AlertRule::Signal::Anomaly && rule.detector == detector) {
+            return;
+        }
+    }
+    detectors_.erase(detectors_.begin() + static_cast<ptrdiff_t>(detector));
+    for (Rule &rule: rules_ | std::views::values) {
+        if (rule.rule.signal == AlertRule::Signal::Anomaly && rule.detector > detector) {
+            --rule.detector;
+        }
+    }
+    for (Tracked &tracked: tracked_ | std::views::values) {
+        if (tracked.detectors.size() > detector) {
+            tracked.detectors.erase(tracked.detectors.begin() + static_cast<ptrdiff_t>(detector));
+        }
+    }
+}
+
+void AlertEngine::applyTick(const ProcessUpdateData &diff, const Clock::time_point now,
+                            std::vector<AlertEvent> &out) {
+    if (rules_.empty()) {
+        return;
+    }
+    out.insert(out.end(), std::make_move_iterator(pending_events_.begin()),
+               std::make_move_iterator(pending_events_.end()));
+    pending_events_.clear();
+
+    for (const DWORD pid: diff.removed_pids) {
+        const auto tracked = tracked_.find(pid);
+        if (tracked == tracked_.end()) {
+            continue;
+        }
+        for (auto &[id, rule]: rules_) {
+            if (const auto it = rule.breaches.find(pid); it != rule.breaches.end()) {
+                if (it->second.firing) {
+                    emit(AlertEvent::Kind::Resolved, id, rule, pid, tracked->second.name, it->second.signal, now, out);
+                }
+                rule.breaches.erase(it);
+            }
+        }
+        tracked_.erase(tracked);
+    }
+
+    for (const ProcessInfo &info: diff.added) {
+        Tracked &tracked = tracked_[info.pid];
+        tracked = Tracked{};
+        tracked.name.assign(info.name.begin(), info.name.end());
+        observe(info.pid, tracked, MetricHistory::Metric::Cpu, info.cpuUsage, now, out);
+        observe(info.pid, tracked, MetricHistory::Metric::Ram, static_cast<double>(info.ramUsage), now, out);
+        observe(info.pid, tracked, MetricHistory::Metric::Io, info.ioRate, now, out);
+    }
+
+    for (const ProcessDelta &delta: diff.updated) {
+        const auto it = tracked_.find(delta.pid);
+        if (it == tracked_.end()) {
+            continue;
+        }
+        if (delta.changed & ProcessDelta::Cpu) {
+            observe(delta.pid, it->second, MetricHistory::Metric::Cpu, delta.cpuUsage, now, out);
+        }
+        if (delta.changed & ProcessDelta::Ram) {
+            observe(delta.pid, it->second, MetricHistory::Metric::Ram, static_cast<double>(delta.ramUsage), now, out);
+        }
+        if (delta.changed & ProcessDelta::Io) {
+            observe(delta.pid, it->second, MetricHistory::Metric::Io, delta.ioRate, now, out);
+        }
+    }
+
+    for (auto &[id, rule]: rules_) {
+        expire(id, rule, now, out);
+    }
+}
+
+// Current values only; detectors and rates start with the next reports.
+void AlertEngine::seed(const std::unordered_map<DWORD, ProcessInfo> &processes, const Clock::time_point now) {
+    tracked_.clear();
+    tracked_.reserve(processes.size());
+    for (const auto &[pid, info]: processes) {
+        Tracked &tracked = tracked_[pid];
+        tracked.name.assign(info.name.begin(), info.name.end());
+        tracked.value = {info.cpuUsage, static_cast<double>(info.ramUsage), info.ioRate};
+        tracked.at.fill(now);
+    }
+}
+
+void AlertEngine::observe(const DWORD pid, Tracked &tracked, const MetricHistory::Metric metric, const double value,
+                          const Clock::time_point now, std::vector<AlertEvent> &out) {
+    const size_t m = index(metric);
+    const bool hadValue = tracked.at[m] != Clock::time_point{};
+    const double previous = tracked.value[m];
+    const Clock::time_point previousAt = tracked.at[m];
+    tracked.value[m] = value;
+    tracked.at[m] = now;
+
+    // Score against the baseline before this value joins it.
+    if (tracked.detectors.size() < detectors_.size()) {
+        tracked.detectors.resize(detectors_.size());
+    }
+    scores_.resize(detectors_.size());
+    for (size_t d = 0; d < detectors_.size(); ++d) {
+        if (detectors_[d].metric != metric) {
+            continue;
+        }
+        Ewma &ewma = tracked.detectors[d];
+        scores_[d] = ewma.samples >= MinAnomalySamples
+                         ? (value - ewma.mean) / std::max(std::sqrt(ewma.variance), MinDeviation[m])
+                         : std::numeric_limits<double>::quiet_NaN();
+        if (ewma.samples++ == 0) {
+            ewma.mean = value;
+            continue;
+        }
+        // Reports arrive irregularly, so the weight follows the time since the last one.
+        const double elapsed = hadValue ? std::chrono::duration<double>(now - previousAt).count() : 0.0;
+        const double window = std::chrono::duration<double>(detectors_[d].window).count();
+        const double alpha = 1.0 - std::exp(-std::max(elapsed, 0.001) / window);
+        const double deviation = value - ewma.mean;
+        const double increment = alpha * deviation;
+        ewma.mean += increment;
+        ewma.variance = (1.0 - alpha) * (ewma.variance + deviation * increment);
+    }
+
+    for (const auto &[id, rule]: by_metric_[m]) {
+        switch (rule->rule.signal) {
+            case AlertRule::Signal::Value:
+                evaluate(id, *rule, pid, tracked, value, now, out);
+                break;
+            case AlertRule::Signal::Anomaly:
+                if (!std::isnan(scores_[rule->detector])) {
+                    evaluate(id, *rule, pid, tracked, scores_[rule->detector], now, out);
+                }
+                break;
+            case AlertRule::Signal::Rate: {
+                // Only a fast change opens a window; the window's end decides.
+                if (!hadValue || rule->breaches.contains(pid)) {
+                    break;
+                }
+                const double seconds = std::chrono::duration<double>(now - previousAt).count();
+                if (seconds <= 0.0 || !rule->rule.holds((value - previous) / seconds)) {
+                    break;
+                }
+                Breach &breach = rule->breaches[pid];
+                breach.since = now;
+                breach.epoch = ++rule->epochs;
+                breach.signal = (value - previous) / seconds;
+                breach.baseline = previous;
+                breach.baselineAt = previousAt;
+                rule->deadlines.push_back(Deadline{now + rule->rule.duration, pid, breach.epoch});
+                break;
+            }
+        }
+    }
+}
+
+// Value and anomaly rules: a breach starts when the signal holds and ends the
+// first time it does not.
+void AlertEngine::evaluate(const RuleId id, Rule &rule, const DWORD pid, const Tracked &tracked, const double signal,
+                           const Clock::time_point now, std::vector<AlertEvent> &out) {
+    const auto it = rule.breaches.find(pid);
+    if (!rule.rule.holds(signal)) {
+        if (it != rule.breaches.end()) {
+            if (it->second.firing) {
+                emit(AlertEvent::Kind::Resolved, id, rule, pid, tracked.name, signal, now, out);
+            }
+            rule.breaches.erase(it);
+        }
+        return;
+    }
+    if (it != rule.breaches.end()) {
+        it->second.signal = signal;
+        return;
+    }
+
+    Breach &breach = rule.breaches[pid];
+    breach.since = now;
+    breach.epoch = ++rule.epochs;
+    breach.signal = signal;
+    if (rule.rule.duration.count() <= 0) {
+        breach.firing = true;
+        emit(AlertEvent::Kind::Fired, id, rule, pid, tracked.name, signal, now, out);
+    } else {
+        rule.deadlines.push_back(Deadline{now + rule.rule.duration, pid, breach.epoch});
+    }
+}
+
+void AlertEngine::expire(const RuleId id, Rule &rule, const Clock::time_point now, std::vector<AlertEvent> &out) {
+    while (!rule.deadlines.empty() && rule.deadlines.front().at <= now) {
+        const Deadline deadline = rule.deadlines.front();
+        rule.deadlines.pop_front();
+        const auto it = rule.breaches.find(deadline.pid);
+        if (it == rule.breaches.end() || it->second.epoch != deadline.epoch) {
+            continue;  // the breach ended (or restarted) in the meantime
+        }
+        Breach &breach = it->second;
+        const Tracked &tracked = tracked_.at(deadline.pid);
+
+        if (rule.rule.signal != AlertRule::Signal::Rate) {
+            if (!breach.firing) {
+                breach.firing = true;
+                emit(AlertEvent::Kind::Fired, id, rule, deadline.pid, tracked.name, breach.signal, now, out);
+            }
+            continue;
+        }
+
+        // Average growth over the whole window, then keep measuring window by window.
+        const double current = tracked.value[index(rule.rule.metric)];
+        const double seconds = std::chrono::duration<double>(now - breach.baselineAt).count();
+        breach.signal = seconds > 0.0 ? (current - breach.baseline) / seconds : 0.0;
+        if (!rule.rule.holds(breach.signal)) {
+            if (breach.firing) {
+                emit(AlertEvent::Kind::Resolved, id, rule, deadline.pid, tracked.name, breach.signal, now, out);
+            }
+            rule.breaches.erase(it);
+            continue;
+        }
+        if (!breach.firing) {
+            breach.firing = true;
+            emit(AlertEvent::Kind::Fired, id, rule, deadline.pid, tracked.name, breach.signal, now, out);
+        }
+        breach.baseline = current;
+        breach.baselineAt = now;
+        breach.epoch = ++rule.epochs;
+        rule.deadlines.push_back(Deadline{now + rule.rule.duration, deadline.pid, breach.epoch});
+    }
+}
+
+void AlertEngine::emit(const AlertEvent::Kind kind, const RuleId id, const Rule &rule, const DWORD pid,
+                       const std::wstring &name, const double value, const Clock::time_point now,
+                       std::vector<AlertEvent> &out) {
+    AlertEvent &event = out.emplace_back();
+    event.kind = kind;
+    event.rule = id;
+    event.ruleText = rule.rule.text;
+    event.pid = pid;
+    event.processName = name;
+    event.value = value;
+    event.time = now;
+}
+
+void AlertEngine::reindex() {
+    for (auto &rules: by_metric_) {
+        rules.clear();
+    }
+    for (auto &[id, rule]: rules_) {
+        by_metric_[index(rule.rule.metric)].emplace_back(id, &rule);
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef AlertEngine_h
+#define AlertEngine_h
+
+#include <windows.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AlertRule.h"
+#include "ProcessInfo.h"
+
+struct AlertEvent {
+    enum class Kind : uint8_t { Fired, Resolved };
+
+    Kind kind = Kind::Fired;
+    uint32_t rule = 0;
+    std::wstring ruleText;
+    DWORD pid = 0;
+    std::wstring processName;
+    double value = 0.0;  // the signal that fired it: metric value, rate per second or z-score
+    std::chrono::steady_clock::time_point time;
+};
+
+// Evaluates alert rules incrementally from the monitor's per-tick diffs.
+//
+// Rules are indexed by metric, so a delta only runs the rules on the fields it
+// carries: one hash lookup and a few arithmetic operations per rule, never a
+// pass over the table. Rule state exists only for processes currently in
+// breach. A duration ("for 30s") does not need further updates to complete: a
+// metric that stays put is not reported again, so every breach queues its
+// deadline, and since a rule's duration is fixed those deadlines arrive in
+// order and sit in a plain FIFO per rule.
+//
+// Anomaly detectors keep a time-weighted EWMA mean and variance per process,
+// shared by every rule with the same metric and window and dropped with the
+// last of those rules. They only see reported values; a value that did not
+// move past the monitor's change threshold is not a sample.
+class AlertEngine {
+public:
+    using RuleId = uint32_t;
+
+    // The new rule is checked against the current values of `processes` at
+    // once; what that fires is reported with the next applyTick. Anomaly and
+    // rate rules need samples first.
+    RuleId addRule(AlertRule rule, const std::unordered_map<DWORD, ProcessInfo> &processes,
+                   std::chrono::steady_clock::time_point now);
+    // Drops the rule and its state without emitting Resolved events.
+    void removeRule(RuleId id);
+    [[nodiscard]] size_t ruleCount() const { return rules_.size(); }
+
+    // Folds one tick's diff in and appends the events it caused to `out`.
+    // Also completes durations that ran out since the last call. Without
+    // rules this only drops state.
+    void applyTick(const ProcessUpdateData &diff, std::chrono::steady_clock::time_point now,
+                   std::vector<AlertEvent> &out);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t MetricCount = MetricHistory::MetricCount;
+
+    struct Ewma {
+        double mean = 0.0;
+        double variance = 0.0;
+        uint32_t samples = 0;
+    };
+
+    struct Tracked {
+        std::wstring name;
+        std::array<double, MetricCount> value{};
+        std::array<Clock::time_point, MetricCount> at{};  // when value was reported
+        std::vector<Ewma> detectors;                      // indexed like detectors_
+    };
+
+    struct Breach {
+        Clock::time_point since;
+        uint64_t epoch = 0;      // tells a queued deadline from a later breach of the same pid
+        double signal = 0.0;
+        double baseline = 0.0;   // rate(): value the growth is measured from
+        Clock::time_point baselineAt;
+        bool firing = false;
+    };
+
+    struct Deadline {
+        Clock::time_point at;
+        DWORD pid;
+        uint64_t epoch;
+    };
+
+    struct Rule {
+        AlertRule rule;
+        size_t detector = 0;     // anomaly() only
+        std::unordered_map<DWORD, Breach> breaches;
+        std::deque<Deadline> deadlines;
+        uint64_t epochs = 0;
+    };
+
+    struct Detector {
+        MetricHistory::Metric metric;
+        std::chrono::milliseconds window;
+    };
+
+    void seed(const std::unordered_map<DWORD, ProcessInfo> &processes, Clock::time_point now);
+    void observe(DWORD pid, Tracked &tracked, MetricHistory::Metric metric, double value, Clock::time_point now,
+                 std::vector<AlertEvent> &out);
+    static void evaluate(RuleId id, Rule &rule, DWORD pid, const Tracked &tracked, double signal,
+                         Clock::time_point now, std::vector<AlertEvent> &out);
+    void expire(RuleId id, Rule &rule, Clock::time_point now, std::vector<AlertEvent> &out);
+    static void emit(AlertEvent::Kind kind, RuleId id, const Rule &rule, DWORD pid, const std::wstring &name,
+                     double value, Clock::time_point now, std::vector<AlertEvent> &out);
+    void dropUnusedDetector(size_t detector);
+    void reindex();
+
+    std::map<RuleId, Rule> rules_;
+    std::array<std::vector<std::pair<RuleId, Rule *>>, MetricCount> by_metric_;
+    std::vector<Detector> detectors_;
+    std::unordered_map<DWORD, Tracked> tracked_;
+    std::vector<double> scores_;  // scratch: z-score per detector for the value being observed, NaN while warming up
+    std::vector<AlertEvent> pending_events_;  // from addRule, delivered with the next tick
+    RuleId next_id_ = 1;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include "AlertRule.h"
+
+#include <cwchar>
+#include <cwctype>
+
+#include "Query/StringInterner.h"
+
+namespace {
+    std::string narrow(const std::wstring_view text) {
+        std::string out;
+        for (const wchar_t c: text) {
+            out.push_back(c < 0x80 ? static_cast<char>(c) : '?');
+        }
+        return out;
+    }
+
+    //   rule   := signal compare number ["for" duration]
+    //   signal := metric | "rate" "(" metric ")" | "anomaly" "(" metric ["," duration] ")"
+    class Parser {
+    public:
+        Parser(const std::wstring_view text, AlertRule &rule) : text_(text), rule_(rule) {}
+
+        bool parse(std::string *error) {
+            if (parseRule()) {
+                return true;
+            }
+            if (error) {
+                *error = error_;
+            }
+            return false;
+        }
+
+    private:
+        std::wstring_view text_;
+        AlertRule &rule_;
+        size_t pos_ = 0;
+        std::string error_;
+
+        bool fail(const char *what) {
+            if (error_.empty()) {
+                error_ = std::string("alert: ") + what + " at offset " + std::to_string(pos_);
+            }
+            return false;
+        }
+
+        void skipSpace() {
+            while (pos_ < text_.size() && std::iswspace(text_[pos_])) {
+                ++pos_;
+            }
+        }
+
+        bool accept(const std::wstring_view symbol) {
+            skipSpace();
+            if (text_.substr(pos_, symbol.size()) != symbol) {
+                return false;
+            }
+            pos_ += symbol.size();
+            return true;
+        }
+
+        // Letters only, folded; leaves pos_ alone when there are none.
+        std::wstring word() {
+            skipSpace();
+            const size_t start = pos_;
+            while (pos_ < text_.size() && std::iswalpha(text_[pos_])) {
+                ++pos_;
+            }
+            return StringInterner::fold(text_.substr(start, pos_ - start));
+        }
+
+        std::wstring_view token() {
+            skipSpace();
+            const size_t start = pos_;
+            while (pos_ < text_.size() && !std::iswspace(text_[pos_]) && text_[pos_] != L')' && text_[pos_] != L',') {
+                ++pos_;
+            }
+            return text_.substr(start, pos_ - start);
+        }
+
+        bool parseMetric() {
+            const size_t start = pos_;
+            const std::wstring field = word();
+            using enum MetricHistory::Metric;
+            if (field == L"cpu") rule_.metric = Cpu;
+            else if (field == L"ram" || field == L"mem") rule_.metric = Ram;
+            else if (field == L"io") rule_.metric = Io;
+            else {
+                pos_ = start;
+                return fail("expected cpu, ram or io");
+            }
+            return true;
+        }
+
+        bool parseSignal() {
+            const size_t start = pos_;
+            const std::wstring function = word();
+            if (function == L"rate" || function == L"anomaly") {
+                if (!accept(L"(")) {
+                    return fail("expected '('");
+                }
+                rule_.signal = function == L"rate" ? AlertRule::Signal::Rate : AlertRule::Signal::Anomaly;
+                if (!parseMetric()) {
+                    return false;
+                }
+                if (rule_.signal == AlertRule::Signal::Anomaly && accept(L",")) {
+                    const size_t windowAt = pos_;
+                    if (!parseDuration(rule_.window)) {
+                        return false;
+                    }
+                    if (rule_.window.count() <= 0) {
+                        // Would weigh every sample fully, so nothing is ever unusual.
+                        pos_ = windowAt;
+                        return fail("anomaly() window must be longer than zero");
+                    }
+                }
+                return accept(L")") || fail("expected ')'");
+            }
+            pos_ = start;
+            return parseMetric();
+        }
+
+        bool parseCompare() {
+            using enum AlertRule::Compare;
+            // Longest operators first.
+            if (accept(L"<=")) rule_.compare = LessEqual;
+            else if (accept(L">=")) rule_.compare = GreaterEqual;
+            else if (accept(L"!=")) rule_.compare = NotEqual;
+            else if (accept(L"==") || accept(L"=")) rule_.compare = Equal;
+            else if (accept(L"<")) rule_.compare = Less;
+            else if (accept(L">")) rule_.compare = Greater;
+            else return fail("expected comparison");
+            return true;
+        }
+
+        bool parseNumber() {
+            const std::wstring value(token());
+            wchar_t *end = nullptr;
+            double number = std::wcstod(value.c_str(), &end);
+            if (end == value.c_str()) {
+                return fail("expected number");
+            }
+            std::wstring suffix = StringInterner::fold(end);
+
+            double perSecond = 1.0;
+            if (const size_t slash = suffix.find(L'/'); slash != std::wstring::npos) {
+                const std::wstring per = suffix.substr(slash + 1);
+                if (rule_.signal != AlertRule::Signal::Rate) {
+                    return fail("only rate() takes a per-time unit");
+                }
+                if (per == L"s") perSecond = 1.0;
+                else if (per == L"m" || per == L"min") perSecond = 60.0;
+                else if (per == L"h") perSecond = 3600.0;
+                else return fail(("unknown time unit '" + narrow(per) + "'").c_str());
+                suffix.resize(slash);
+            }
+
+            if (suffix.empty() || suffix == L"%") {}
+            else if (suffix == L"k" || suffix == L"kb") number *= 1024.0;
+            else if (suffix == L"m" || suffix == L"mb") number *= 1024.0 * 1024.0;
+            else if (suffix == L"g" || suffix == L"gb") number *= 1024.0 * 1024.0 * 1024.0;
+            else return fail(("unknown unit '" + narrow(suffix) + "'").c_str());
+
+            rule_.threshold = number / perSecond;
+            return true;
+        }
+
+        bool parseDuration(std::chrono::milliseconds &duration) {
+            const std::wstring value(token());
+            wchar_t *end = nullptr;
+            const double number = std::wcstod(value.c_str(), &end);
+            if (end == value.c_str() || number < 0.0) {
+                return fail("expected duration");
+            }
+            const std::wstring unit = StringInterner::fold(end);
+            double ms;
+            if (unit == L"ms") ms = number;
+            else if (unit == L"s" || unit.empty()) ms = number * 1000.0;
+            else if (unit == L"m" || unit == L"min") ms = number * 60'000.0;
+            else if (unit == L"h") ms = number * 3'600'000.0;
+            else return fail(("unknown duration unit '" + narrow(unit) + "'").c_str());
+            // Also catches inf and nan, which wcstod accepts.
+            if (!(ms <= static_cast<double>(AlertRule::MaxDuration.count()))) {
+                return fail("duration longer than a week");
+            }
+            duration = std::chrono::milliseconds(static_cast<int64_t>(ms));
+            return true;
+        }
+
+        bool parseRule() {
+            if (!parseSignal() || !parseCompare() || !parseNumber()) {
+                return false;
+            }
+            const size_t beforeFor = pos_;
+            if (word() == L"for") {
+                if (!parseDuration(rule_.duration)) {
+                    return false;
+                }
+            } else {
+                pos_ = beforeFor;
+            }
+            skipSpace();
+            if (pos_ != text_.size()) {
+                return fail("unexpected input");
+            }
+            if (rule_.signal == AlertRule::Signal::Rate && rule_.duration.count() <= 0) {
+                return fail("rate() needs a 'for' window");
+            }
+            return true;
+        }
+    };
+}
+
+std::optional<AlertRule> AlertRule::compile(const std::wstring_view text, std::string *error) {
+    AlertRule rule;
+    rule.text = text;
+    if (!Parser(rule.text, rule).parse(error)) {
+        return std::nullopt;
+    }
+    return rule;
+}
+
+bool AlertRule::holds(const double value) const {
+    switch (compare) {
+        case Compare::Less: return value < threshold;
+        case Compare::LessEqual: return value <= threshold;
+        case Compare::Greater: return value > threshold;
+        case Compare::GreaterEqual: return value >= threshold;
+        case Compare::Equal: return value == threshold;
+        case Compare::NotEqual: return value != threshold;
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+#ifndef AlertRule_h
+#define AlertRule_h
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "History/MetricHistory.h"
+
+// One alert condition on a single metric of every process, compiled from text:
+//
+//   cpu > 90% for 30s               threshold, held for a duration
+//   ram >= 2GB                      threshold, fires at once
+//   rate(ram) > 5MB/s for 2m        average growth over the window
+//   anomaly(io) > 4                 z-score against the process's own EWMA
+//   anomaly(cpu, 10m) > 3 for 20s   EWMA window (default 5m), then duration
+//
+// Metrics: cpu, ram (alias mem), io. Operators: < <= > >= = !=. Numbers may
+// carry %, K/KB, M/MB, G/GB, and rates a trailing /s, /m (/min) or /h; rates
+// are compared per second. Durations take ms, s, m (min) or h, up to a week;
+// an anomaly() window must be longer than zero.
+//
+// rate() needs a window: growth is measured from the value before the first
+// fast change to the value when the window closes, so a process whose value
+// stops moving (and therefore stops being reported) cannot hold an alert up.
+struct AlertRule {
+    enum class Signal : uint8_t { Value, Rate, Anomaly };
+    enum class Compare : uint8_t { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    static constexpr std::chrono::milliseconds DefaultAnomalyWindow{5 * 60 * 1000};
+    // Longest duration or window a rule may give; past it the text is rejected.
+    static constexpr std::chrono::milliseconds MaxDuration{7 * 24 * 60 * 60 * 1000LL};
+
+    static std::optional<AlertRule> compile(std::wstring_view text, std::string *error = nullptr);
+
+    [[nodiscard]] bool holds(double value) const;
+
+    std::wstring text;
+    MetricHistory::Metric metric = MetricHistory::Metric::Cpu;
+    Signal signal = Signal::Value;
+    Compare compare = Compare::Greater;
+    double threshold = 0.0;
+    std::chrono::milliseconds duration{0};
+    std::chrono::milliseconds window = DefaultAnomalyWindow;  // anomaly() only
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "LeakDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LeakDetector::setConfig(const Config &config) {
+    config_ = config;
+    suspects_.clear();
+    for (const auto &[pid, fit]: fits_) {
+        if (evaluate(pid, fit).suspect) {
+            suspects_.insert(pid);
+        }
+    }
+}
+
+void LeakDetector::add(const DWORD pid, const Clock::time_point time, const SIZE_T bytes) {
+    if (!epoch_) {
+        epoch_ = time;
+    }
+    const double t = std::chrono::duration<double>(time - *epoch_).count();
+    const double y = static_cast<double>(bytes);
+
+    Fit &fit = fits_[pid];
+    if (fit.weight == 0.0) {
+        fit.first = fit.last = t;
+        fit.weight = 1.0;
+        fit.meanT = t;
+        fit.meanBytes = y;
+        return;
+    }
+
+    // Age everything seen so far, then add this sample with weight 1. Scaling
+    // all weights leaves the means alone and scales the co-moments.
+    const double window = static_cast<double>(config_.window.count());
+    const double decay = std::exp(-std::max(t - fit.last, 0.0) / window);
+    fit.last = t;
+    fit.weight = fit.weight * decay + 1.0;
+    fit.ctt *= decay;
+    fit.ctb *= decay;
+    fit.cbb *= decay;
+
+    const double dt = t - fit.meanT;
+    const double db = y - fit.meanBytes;
+    fit.meanT += dt / fit.weight;
+    fit.meanBytes += db / fit.weight;
+    fit.ctt += dt * (t - fit.meanT);
+    fit.ctb += dt * (y - fit.meanBytes);
+    fit.cbb += db * (y - fit.meanBytes);
+
+    if (evaluate(pid, fit).suspect) {
+        suspects_.insert(pid);
+    } else {
+        suspects_.erase(pid);
+    }
+}
+
+void LeakDetector::remove(const DWORD pid) {
+    fits_.erase(pid);
+    suspects_.erase(pid);
+}
+
+std::optional<LeakDetector::Estimate> LeakDetector::estimate(const DWORD pid) const {
+    const auto it = fits_.find(pid);
+    if (it == fits_.end()) {
+        return std::nullopt;
+    }
+    return evaluate(pid, it->second);
+}
+
+std::vector<LeakDetector::Estimate> LeakDetector::suspects() const {
+    std::vector<Estimate> result;
+    result.reserve(suspects_.size());
+    for (const DWORD pid: suspects_) {
+        result.push_back(evaluate(pid, fits_.at(pid)));
+    }
+    constexpr auto never = std::chrono::seconds::max();
+    std::sort(result.begin(), result.end(), [never](const Estimate &a, const Estimate &b) {
+        const auto ta = a.timeToBudget.value_or(never);
+        const auto tb = b.timeToBudget.value_or(never);
+        return ta != tb ? ta < tb : a.bytesPerSecond > b.bytesPerSecond;
+    });
+    return result;
+}
+
+LeakDetector::Estimate LeakDetector::evaluate(const DWORD pid, const Fit &fit) const {
+    Estimate estimate;
+    estimate.pid = pid;
+    estimate.fittedBytes = fit.meanBytes;
+    estimate.observed = std::chrono::seconds(static_cast<int64_t>(fit.last - fit.first));
+    if (fit.ctt <= 0.0) {
+        return estimate;  // one sample, or all at the same instant
+    }
+
+    estimate.bytesPerSecond = fit.ctb / fit.ctt;
+    // A flat series has no variance to explain; it is not growing either.
+    estimate.rSquared = fit.cbb > 0.0 ? std::min(fit.ctb * fit.ctb / (fit.ctt * fit.cbb), 1.0) : 0.0;
+    estimate.fittedBytes = fit.meanBytes + estimate.bytesPerSecond * (fit.last - fit.meanT);
+
+    if (config_.budgetBytes > 0 && estimate.bytesPerSecond > 0.0) {
+        const double remaining = static_cast<double>(config_.budgetBytes) - estimate.fittedBytes;
+        estimate.timeToBudget = std::chrono::seconds(
+            static_cast<int64_t>(std::clamp(remaining / estimate.bytesPerSecond, 0.0, 1e15)));
+    }
+    estimate.suspect = estimate.observed >= config_.minObserved &&
+                       estimate.bytesPerSecond >= config_.minGrowth &&
+                       estimate.rSquared >= config_.minRSquared;
+    return estimate;
+}
@@ -0,0 +1,82 @@
+#ifndef LeakDetector_h
+#define LeakDetector_h
+
+#include <windows.h>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Flags processes whose memory grows steadily, from one sample per tick.
+//
+// Each process keeps an exponentially weighted least-squares fit of working
+// set against time: weighted means and co-moments updated in Welford form, so
+// the state is a handful of doubles however long the process lives, and the
+// fit stays accurate when the values are large and the trend is small. Old
+// samples fade with time constant `window` (by elapsed time, so an irregular
+// tick rate does not change the horizon).
+//
+// A process is a suspect when it has been observed for at least `minObserved`,
+// the slope is at least `minGrowth`, and the fit explains at least
+// `minRSquared` of the variance. The last condition separates steady leaks
+// from processes that merely grow and shrink, including working-set trims.
+// The suspect set is maintained per sample, so listing it does not scan the
+// table.
+class LeakDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        std::chrono::seconds window{4 * 3600};
+        std::chrono::seconds minObserved{30 * 60};
+        double minGrowth = 1024.0 * 1024.0 / 3600.0;  // bytes per second (1 MB/h)
+        double minRSquared = 0.9;
+        uint64_t budgetBytes = 0;                     // 0: no projection
+    };
+
+    struct Estimate {
+        DWORD pid = 0;
+        double bytesPerSecond = 0.0;  // slope of the fit
+        double rSquared = 0.0;        // 0..1, how steady the growth is
+        double fittedBytes = 0.0;     // the fit's value at the latest sample
+        std::chrono::seconds observed{0};
+        // When the fit reaches budgetBytes, from the latest sample; nullopt
+        // without a budget or growth.
+        std::optional<std::chrono::seconds> timeToBudget;
+        bool suspect = false;
+    };
+
+    void setConfig(const Config &config);
+    [[nodiscard]] const Config &config() const { return config_; }
+
+    void add(DWORD pid, Clock::time_point time, SIZE_T bytes);
+    void remove(DWORD pid);
+
+    [[nodiscard]] std::optional<Estimate> estimate(DWORD pid) const;
+    // Current suspects, the soonest to reach the budget first.
+    [[nodiscard]] std::vector<Estimate> suspects() const;
+    [[nodiscard]] size_t size() const { return fits_.size(); }
+
+private:
+    struct Fit {
+        double first = 0.0;    // time of the first sample, seconds since epoch_
+        double last = 0.0;     // time of the latest sample
+        double weight = 0.0;   // sum of weights
+        double meanT = 0.0;
+        double meanBytes = 0.0;
+        double ctt = 0.0;      // weighted co-moments
+        double ctb = 0.0;
+        double cbb = 0.0;
+    };
+
+    [[nodiscard]] Estimate evaluate(DWORD pid, const Fit &fit) const;
+
+    Config config_;
+    std::optional<Clock::time_point> epoch_;
+    std::unordered_map<DWORD, Fit> fits_;
+    std::unordered_set<DWORD> suspects_;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "ProcessTree.h"
+
+#include <algorithm>
+
+ProcessTree::Totals ProcessTree::totalsOf(const ProcessInfo &info) {
+    return Totals{info.cpuUsage, static_cast<uint64_t>(info.ramUsage), info.ioRate, 1};
+}
+
+// Applies sign * delta to `from` and every ancestor of it.
+void ProcessTree::propagate(DWORD from, const Totals &delta, const int sign) {
+    while (from != 0) {
+        const auto it = nodes_.find(from);
+        if (it == nodes_.end()) {
+            return;
+        }
+        Totals &t = it->second.subtree;
+        t.cpu += sign * delta.cpu;
+        t.ram += sign > 0 ? delta.ram : 0 - delta.ram;  // modular; exact for balanced add/remove
+        t.io += sign * delta.io;
+        t.count += sign > 0 ? delta.count : 0 - delta.count;
+        from = it->second.parent;
+    }
+}
+
+bool ProcessTree::isAncestor(const DWORD candidate, DWORD pid) const {
+    while (pid != 0) {
+        if (pid == candidate) {
+            return true;
+        }
+        const auto it = nodes_.find(pid);
+        if (it == nodes_.end()) {
+            return false;
+        }
+        pid = it->second.parent;
+    }
+    return false;
+}
+
+void ProcessTree::link(const DWORD pid, const DWORD parent) {
+    if (parent == 0 || parent == pid || !nodes_.contains(parent) || isAncestor(pid, parent)) {
+        return;
+    }
+    Node &node = nodes_.at(pid);
+    // A parent that started after the child holds a reused PID.
+    if (const uint64_t parentCreated = nodes_.at(parent).createTime;
+        parentCreated != 0 && node.createTime != 0 && parentCreated > node.createTime) {
+        return;
+    }
+    node.parent = parent;
+    nodes_.at(parent).children.push_back(pid);
+    propagate(parent, node.subtree, +1);
+}
+
+void ProcessTree::unlink(const DWORD pid) {
+    Node &node = nodes_.at(pid);
+    if (node.parent == 0) {
+        return;
+    }
+    propagate(node.parent, node.subtree, -1);
+    auto &siblings = nodes_.at(node.parent).children;
+    if (const auto it = std::ranges::find(siblings, pid); it != siblings.end()) {
+        *it = siblings.back();
+        siblings.pop_back();
+    }
+    node.parent = 0;
+}
+
+void ProcessTree::add(const ProcessInfo &info) {
+    remove(info.pid);
+    Node &node = nodes_[info.pid];
+    node.reportedParent = info.parentPid;
+    node.createTime = info.createTime;
+    node.self = totalsOf(info);
+    node.subtree = node.self;
+
+    if (nodes_.contains(info.parentPid)) {
+        link(info.pid, info.parentPid);
+    } else if (info.parentPid != 0) {
+        waiting_[info.parentPid].push_back(info.pid);
+    }
+
+    if (const auto it = waiting_.find(info.pid); it != waiting_.end()) {
+        for (const DWORD child: it->second) {
+            if (const auto c = nodes_.find(child); c != nodes_.end() && c->second.parent == 0 &&
+                                                   c->second.reportedParent == info.pid) {
+                link(child, info.pid);
+            }
+        }
+        waiting_.erase(it);
+    }
+}
+
+void ProcessTree::update(const ProcessDelta &delta) {
+    const auto it = nodes_.find(delta.pid);
+    if (it == nodes_.end()) {
+        return;
+    }
+
+    Totals &self = it->second.self;
+    Totals change{};
+    if (delta.changed & ProcessDelta::Cpu) {
+        change.cpu = delta.cpuUsage - self.cpu;
+        self.cpu = delta.cpuUsage;
+    }
+    if (delta.changed & ProcessDelta::Ram) {
+        change.ram = static_cast<uint64_t>(delta.ramUsage) - self.ram;
+        self.ram = delta.ramUsage;
+    }
+    if (delta.changed & ProcessDelta::Io) {
+        change.io = delta.ioRate - self.io;
+        self.io = delta.ioRate;
+    }
+    propagate(delta.pid, change, +1);
+}
+
+void ProcessTree::remove(const DWORD pid) {
+    const auto it = nodes_.find(pid);
+    if (it == nodes_.end()) {
+        return;
+    }
+    unlink(pid);
+
+    // Orphans become roots; Windows does not re-parent them either.
+    for (const DWORD child: it->second.children) {
+        if (const auto c = nodes_.find(child); c != nodes_.end()) {
+            c->second.parent = 0;
+        }
+    }
+    nodes_.erase(it);
+}
+
+void ProcessTree::endTick() {
+    waiting_.clear();
+}
+
+std::optional<ProcessTree::Totals> ProcessTree::subtree(const DWORD pid) const {
+    const auto it = nodes_.find(pid);
+    if (it == nodes_.end()) {
+        return std::nullopt;
+    }
+    return it->second.subtree;
+}
+
+DWORD ProcessTree::parentOf(const DWORD pid) const {
+    const auto it = nodes_.find(pid);
+    return it != nodes_.end() ? it->second.parent : 0;
+}
+
+std::vector<ProcessTree::Subtree> ProcessTree::children(const DWORD pid) const {
+    std::vector<Subtree> out;
+    const auto it = nodes_.find(pid);
+    if (it == nodes_.end()) {
+        return out;
+    }
+    out.reserve(it->second.children.size());
+    for (const DWORD child: it->second.children) {
+        out.push_back(Subtree{child, nodes_.at(child).subtree});
+    }
+    return out;
+}
+
+std::vector<ProcessTree::Subtree> ProcessTree::roots() const {
+    std::vector<Subtree> out;
+    for (const auto &[pid, node]: nodes_) {
+        if (node.parent == 0) {
+            out.push_back(Subtree{pid, node.subtree});
+        }
+    }
+    return out;
+}
@@ -0,0 +1,72 @@
+#ifndef ProcessTree_h
+#define ProcessTree_h
+
+#include <windows.h>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+
+// Parent/child index over the live process table with per-subtree totals.
+//
+// Every node keeps the sum of CPU, RAM, I/O and process count over itself and
+// its descendants. A change to one process adds its delta to each ancestor, so
+// an update costs O(depth) and nothing is recomputed per tick.
+//
+// Windows reports the parent PID as it was at creation and never re-parents
+// orphans, so a parent may have exited or its PID may have been reused. A
+// process is only linked under a parent that started before it; where either
+// creation time is unknown, linking that would close a cycle is still refused.
+// A process whose parent is unknown becomes a root. Children that appear in
+// the same tick as their parent are adopted regardless of order until endTick().
+class ProcessTree {
+public:
+    struct Totals {
+        double cpu = 0.0;
+        uint64_t ram = 0;
+        double io = 0.0;
+        uint32_t count = 0;
+    };
+
+    struct Subtree {
+        DWORD pid;
+        Totals totals;
+    };
+
+    void add(const ProcessInfo &info);
+    void update(const ProcessDelta &delta);
+    void remove(DWORD pid);
+    // Children still waiting for a parent after this become roots.
+    void endTick();
+
+    // Totals over pid and all of its descendants.
+    [[nodiscard]] std::optional<Totals> subtree(DWORD pid) const;
+    // 0 when pid is a root or unknown.
+    [[nodiscard]] DWORD parentOf(DWORD pid) const;
+    [[nodiscard]] std::vector<Subtree> children(DWORD pid) const;
+    [[nodiscard]] std::vector<Subtree> roots() const;
+    [[nodiscard]] size_t size() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        DWORD parent = 0;  // 0: root
+        DWORD reportedParent = 0;
+        uint64_t createTime = 0;  // 0: unknown
+        std::vector<DWORD> children;
+        Totals self;
+        Totals subtree;
+    };
+
+    static Totals totalsOf(const ProcessInfo &info);
+    void propagate(DWORD from, const Totals &delta, int sign);
+    bool isAncestor(DWORD candidate, DWORD pid) const;
+    void link(DWORD pid, DWORD parent);
+    void unlink(DWORD pid);
+
+    std::unordered_map<DWORD, Node> nodes_;
+    std::unordered_map<DWORD, std::vector<DWORD>> waiting_;  // reported parent -> children added this tick
+};
+
+#endif
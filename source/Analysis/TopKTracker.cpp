@@ -0,0 +1,68 @@
+#include "TopKTracker.h"
+
+TopKTracker::Values TopKTracker::valuesOf(const ProcessInfo &info) {
+    return {info.cpuUsage, static_cast<double>(info.ramUsage), info.ioRate};
+}
+
+void TopKTracker::add(const ProcessInfo &info) {
+    remove(info.pid);
+    const Values values = valuesOf(info);
+    for (size_t m = 0; m < MetricHistory::MetricCount; ++m) {
+        rankings_[m].insert(Entry{values[m], info.pid});
+    }
+    values_.emplace(info.pid, values);
+}
+
+// Re-keys the existing node instead of freeing and allocating a new one.
+void TopKTracker::rekey(const size_t metric, const DWORD pid, double &current, const double value) {
+    if (value == current) {
+        return;
+    }
+    auto node = rankings_[metric].extract(Entry{current, pid});
+    current = value;
+    if (node.empty()) {
+        rankings_[metric].insert(Entry{value, pid});
+        return;
+    }
+    node.value().value = value;
+    rankings_[metric].insert(std::move(node));
+}
+
+void TopKTracker::update(const ProcessDelta &delta) {
+    const auto it = values_.find(delta.pid);
+    if (it == values_.end()) {
+        return;
+    }
+    Values &values = it->second;
+    if (delta.changed & ProcessDelta::Cpu) {
+        rekey(static_cast<size_t>(MetricHistory::Metric::Cpu), delta.pid, values[0], delta.cpuUsage);
+    }
+    if (delta.changed & ProcessDelta::Ram) {
+        rekey(static_cast<size_t>(MetricHistory::Metric::Ram), delta.pid, values[1],
+              static_cast<double>(delta.ramUsage));
+    }
+    if (delta.changed & ProcessDelta::Io) {
+        rekey(static_cast<size_t>(MetricHistory::Metric::Io), delta.pid, values[2], delta.ioRate);
+    }
+}
+
+void TopKTracker::remove(const DWORD pid) {
+    const auto it = values_.find(pid);
+    if (it == values_.end()) {
+        return;
+    }
+    for (size_t m = 0; m < MetricHistory::MetricCount; ++m) {
+        rankings_[m].erase(Entry{it->second[m], pid});
+    }
+    values_.erase(it);
+}
+
+std::vector<TopKTracker::Entry> TopKTracker::topK(const MetricHistory::Metric metric, const size_t k) const {
+    const auto &ranking = rankings_[static_cast<size_t>(metric)];
+    std::vector<Entry> out;
+    out.reserve(std::min(k, ranking.size()));
+    for (auto it = ranking.begin(); it != ranking.end() && out.size() < k; ++it) {
+        out.push_back(*it);
+    }
+    return out;
+}
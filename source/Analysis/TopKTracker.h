@@ -0,0 +1,49 @@
+#ifndef TopKTracker_h
+#define TopKTracker_h
+
+#include <windows.h>
+#include <array>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+#include "History/MetricHistory.h"
+
+// Incrementally maintained ranking of processes per metric.
+//
+// One ordered tree per metric (value descending, PID ascending for ties) is kept
+// in sync from the tick's added/updated/removed sets only. An update moves the
+// existing tree node with extract/insert, so steady-state updates do not
+// allocate. Top-K for any K walks the first K nodes: O(K), no sort.
+class TopKTracker {
+public:
+    struct Entry {
+        double value;
+        DWORD pid;
+    };
+
+    void add(const ProcessInfo &info);
+    void update(const ProcessDelta &delta);
+    void remove(DWORD pid);
+
+    [[nodiscard]] std::vector<Entry> topK(MetricHistory::Metric metric, size_t k) const;
+    [[nodiscard]] size_t size() const { return values_.size(); }
+
+private:
+    struct Greater {
+        bool operator()(const Entry &a, const Entry &b) const {
+            return a.value != b.value ? a.value > b.value : a.pid < b.pid;
+        }
+    };
+
+    using Values = std::array<double, MetricHistory::MetricCount>;
+
+    static Values valuesOf(const ProcessInfo &info);
+    void rekey(size_t metric, DWORD pid, double &current, double value);
+
+    std::array<std::set<Entry, Greater>, MetricHistory::MetricCount> rankings_;
+    std::unordered_map<DWORD, Values> values_;
+};
+
+#endif
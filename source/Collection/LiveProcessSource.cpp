@@ -0,0 +1,259 @@
+#include "LiveProcessSource.h"
+#include <algorithm>
+#include <cwchar>
+
+#include "HandleWrapper.h"
+
+LiveProcessSource::LiveProcessSource(const Options &options) : options_(options) {
+    if (options_.creationEvents) {
+        lifecycle_.startCreationEvents();
+    }
+}
+
+bool LiveProcessSource::collect(CollectedProcesses &out, const std::stop_token &st) {
+    applyEvents();
+
+    // Machine counters first, so they cover the same interval as the processes.
+    system_.sample();
+    if (!table_.refresh()) {
+        return false;
+    }
+
+    // Creation events can still be lost (buffer overruns, someone stopping the
+    // session), so reconciling against the full table keeps running now and
+    // then regardless.
+    if (scans_ == 0 || !lifecycle_.creationEventsActive() || ++ticks_since_scan_ >= options_.rescanEvery) {
+        if (!rescan(st)) {
+            return false;
+        }
+        ticks_since_scan_ = 0;
+    }
+
+    // Rates run on the monotonic clock; a stepped wall clock would spike them.
+    const uint64_t wall = table_.elapsedAt();
+    const uint64_t sample = ++samples_;
+    const auto now = std::chrono::steady_clock::now();
+    cpu_column_.clear();
+    io_column_.clear();
+    wall_deltas_.clear();
+    rows_.clear();
+    row_members_.clear();
+
+    for (const ProcessTableReader::Record record: table_) {
+        if (st.stop_requested()) {
+            return false;
+        }
+        auto it = members_.find(record.pid());
+        if (it == members_.end()) {
+            continue;
+        }
+        if (it->second.createTime != 0 && it->second.createTime != record.createTime()) {
+            // The PID changed hands and the old process's exit never reached
+            // us: the old one is gone, and the table has the new one.
+            const DWORD pid = it->first;
+            dropMember(it);
+            addMember(pid, record.parentPid(), std::wstring(record.imageName()), std::wstring());
+            it = members_.find(pid);
+        }
+        Member &member = it->second;
+        if (member.createTime == 0) {
+            member.createTime = record.createTime();  // started from an event, or just added
+        }
+        member.lastSample = sample;
+
+        ProcessInfo &currentInfo = out.try_emplace(it->first, it->first).first->second;
+        currentInfo.parentPid = member.parentPid;
+        currentInfo.createTime = member.createTime;
+        currentInfo.name = member.name;
+        currentInfo.path = member.path;
+        currentInfo.commandLine = member.commandLine;
+        currentInfo.lastUpdateTime = now;
+        currentInfo.ramUsage = record.workingSet();
+        member.published = true;
+
+        // A zero wall delta marks a first reading; the kernels turn it into 0.
+        wall_deltas_.push_back(member.lastWall != 0 ? wall - member.lastWall : 0);
+        cpu_column_.push(member.cpuTime, record.cpuTime());
+        io_column_.push(member.ioBytes, record.ioBytes());
+        rows_.push_back(&currentInfo);
+        row_members_.push_back(&member);
+        member.cpuTime = record.cpuTime();
+        member.ioBytes = record.ioBytes();
+        member.lastWall = wall;
+    }
+
+    // Same scales as ProcessMetrics: % of the whole machine, and bytes per
+    // second from 100-ns wall time.
+    cpu_column_.compute(wall_deltas_, 100.0 / ProcessMetrics::NumProcessors());
+    io_column_.compute(wall_deltas_, 10'000'000.0);
+    for (size_t i = 0; i < rows_.size(); ++i) {
+        rows_[i]->cpuUsage = cpu_column_.rates[i];
+        rows_[i]->ioRate = io_column_.rates[i];
+        row_members_[i]->cpuUsage = rows_[i]->cpuUsage;
+        row_members_[i]->ramUsage = rows_[i]->ramUsage;
+        row_members_[i]->ioRate = rows_[i]->ioRate;
+    }
+
+    // Members the table did not show: started after it was taken, or exited
+    // with the exit still on its way. They keep the metrics last published for
+    // them (none yet for a new one) rather than dropping to zero.
+    for (auto &[pid, member]: members_) {
+        if (member.lastSample == sample) {
+            continue;
+        }
+        ProcessInfo &currentInfo = out.try_emplace(pid, pid).first->second;
+        currentInfo.parentPid = member.parentPid;
+        currentInfo.createTime = member.createTime;
+        currentInfo.name = member.name;
+        currentInfo.path = member.path;
+        currentInfo.commandLine = member.commandLine;
+        currentInfo.lastUpdateTime = now;
+        currentInfo.cpuUsage = member.cpuUsage;
+        currentInfo.ramUsage = member.ramUsage;
+        currentInfo.ioRate = member.ioRate;
+        member.published = true;
+    }
+
+    threads_.sample(table_);
+    // The table already reflects every start and exit seen so far.
+    pending_.started.clear();
+    pending_.exited.clear();
+    return true;
+}
+
+void LiveProcessSource::onProcessRemoved(const DWORD pid) {
+    threads_.onProcessRemoved(pid);
+    memory_.forget(pid);
+    if (const auto it = members_.find(pid); it != members_.end()) {
+        // Still a member: the monitor saw the PID change hands. Start its rates over.
+        it->second.lastWall = 0;
+    }
+}
+
+void LiveProcessSource::setLifecycleNotify(std::function<void()> notify) {
+    lifecycle_.setNotify(std::move(notify));
+}
+
+void LiveProcessSource::drainLifecycle(LifecycleChanges &out) {
+    applyEvents();
+    for (const ProcessInfo &info: pending_.started) {
+        members_.at(info.pid).published = true;
+    }
+    std::swap(out.started, pending_.started);
+    std::swap(out.exited, pending_.exited);
+    std::swap(out.transient, pending_.transient);
+}
+
+bool LiveProcessSource::rescan(const std::stop_token &st) {
+    const uint64_t scan = ++scans_;
+    for (const ProcessTableReader::Record record: table_) {
+        if (st.stop_requested()) {
+            return false;
+        }
+        const DWORD pid = record.pid();
+        if (pid == 0) {
+            continue;
+        }
+
+        auto it = members_.find(pid);
+        if (it != members_.end() && it->second.createTime != 0 && it->second.createTime != record.createTime()) {
+            // The PID was reused and the old process's exit never reached us.
+            dropMember(it);
+            it = members_.end();
+        }
+        Member &member = it != members_.end()
+                             ? it->second
+                             : addMember(pid, record.parentPid(), std::wstring(record.imageName()), std::wstring());
+        member.createTime = record.createTime();
+        member.lastScan = scan;
+    }
+
+    for (auto it = members_.begin(); it != members_.end();) {
+        const auto next = std::next(it);
+        if (it->second.lastScan != scan) {
+            dropMember(it);
+        }
+        it = next;
+    }
+    return true;
+}
+
+void LiveProcessSource::applyEvents() {
+    events_.clear();
+    lifecycle_.drain(events_);
+
+    for (LifecycleEvent &event: events_) {
+        auto it = members_.find(event.pid);
+        if (event.kind == LifecycleEvent::Kind::Exited) {
+            if (it != members_.end()) {
+                dropMember(it);
+            }
+            continue;
+        }
+
+        const std::wstring_view image = event.imagePath;
+        std::wstring name(image.substr(image.find_last_of(L'\\') + 1));
+        if (it != members_.end()) {
+            // ETW delivers up to a second late, so a rescan often got there first.
+            if (_wcsicmp(it->second.name.c_str(), name.c_str()) == 0) {
+                continue;
+            }
+            dropMember(it);
+        }
+        const Member &member = addMember(event.pid, event.parentPid, std::move(name), std::move(event.imagePath));
+        // The member's own creation time waits for the table, which it is checked against.
+        ProcessInfo info = describe(event.pid, member);
+        info.createTime = event.createTime;
+        pending_.started.push_back(std::move(info));
+    }
+}
+
+// `reportedPath` stands in when the process cannot be opened (protected, or
+// already gone by the time a start event is read).
+LiveProcessSource::Member &LiveProcessSource::addMember(const DWORD pid, const DWORD parentPid, std::wstring name,
+                                                        std::wstring reportedPath) {
+    Member &member = members_[pid];
+    member.parentPid = parentPid;
+    member.name = std::move(name);
+    member.path = std::move(reportedPath);
+    member.lastScan = scans_;
+
+    HandleWrapper hProcess(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid));
+    if (hProcess.isValid()) {
+        wchar_t path[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameW(hProcess, 0, path, &size)) {
+            member.path.assign(path, size);
+        }
+    }
+    member.commandLine = ProcessMetrics::GetProcessCommandLine(pid).value_or(std::wstring());
+
+    if (options_.watchExits) {
+        lifecycle_.watchExit(pid);
+    }
+    return member;
+}
+
+void LiveProcessSource::dropMember(const std::unordered_map<DWORD, Member>::iterator it) {
+    const DWORD pid = it->first;
+    lifecycle_.forget(pid);
+
+    if (it->second.published) {
+        pending_.exited.push_back(pid);
+    } else {
+        // Started and exited between two looks at the table: the monitor never saw it.
+        std::erase_if(pending_.started, [pid](const ProcessInfo &info) { return info.pid == pid; });
+        pending_.transient.push_back(describe(pid, it->second));
+    }
+    members_.erase(it);
+}
+
+ProcessInfo LiveProcessSource::describe(const DWORD pid, const Member &member) {
+    ProcessInfo info(pid);
+    info.parentPid = member.parentPid;
+    info.createTime = member.createTime;
+    info.name = member.name;
+    info.path = member.path;
+    info.commandLine = member.commandLine;
+    return info;
+}
@@ -0,0 +1,94 @@
+#ifndef LiveProcessSource_h
+#define LiveProcessSource_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MemoryProbe.h"
+#include "ProcessLifecycleWatcher.h"
+#include "ProcessMetrics.h"
+#include "ProcessSource.h"
+#include "ProcessTableReader.h"
+#include "RateKernels.h"
+#include "SystemSampler.h"
+#include "ThreadSampler.h"
+
+// Samples the running system from one ProcessTableReader pass per tick: CPU
+// time, I/O transfer counts and working set for every process come out of the
+// same kernel buffer, with no per-process calls. The counters are gathered into
+// columns and turned into rates in one batch (see RateKernels). Rates need a previous sample,
+// so a process reports 0% CPU and 0 B/s on the tick it first shows up.
+//
+// Membership is kept event-driven where the system allows it: exits arrive
+// through ProcessLifecycleWatcher's per-process waits and, with creation events
+// running, starts arrive from ETW. A tick then only samples the known members,
+// and reconciling membership against the table drops to a consistency check
+// every Options::rescanEvery ticks. Without creation events every tick
+// rescans, as that is the only way to find new processes. Creation times tell
+// a reused PID from the process that held it before.
+class LiveProcessSource final : public ProcessSource {
+public:
+    struct Options {
+        bool watchExits = true;
+        bool creationEvents = true;  // silently unavailable when not elevated
+        uint32_t rescanEvery = 30;   // ticks, while creation events are live
+    };
+
+    LiveProcessSource() : LiveProcessSource(Options{}) {}
+    explicit LiveProcessSource(const Options &options);
+
+    bool collect(CollectedProcesses &out, const std::stop_token &st) override;
+    void onProcessRemoved(DWORD pid) override;
+    void setLifecycleNotify(std::function<void()> notify) override;
+    void drainLifecycle(LifecycleChanges &out) override;
+    ThreadSampler *threadSampler() override { return &threads_; }
+    MemoryProbe *memoryProbe() override { return &memory_; }
+    SystemSampler *systemSampler() override { return &system_; }
+
+private:
+    // Identity is read once per PID; none of it can change after creation.
+    struct Member {
+        DWORD parentPid = 0;
+        std::wstring name;
+        std::wstring path;
+        std::wstring commandLine;
+        uint64_t createTime = 0;  // from the table; 0 until it first lists the process
+        uint64_t lastScan = 0;
+        uint64_t lastSample = 0;
+        uint64_t cpuTime = 0;     // kernel + user at lastWall, 100-ns
+        uint64_t ioBytes = 0;     // read + write transfer count at lastWall
+        uint64_t lastWall = 0;    // ProcessTableReader::elapsedAt(); 0: no previous reading
+        double cpuUsage = 0.0;    // as last sampled, for ticks the table misses it
+        SIZE_T ramUsage = 0;
+        double ioRate = 0.0;
+        bool published = false;   // handed to the monitor in a table or as started
+    };
+
+    bool rescan(const std::stop_token &st);
+    void applyEvents();
+    Member &addMember(DWORD pid, DWORD parentPid, std::wstring name, std::wstring reportedPath);
+    void dropMember(std::unordered_map<DWORD, Member>::iterator it);
+    static ProcessInfo describe(DWORD pid, const Member &member);
+
+    Options options_;
+    ProcessTableReader table_;
+    // Counters gathered per tick for the batch rate kernels, row i feeding rows_[i].
+    rates::Column cpu_column_;
+    rates::Column io_column_;
+    std::vector<uint64_t> wall_deltas_;
+    std::vector<ProcessInfo *> rows_;
+    std::vector<Member *> row_members_;
+    ThreadSampler threads_;
+    MemoryProbe memory_;
+    SystemSampler system_;
+    ProcessLifecycleWatcher lifecycle_;
+    std::unordered_map<DWORD, Member> members_;
+    std::vector<LifecycleEvent> events_;
+    LifecycleChanges pending_;
+    uint64_t scans_ = 0;
+    uint64_t samples_ = 0;
+    uint32_t ticks_since_scan_ = 0;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "MemoryProbe.h"
+#include <psapi.h>
+#include <algorithm>
+
+#include "HandleWrapper.h"
+
+std::optional<MemoryBreakdown> MemoryProbe::get(const DWORD pid) {
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock lk(mtx_);
+        auto [it, inserted] = cache_.try_emplace(pid);
+        Entry &entry = it->second;
+        if (entry.value && now - entry.value->sampledAt < options_.ttl) {
+            return entry.value;
+        }
+        if (!inserted && now - entry.lastAttempt < options_.minInterval) {
+            return entry.value;
+        }
+        entry.lastAttempt = now;
+    }
+
+    std::optional<MemoryBreakdown> result;
+    {
+        std::scoped_lock lk(read_mtx_);
+        result = read(pid);
+    }
+
+    std::scoped_lock lk(mtx_);
+    const auto it = cache_.find(pid);
+    if (it == cache_.end()) {
+        return result;  // forgotten while we were reading
+    }
+    if (result) {
+        it->second.value = result;
+    }
+    return it->second.value;
+}
+
+void MemoryProbe::forget(const DWORD pid) {
+    std::scoped_lock lk(mtx_);
+    cache_.erase(pid);
+}
+
+std::optional<MemoryBreakdown> MemoryProbe::read(const DWORD pid) {
+    static const SIZE_T pageSize = [] {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return static_cast<SIZE_T>(si.dwPageSize);
+    }();
+
+    HandleWrapper hProcess(OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid));
+    if (!hProcess.isValid()) {
+        return std::nullopt;
+    }
+
+    PROCESS_MEMORY_COUNTERS_EX pmc;
+    if (!GetProcessMemoryInfo(hProcess, reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc))) {
+        return std::nullopt;
+    }
+
+    // Size for the current working set plus headroom; it can still grow
+    // between calls, in which case the call reports the new entry count.
+    size_t entries = pmc.WorkingSetSize / pageSize;
+    bool ok = false;
+    for (int attempt = 0; attempt < 4 && !ok; ++attempt) {
+        entries += entries / 8 + 256;
+        if (buffer_.size() < entries + 1) {
+            buffer_.resize(entries + 1);
+        }
+        ok = QueryWorkingSet(hProcess, buffer_.data(), static_cast<DWORD>(buffer_.size() * sizeof(ULONG_PTR)));
+        if (!ok && GetLastError() != ERROR_BAD_LENGTH) {
+            return std::nullopt;
+        }
+        entries = std::max<size_t>(entries, reinterpret_cast<const PSAPI_WORKING_SET_INFORMATION *>(buffer_.data())
+                                   ->NumberOfEntries);
+    }
+    if (!ok) {
+        return std::nullopt;
+    }
+
+    // Shares are summed in 1/420ths of a page (420 = lcm(1..7)) so splitting
+    // stays exact.
+    constexpr uint64_t Whole = 420;
+    const auto *info = reinterpret_cast<const PSAPI_WORKING_SET_INFORMATION *>(buffer_.data());
+    uint64_t uniquePages = 0;
+    uint64_t sharedPages = 0;
+    uint64_t privatePages = 0;
+    uint64_t proportionalShares = 0;
+    for (ULONG_PTR i = 0; i < info->NumberOfEntries; ++i) {
+        const PSAPI_WORKING_SET_BLOCK &block = info->WorkingSetInfo[i];
+        if (!block.Shared) {
+            ++privatePages;
+        }
+        if (!block.Shared || block.ShareCount <= 1) {
+            ++uniquePages;
+            proportionalShares += Whole;
+        } else {
+            ++sharedPages;
+            proportionalShares += Whole / block.ShareCount;
+        }
+    }
+
+    MemoryBreakdown breakdown;
+    breakdown.workingSet = pmc.WorkingSetSize;
+    breakdown.uniqueBytes = uniquePages * pageSize;
+    breakdown.sharedBytes = sharedPages * pageSize;
+    breakdown.proportionalBytes = proportionalShares * pageSize / Whole;
+    breakdown.privateCommit = pmc.PrivateUsage;
+    const SIZE_T privateResident = privatePages * pageSize;
+    breakdown.privateNotResident = pmc.PrivateUsage > privateResident ? pmc.PrivateUsage - privateResident : 0;
+    breakdown.sampledAt = std::chrono::steady_clock::now();
+    return breakdown;
+}
@@ -0,0 +1,63 @@
+#ifndef MemoryProbe_h
+#define MemoryProbe_h
+
+#include <windows.h>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+struct MemoryBreakdown {
+    SIZE_T workingSet = 0;         // resident bytes, what ProcessInfo::ramUsage shows
+    SIZE_T uniqueBytes = 0;        // resident pages mapped by this process only (USS)
+    SIZE_T proportionalBytes = 0;  // unique + each shared page split over its sharers (PSS)
+    SIZE_T sharedBytes = 0;        // resident pages other processes map too
+    SIZE_T privateCommit = 0;      // committed private memory, resident or not
+    SIZE_T privateNotResident = 0; // private commit outside the working set: paged out or never touched
+    std::chrono::steady_clock::time_point sampledAt;
+};
+
+// Detailed memory attribution for a handful of processes at a time.
+//
+// Walks the process's working set with QueryWorkingSet and splits every page by
+// its share count, which is what attributes RAM fairly across many workers
+// mapping the same images. The walk touches one entry per resident page, so it
+// is far too expensive to run for every process every tick: results are cached
+// for Options::ttl, and a process is not read again within
+// Options::minInterval even when its last read failed. The kernel saturates
+// share counts at 7, so proportionalBytes overstates pages shared more widely
+// than that (system DLLs mostly).
+class MemoryProbe {
+public:
+    struct Options {
+        std::chrono::milliseconds ttl{5000};
+        std::chrono::milliseconds minInterval{2000};
+    };
+
+    MemoryProbe() : MemoryProbe(Options{}) {}
+    explicit MemoryProbe(const Options &options) : options_(options) {}
+
+    // Cached breakdown if fresh, otherwise a new read when the rate limit
+    // allows it, otherwise the last known (possibly stale) one.
+    std::optional<MemoryBreakdown> get(DWORD pid);
+
+    void forget(DWORD pid);
+
+private:
+    struct Entry {
+        std::optional<MemoryBreakdown> value;
+        std::chrono::steady_clock::time_point lastAttempt;
+    };
+
+    std::optional<MemoryBreakdown> read(DWORD pid);
+
+    Options options_;
+    std::mutex mtx_;
+    std::unordered_map<DWORD, Entry> cache_;
+
+    std::mutex read_mtx_;               // one walk at a time, sharing the buffer
+    std::vector<ULONG_PTR> buffer_;     // PSAPI_WORKING_SET_INFORMATION
+};
+
+#endif
@@ -0,0 +1,335 @@
+#include "ProcessLifecycleWatcher.h"
+#include <evntcons.h>
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <iostream>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+namespace {
+    // Microsoft-Windows-Kernel-Process
+    constexpr GUID KernelProcessProvider = {
+        0x22fb2cd6, 0x0e7b, 0x422b, {0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16}
+    };
+    constexpr ULONGLONG KeywordProcess = 0x10;  // WINEVENT_KEYWORD_PROCESS
+    constexpr USHORT ProcessStartId = 1;
+    constexpr USHORT ProcessStopId = 2;
+    // Followed by the owner's PID and creation time: "<prefix>1234-133...".
+    constexpr std::wstring_view SessionPrefix = L"ProcessLite Process Lifecycle ";
+    constexpr ULONG MaxSessions = 64;  // the system-wide limit on trace sessions
+    constexpr size_t MaxSessionNameChars = 1024;
+
+    // Set while this thread runs an exit callback.
+    thread_local bool inExitCallback = false;
+
+    uint64_t creationTimeOf(const HANDLE process) {
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+            return 0;
+        }
+        return static_cast<uint64_t>(created.dwHighDateTime) << 32 | created.dwLowDateTime;
+    }
+
+    // Whether the instance that named a session "<prefix><pid>-<created>" is
+    // still running. Anything unreadable counts as running, so another
+    // instance's session is never stopped by mistake.
+    bool sessionOwnerRunning(const std::wstring_view name) {
+        const std::wstring owner(name.substr(SessionPrefix.size()));
+        wchar_t *end = nullptr;
+        const auto pid = static_cast<DWORD>(std::wcstoul(owner.c_str(), &end, 10));
+        if (*end != L'-') {
+            return true;
+        }
+        const uint64_t created = std::wcstoull(end + 1, &end, 10);
+        if (*end != L'\0') {
+            return true;
+        }
+        const HandleWrapper process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid));
+        if (!process.isValid()) {
+            return GetLastError() != ERROR_INVALID_PARAMETER;  // no such process
+        }
+        const uint64_t running = creationTimeOf(process);
+        return running == 0 || running == created;
+    }
+
+    // Zeroed properties block with the session name appended, as StartTrace and
+    // ControlTrace both expect.
+    EVENT_TRACE_PROPERTIES *prepareProperties(std::vector<std::byte> &buffer, const std::wstring_view name) {
+        buffer.assign(sizeof(EVENT_TRACE_PROPERTIES) + (name.size() + 1) * sizeof(wchar_t), std::byte{0});
+        auto *properties = reinterpret_cast<EVENT_TRACE_PROPERTIES *>(buffer.data());
+        properties->Wnode.BufferSize = static_cast<ULONG>(buffer.size());
+        properties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+        properties->Wnode.ClientContext = 1;  // QPC timestamps
+        properties->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+        properties->FlushTimer = 1;  // seconds; without it a quiet session holds events until a buffer fills
+        properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+        return properties;
+    }
+}
+
+ProcessLifecycleWatcher::~ProcessLifecycleWatcher() {
+    setNotify(nullptr);
+    stopCreationEvents();
+
+    // Every callback, including ones whose event was already drained, must
+    // have returned before the watcher goes away.
+    std::unordered_map<DWORD, std::unique_ptr<ExitWait>> waits;
+    std::vector<std::unique_ptr<ExitWait>> retired;
+    {
+        std::scoped_lock lk(mtx_);
+        waits.swap(waits_);
+        retired.swap(retired_);
+    }
+    for (auto &exitWait: waits | std::views::values) {
+        release(std::move(exitWait));
+    }
+    for (auto &exitWait: retired) {
+        release(std::move(exitWait));
+    }
+}
+
+void ProcessLifecycleWatcher::setNotify(std::function<void()> notify) {
+    std::unique_lock lk(notify_mtx_);
+    notify_ = std::move(notify);
+}
+
+bool ProcessLifecycleWatcher::startCreationEvents() {
+    if (creation_events_.load()) {
+        return true;
+    }
+
+    if (session_name_.empty()) {
+        session_name_ = std::wstring(SessionPrefix) + std::to_wstring(GetCurrentProcessId()) + L"-" +
+                        std::to_wstring(creationTimeOf(GetCurrentProcess()));
+    }
+    stopOrphanedSessions();
+
+    EVENT_TRACE_PROPERTIES *properties = prepareProperties(session_properties_, session_name_);
+    ULONG status = StartTraceW(&session_, session_name_.c_str(), properties);
+    if (status == ERROR_ALREADY_EXISTS) {
+        // Our own, from an earlier start whose stop did not go through.
+        ControlTraceW(0, session_name_.c_str(), properties, EVENT_TRACE_CONTROL_STOP);
+        properties = prepareProperties(session_properties_, session_name_);
+        status = StartTraceW(&session_, session_name_.c_str(), properties);
+    }
+    if (status != ERROR_SUCCESS) {
+        session_ = 0;
+        if (status != ERROR_ACCESS_DENIED) {
+            std::cerr << "ProcessLifecycleWatcher: StartTrace failed. Error: " << status << std::endl;
+        }
+        return false;
+    }
+
+    status = EnableTraceEx2(session_, &KernelProcessProvider, EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+                            TRACE_LEVEL_INFORMATION, KeywordProcess, 0, 0, nullptr);
+    if (status != ERROR_SUCCESS) {
+        std::cerr << "ProcessLifecycleWatcher: EnableTraceEx2 failed. Error: " << status << std::endl;
+        stopCreationEvents();
+        return false;
+    }
+
+    EVENT_TRACE_LOGFILEW logFile{};
+    logFile.LoggerName = session_name_.data();
+    logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+    logFile.EventRecordCallback = &ProcessLifecycleWatcher::onEventRecord;
+    logFile.Context = this;
+    trace_ = OpenTraceW(&logFile);
+    if (trace_ == INVALID_PROCESSTRACE_HANDLE) {
+        std::cerr << "ProcessLifecycleWatcher: OpenTrace failed. Error: " << GetLastError() << std::endl;
+        stopCreationEvents();
+        return false;
+    }
+
+    creation_events_.store(true);
+    // ProcessTrace blocks, delivering events, until the trace is closed.
+    trace_thread_ = std::jthread([this, trace = trace_]() mutable {
+        ProcessTrace(&trace, 1, nullptr, nullptr);
+        creation_events_.store(false);
+    });
+    return true;
+}
+
+void ProcessLifecycleWatcher::stopCreationEvents() {
+    if (session_ != 0) {
+        ControlTraceW(session_, nullptr, prepareProperties(session_properties_, session_name_),
+                      EVENT_TRACE_CONTROL_STOP);
+        session_ = 0;
+    }
+    if (trace_ != INVALID_PROCESSTRACE_HANDLE) {
+        CloseTrace(trace_);
+        trace_ = INVALID_PROCESSTRACE_HANDLE;
+    }
+    if (trace_thread_.joinable()) {
+        trace_thread_.join();
+    }
+    creation_events_.store(false);
+}
+
+// Sessions outlive the process that started them, so one from an instance
+// that crashed keeps running (and counting against the system's 64) until
+// someone stops it.
+void ProcessLifecycleWatcher::stopOrphanedSessions() {
+    constexpr size_t PropertiesBytes = sizeof(EVENT_TRACE_PROPERTIES) + 2 * MaxSessionNameChars * sizeof(wchar_t);
+    std::vector<std::byte> storage(MaxSessions * PropertiesBytes, std::byte{0});
+    std::vector<EVENT_TRACE_PROPERTIES *> sessions(MaxSessions);
+    for (ULONG i = 0; i < MaxSessions; ++i) {
+        auto *properties = reinterpret_cast<EVENT_TRACE_PROPERTIES *>(storage.data() + i * PropertiesBytes);
+        properties->Wnode.BufferSize = static_cast<ULONG>(PropertiesBytes);
+        properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+        properties->LogFileNameOffset = sizeof(EVENT_TRACE_PROPERTIES) + MaxSessionNameChars * sizeof(wchar_t);
+        sessions[i] = properties;
+    }
+    ULONG count = 0;
+    if (QueryAllTracesW(sessions.data(), MaxSessions, &count) != ERROR_SUCCESS) {
+        return;
+    }
+
+    std::vector<std::byte> buffer;
+    for (ULONG i = 0; i < count; ++i) {
+        const std::wstring_view name(reinterpret_cast<const wchar_t *>(
+            reinterpret_cast<const std::byte *>(sessions[i]) + sessions[i]->LoggerNameOffset));
+        if (!name.starts_with(SessionPrefix) || sessionOwnerRunning(name)) {
+            continue;
+        }
+        const std::wstring stale(name);
+        ControlTraceW(0, stale.c_str(), prepareProperties(buffer, stale), EVENT_TRACE_CONTROL_STOP);
+    }
+}
+
+bool ProcessLifecycleWatcher::watchExit(const DWORD pid) {
+    HandleWrapper process(OpenProcess(SYNCHRONIZE, FALSE, pid));
+    if (!process.isValid()) {
+        return false;
+    }
+
+    std::unique_ptr<ExitWait> exitWait(new ExitWait{this, pid, std::move(process)});
+    exitWait->wait = CreateThreadpoolWait(&ProcessLifecycleWatcher::onExit, exitWait.get(), nullptr);
+    if (!exitWait->wait) {
+        return false;
+    }
+
+    std::vector<std::unique_ptr<ExitWait>> previous;
+    {
+        std::scoped_lock lk(mtx_);
+        std::unique_ptr<ExitWait> &slot = waits_[pid];
+        if (slot) {
+            previous.push_back(std::move(slot));
+        }
+        slot = std::move(exitWait);
+        SetThreadpoolWait(slot->wait, slot->process, nullptr);
+    }
+    dispose(std::move(previous));
+    return true;
+}
+
+void ProcessLifecycleWatcher::forget(const DWORD pid) {
+    std::vector<std::unique_ptr<ExitWait>> forgotten;
+    {
+        std::scoped_lock lk(mtx_);
+        if (auto node = waits_.extract(pid)) {
+            forgotten.push_back(std::move(node.mapped()));
+        }
+    }
+    dispose(std::move(forgotten));
+}
+
+void ProcessLifecycleWatcher::drain(std::vector<LifecycleEvent> &out) {
+    std::vector<std::unique_ptr<ExitWait>> exited;
+    {
+        std::scoped_lock lk(mtx_);
+        for (LifecycleEvent &event: queue_) {
+            if (event.kind == LifecycleEvent::Kind::Exited) {
+                if (auto node = waits_.extract(event.pid)) {
+                    exited.push_back(std::move(node.mapped()));
+                }
+            }
+            out.push_back(std::move(event));
+        }
+        queue_.clear();
+    }
+    dispose(std::move(exited));
+}
+
+void ProcessLifecycleWatcher::dispose(std::vector<std::unique_ptr<ExitWait>> waits) {
+    {
+        std::scoped_lock lk(mtx_);
+        // One of these may be the callback this thread is running, and
+        // waiting for it would never return; leave them to the next call off
+        // a callback, or to the destructor.
+        if (inExitCallback) {
+            std::ranges::move(waits, std::back_inserter(retired_));
+            return;
+        }
+        std::ranges::move(retired_, std::back_inserter(waits));
+        retired_.clear();
+    }
+    for (auto &exitWait: waits) {
+        release(std::move(exitWait));
+    }
+}
+
+// Must not be called with mtx_ held, nor on the exit callback of exitWait
+// itself: it waits for that callback, which needs mtx_ to queue its event.
+void ProcessLifecycleWatcher::release(std::unique_ptr<ExitWait> exitWait) {
+    SetThreadpoolWait(exitWait->wait, nullptr, nullptr);
+    WaitForThreadpoolWaitCallbacks(exitWait->wait, TRUE);
+    CloseThreadpoolWait(exitWait->wait);
+}
+
+void ProcessLifecycleWatcher::push(LifecycleEvent event) {
+    {
+        std::scoped_lock lk(mtx_);
+        queue_.push_back(std::move(event));
+    }
+    std::shared_lock lk(notify_mtx_);
+    if (notify_) {
+        notify_();
+    }
+}
+
+void CALLBACK ProcessLifecycleWatcher::onExit(PTP_CALLBACK_INSTANCE, const PVOID context, PTP_WAIT, TP_WAIT_RESULT) {
+    // Every release() waits for this callback to return, and none runs on
+    // it (see dispose), so exitWait and its owner outlive it.
+    const auto *exitWait = static_cast<const ExitWait *>(context);
+    inExitCallback = true;
+    exitWait->owner->push(LifecycleEvent{LifecycleEvent::Kind::Exited, exitWait->pid});
+    inExitCallback = false;
+}
+
+// Both events start with ProcessID; ProcessStart continues with CreateTime,
+// ParentProcessID and SessionID, then (from version 1) Flags, then ImageName.
+void WINAPI ProcessLifecycleWatcher::onEventRecord(const PEVENT_RECORD record) {
+    if (!(record->EventHeader.ProviderId == KernelProcessProvider)) {
+        return;
+    }
+    const USHORT id = record->EventHeader.EventDescriptor.Id;
+    const auto *data = static_cast<const std::byte *>(record->UserData);
+    const size_t size = record->UserDataLength;
+    if ((id != ProcessStartId && id != ProcessStopId) || size < sizeof(DWORD)) {
+        return;
+    }
+
+    LifecycleEvent event;
+    event.kind = id == ProcessStartId ? LifecycleEvent::Kind::Started : LifecycleEvent::Kind::Exited;
+    std::memcpy(&event.pid, data, sizeof(DWORD));
+    if (event.kind == LifecycleEvent::Kind::Started) {
+        if (size >= 12) {
+            std::memcpy(&event.createTime, data + 4, sizeof(uint64_t));
+        }
+        if (size >= 16) {
+            std::memcpy(&event.parentPid, data + 12, sizeof(DWORD));
+        }
+        const size_t nameOffset = record->EventHeader.EventDescriptor.Version == 0 ? 20 : 24;
+        for (size_t offset = nameOffset; offset + sizeof(wchar_t) <= size; offset += sizeof(wchar_t)) {
+            wchar_t ch;
+            std::memcpy(&ch, data + offset, sizeof(ch));
+            if (ch == L'\0') {
+                break;
+            }
+            event.imagePath.push_back(ch);
+        }
+    }
+    static_cast<ProcessLifecycleWatcher *>(record->UserContext)->push(std::move(event));
+}
@@ -0,0 +1,103 @@
+#ifndef ProcessLifecycleWatcher_h
+#define ProcessLifecycleWatcher_h
+
+#include <windows.h>
+#include <evntrace.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "HandleWrapper.h"
+
+struct LifecycleEvent {
+    enum class Kind : uint8_t { Started, Exited };
+
+    Kind kind = Kind::Exited;
+    DWORD pid = 0;
+    DWORD parentPid = 0;     // Started only
+    uint64_t createTime = 0; // Started only; FILETIME
+    std::wstring imagePath;  // Started only; NT device path as the kernel reports it
+};
+
+// Learns about process exits and creations as they happen instead of at the
+// next Toolhelp rescan.
+//
+// Exits: every watched PID gets a threadpool wait on a SYNCHRONIZE handle, which
+// the pool multiplexes over a few threads however many processes there are, so a
+// one-shot callback fires the moment the process object is signaled. This needs
+// no privileges.
+//
+// Creations: a real-time ETW session on the Microsoft-Windows-Kernel-Process
+// provider delivers start and stop events for every process, including ones
+// that live for a few milliseconds. Starting a session needs elevation (or
+// Performance Log Users); without it startCreationEvents() fails and the caller
+// keeps finding new processes by rescanning. Each instance names its session
+// after its own PID and creation time, so two instances never share one and a
+// session left behind by a crashed instance can be recognized and stopped.
+//
+// Events are queued and handed out by drain(); the notify callback runs on the
+// threadpool or ETW thread after each one is queued.
+class ProcessLifecycleWatcher {
+public:
+    ProcessLifecycleWatcher() = default;
+    ~ProcessLifecycleWatcher();
+
+    ProcessLifecycleWatcher(const ProcessLifecycleWatcher&) = delete;
+    ProcessLifecycleWatcher& operator=(const ProcessLifecycleWatcher&) = delete;
+
+    // Returns once no callback is still running the previous notify.
+    void setNotify(std::function<void()> notify);
+
+    bool startCreationEvents();
+    void stopCreationEvents();
+    // False until started, and again if the session dies underneath us.
+    [[nodiscard]] bool creationEventsActive() const { return creation_events_.load(); }
+
+    // Queue an Exited event when pid exits. False if it cannot be opened.
+    bool watchExit(DWORD pid);
+    // Stop watching pid (it left the table some other way).
+    void forget(DWORD pid);
+
+    // Append queued events to out, oldest first. Waits whose Exited event is
+    // handed out are released here, or on a later call when this one runs on
+    // an exit callback (which cannot wait for itself).
+    void drain(std::vector<LifecycleEvent> &out);
+
+private:
+    struct ExitWait {
+        ProcessLifecycleWatcher *owner;
+        DWORD pid;
+        HandleWrapper process;
+        PTP_WAIT wait = nullptr;
+    };
+
+    static void CALLBACK onExit(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WAIT wait, TP_WAIT_RESULT result);
+    static void WINAPI onEventRecord(PEVENT_RECORD record);
+    void push(LifecycleEvent event);
+    void dispose(std::vector<std::unique_ptr<ExitWait>> waits);
+    static void release(std::unique_ptr<ExitWait> exitWait);
+    static void stopOrphanedSessions();
+
+    std::mutex mtx_;
+    std::vector<LifecycleEvent> queue_;
+    std::unordered_map<DWORD, std::unique_ptr<ExitWait>> waits_;
+    std::vector<std::unique_ptr<ExitWait>> retired_;  // given up on an exit callback, not yet released
+
+    std::shared_mutex notify_mtx_;
+    std::function<void()> notify_;
+
+    std::atomic<bool> creation_events_ = false;
+    std::wstring session_name_;
+    TRACEHANDLE session_ = 0;
+    TRACEHANDLE trace_ = INVALID_PROCESSTRACE_HANDLE;
+    std::vector<std::byte> session_properties_;
+    std::jthread trace_thread_;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef ProcessSource_h
+#define ProcessSource_h
+
+#include <windows.h>
+#include <functional>
+#include <memory_resource>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+
+class MemoryProbe;
+class SystemSampler;
+class ThreadSampler;
+
+// One tick's table. The monitor allocates it from its per-tick arena; sources
+// should build entries in place (try_emplace) so their strings land there too.
+using CollectedProcesses = std::pmr::unordered_map<DWORD, ProcessInfo>;
+
+// Where ProcessMonitor gets each tick's process table from. The monitor owns the
+// diff against the previous tick and everything downstream of it, so a source
+// only has to report what exists right now and what its metrics are.
+class ProcessSource {
+public:
+    // Membership changes a source learned of between ticks. `started` entries
+    // carry identity only (metrics arrive with the next collect); `transient`
+    // processes started and exited without ever appearing in a table.
+    struct LifecycleChanges {
+        std::vector<ProcessInfo> started;
+        std::vector<DWORD> exited;
+        std::vector<ProcessInfo> transient;
+    };
+
+    virtual ~ProcessSource() = default;
+
+    // Fill `out` (empty on entry) with the current table. Returning false skips
+    // the tick without touching the monitor's state.
+    virtual bool collect(CollectedProcesses &out, const std::stop_token &st) = 0;
+
+    // The monitor dropped pid from its table.
+    virtual void onProcessRemoved(DWORD pid) {}
+
+    // Sources that hear about starts and exits as they happen call `notify`
+    // (from any thread) when there is something for drainLifecycle. Passing an
+    // empty function detaches; it returns once no call is still in flight.
+    virtual void setLifecycleNotify(std::function<void()> notify) {}
+
+    // Move pending changes into `out`, which arrives empty. Never called
+    // concurrently with collect().
+    virtual void drainLifecycle(LifecycleChanges &out) {}
+
+    // Per-thread sampling, if the source can see threads (recordings cannot).
+    virtual ThreadSampler *threadSampler() { return nullptr; }
+
+    // Detailed memory breakdowns, if the source can open processes.
+    virtual MemoryProbe *memoryProbe() { return nullptr; }
+
+    // Machine-wide CPU and scheduler counters, sampled by collect(), if the
+    // source is looking at a live machine.
+    virtual SystemSampler *systemSampler() { return nullptr; }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "ProcessTableReader.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    constexpr ULONG SystemProcessInformation = 5;
+    constexpr LONG StatusInfoLengthMismatch = static_cast<LONG>(0xC0000004);
+    constexpr size_t InitialBufferSize = 512 * 1024;
+
+    using NtQuerySystemInformationPtr = LONG(WINAPI*)(ULONG, PVOID, ULONG, PULONG);
+}
+
+ProcessTableReader::Record ProcessTableReader::Iterator::operator*() const {
+    const auto *entry = reinterpret_cast<const SystemProcessEntry *>(at_);
+    const size_t left = static_cast<size_t>(end_ - at_);
+    return Record(entry, entry->NextEntryOffset != 0 ? std::min<size_t>(entry->NextEntryOffset, left) : left);
+}
+
+ProcessTableReader::Iterator &ProcessTableReader::Iterator::operator++() {
+    const ULONG next = reinterpret_cast<const SystemProcessEntry *>(at_)->NextEntryOffset;
+    // A zero offset ends the table; an offset running past what was filled
+    // would mean a torn buffer, treated the same way.
+    if (next == 0 || next > static_cast<size_t>(end_ - at_) ||
+        static_cast<size_t>(end_ - at_) - next < sizeof(SystemProcessEntry)) {
+        at_ = nullptr;
+    } else {
+        at_ += next;
+    }
+    return *this;
+}
+
+ProcessTableReader::Iterator ProcessTableReader::begin() const {
+    if (length_ < sizeof(SystemProcessEntry)) {
+        return {};
+    }
+    return {buffer_.data(), buffer_.data() + length_};
+}
+
+bool ProcessTableReader::refresh() {
+    static const auto query = [] {
+        HMODULE hMod = ::GetModuleHandleW(L"ntdll.dll");
+        return hMod ? reinterpret_cast<NtQuerySystemInformationPtr>(
+                          ::GetProcAddress(hMod, "NtQuerySystemInformation"))
+                    : nullptr;
+    }();
+
+    length_ = 0;
+    count_ = 0;
+    if (!query) {
+        return false;
+    }
+    if (buffer_.empty()) {
+        buffer_.resize(InitialBufferSize);
+    }
+
+    // The table can grow between the size probe and the next call, so leave
+    // headroom and retry a few times.
+    LONG status = StatusInfoLengthMismatch;
+    ULONG needed = 0;
+    for (int attempt = 0; attempt < 4 && status == StatusInfoLengthMismatch; ++attempt) {
+        status = query(SystemProcessInformation, buffer_.data(), static_cast<ULONG>(buffer_.size()), &needed);
+        if (status == StatusInfoLengthMismatch) {
+            buffer_.resize(std::max<size_t>(needed, buffer_.size()) + needed / 8 + 64 * 1024);
+        }
+    }
+    if (status < 0) {
+        std::cerr << "ProcessTableReader: NtQuerySystemInformation failed. Status: " << std::hex << status
+                << std::dec << std::endl;
+        return false;
+    }
+
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    sampled_at_ = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    ULONGLONG elapsed = 0;
+    QueryUnbiasedInterruptTime(&elapsed);
+    elapsed_at_ = elapsed;
+
+    length_ = needed ? std::min<size_t>(needed, buffer_.size()) : buffer_.size();
+    countEntries();
+    return true;
+}
+
+void ProcessTableReader::assign(std::vector<std::byte> buffer, const uint64_t sampledAt) {
+    buffer_ = std::move(buffer);
+    length_ = buffer_.size();
+    sampled_at_ = sampledAt;
+    elapsed_at_ = sampledAt;
+    count_ = 0;
+    countEntries();
+}
+
+void ProcessTableReader::countEntries() {
+    for (Iterator it = begin(); it != end(); ++it) {
+        ++count_;
+    }
+}
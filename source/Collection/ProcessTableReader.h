@@ -0,0 +1,176 @@
+#ifndef ProcessTableReader_h
+#define ProcessTableReader_h
+
+#include <windows.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// SYSTEM_PROCESS_INFORMATION as NtQuerySystemInformation lays it out, minus
+// the trailing thread array: NumberOfThreads SystemThreadEntry records follow
+// each entry directly.
+struct SystemProcessEntry {
+    ULONG NextEntryOffset;
+    ULONG NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG HardFaultCount;
+    ULONG NumberOfThreadsHighWatermark;
+    ULONGLONG CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER KernelTime;
+    struct {
+        USHORT Length;  // bytes
+        USHORT MaximumLength;
+        PWSTR Buffer;   // points into the same buffer
+    } ImageName;
+    LONG BasePriority;
+    HANDLE UniqueProcessId;
+    HANDLE InheritedFromUniqueProcessId;
+    ULONG HandleCount;
+    ULONG SessionId;
+    ULONG_PTR UniqueProcessKey;
+    SIZE_T PeakVirtualSize;
+    SIZE_T VirtualSize;
+    ULONG PageFaultCount;
+    SIZE_T PeakWorkingSetSize;
+    SIZE_T WorkingSetSize;
+    SIZE_T QuotaPeakPagedPoolUsage;
+    SIZE_T QuotaPagedPoolUsage;
+    SIZE_T QuotaPeakNonPagedPoolUsage;
+    SIZE_T QuotaNonPagedPoolUsage;
+    SIZE_T PagefileUsage;
+    SIZE_T PeakPagefileUsage;
+    SIZE_T PrivatePageCount;
+    LARGE_INTEGER ReadOperationCount;
+    LARGE_INTEGER WriteOperationCount;
+    LARGE_INTEGER OtherOperationCount;
+    LARGE_INTEGER ReadTransferCount;
+    LARGE_INTEGER WriteTransferCount;
+    LARGE_INTEGER OtherTransferCount;
+};
+
+// SYSTEM_THREAD_INFORMATION.
+struct SystemThreadEntry {
+    LARGE_INTEGER KernelTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER CreateTime;
+    ULONG WaitTime;
+    PVOID StartAddress;
+    struct {
+        HANDLE UniqueProcess;
+        HANDLE UniqueThread;
+    } ClientId;
+    LONG Priority;
+    LONG BasePriority;
+    ULONG ContextSwitches;
+    ULONG ThreadState;  // KTHREAD_STATE
+    ULONG WaitReason;   // KWAIT_REASON
+};
+
+// The whole process table in one system call, read in place.
+//
+// refresh() asks the kernel for SystemProcessInformation into a buffer that is
+// kept between calls, so after the first few ticks it neither allocates nor
+// copies: records are views over the kernel's entries, and image names are
+// string_views into the same buffer. That replaces the Toolhelp snapshot plus
+// the handful of per-process calls (times, I/O counters, memory counters) that
+// used to run for every PID on every tick.
+//
+// Records and names are valid until the next refresh(). Not synchronized; each
+// collecting thread owns its reader.
+class ProcessTableReader {
+public:
+    class Record {
+    public:
+        // `bytes`: how much of the buffer from `entry` on belongs to it.
+        Record(const SystemProcessEntry *entry, const size_t bytes) : entry_(entry), bytes_(bytes) {}
+
+        [[nodiscard]] DWORD pid() const {
+            return static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(entry_->UniqueProcessId));
+        }
+        [[nodiscard]] DWORD parentPid() const {
+            return static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(entry_->InheritedFromUniqueProcessId));
+        }
+        // Bare file name ("svchost.exe"); empty for the idle process.
+        [[nodiscard]] std::wstring_view imageName() const {
+            return entry_->ImageName.Buffer
+                       ? std::wstring_view(entry_->ImageName.Buffer, entry_->ImageName.Length / sizeof(wchar_t))
+                       : std::wstring_view();
+        }
+        [[nodiscard]] uint64_t createTime() const { return static_cast<uint64_t>(entry_->CreateTime.QuadPart); }
+        // Kernel + user, 100-ns units.
+        [[nodiscard]] uint64_t cpuTime() const {
+            return static_cast<uint64_t>(entry_->KernelTime.QuadPart) + static_cast<uint64_t>(entry_->UserTime.QuadPart);
+        }
+        [[nodiscard]] SIZE_T workingSet() const { return entry_->WorkingSetSize; }
+        [[nodiscard]] SIZE_T privateBytes() const { return entry_->PagefileUsage; }
+        // Read + write transfer bytes, what ProcessInfo::ioRate is built from.
+        [[nodiscard]] uint64_t ioBytes() const {
+            return static_cast<uint64_t>(entry_->ReadTransferCount.QuadPart) +
+                   static_cast<uint64_t>(entry_->WriteTransferCount.QuadPart);
+        }
+        [[nodiscard]] ULONG threadCount() const { return entry_->NumberOfThreads; }
+        [[nodiscard]] ULONG handleCount() const { return entry_->HandleCount; }
+        // As many of the process's threads as the entry really holds.
+        [[nodiscard]] std::span<const SystemThreadEntry> threads() const {
+            const size_t fit = bytes_ > sizeof(SystemProcessEntry)
+                                   ? (bytes_ - sizeof(SystemProcessEntry)) / sizeof(SystemThreadEntry)
+                                   : 0;
+            return {reinterpret_cast<const SystemThreadEntry *>(entry_ + 1),
+                    std::min<size_t>(entry_->NumberOfThreads, fit)};
+        }
+
+    private:
+        const SystemProcessEntry *entry_;
+        size_t bytes_;
+    };
+
+    class Iterator {
+    public:
+        Iterator() = default;
+        Iterator(const std::byte *at, const std::byte *end) : at_(at), end_(end) {}
+
+        Record operator*() const;
+        Iterator &operator++();
+        bool operator==(const Iterator &other) const { return at_ == other.at_; }
+
+    private:
+        const std::byte *at_ = nullptr;
+        const std::byte *end_ = nullptr;
+    };
+
+    // One NtQuerySystemInformation call, growing the buffer only when the
+    // table outgrew it. False leaves the table empty.
+    bool refresh();
+
+    // Adopts a table laid out the way refresh() fills one, sampled at
+    // `sampledAt` (used as both clocks); lets benchmarks run the walk without
+    // a live system.
+    void assign(std::vector<std::byte> buffer, uint64_t sampledAt);
+
+    [[nodiscard]] Iterator begin() const;
+    [[nodiscard]] Iterator end() const { return {}; }
+    [[nodiscard]] size_t size() const { return count_; }
+
+    // When the table was read, 100-ns FILETIME units. The wall clock can be
+    // stepped, so it only timestamps the sample.
+    [[nodiscard]] uint64_t sampledAt() const { return sampled_at_; }
+    // When the table was read on the unbiased interrupt time, 100-ns units:
+    // monotonic, so rates are taken over differences of this.
+    [[nodiscard]] uint64_t elapsedAt() const { return elapsed_at_; }
+
+private:
+    void countEntries();
+
+    std::vector<std::byte> buffer_;
+    size_t length_ = 0;  // bytes the last call filled
+    size_t count_ = 0;
+    uint64_t sampled_at_ = 0;
+    uint64_t elapsed_at_ = 0;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "RateKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RATES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RATES_TARGET_SSE2
+#define RATES_TARGET_AVX2
+#else
+#define RATES_TARGET_SSE2 __attribute__((target("sse2")))
+#define RATES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace rates {
+    namespace {
+        void computeScalar(const uint64_t *previous, const uint64_t *current, const uint64_t *wallDelta,
+                           const double scale, double *out, const size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                const double valid = wallDelta[i] != 0 ? 1.0 : 0.0;
+                const double wall = static_cast<double>(wallDelta[i]) + (1.0 - valid);
+                out[i] = static_cast<double>(current[i] - previous[i]) * scale / wall * valid;
+            }
+        }
+
+#ifdef RATES_X86
+        // uint64 -> double without AVX-512: each 32-bit half is placed in the
+        // mantissa of a double with a fixed exponent (2^52 for the low half,
+        // 2^84 for the high half), and the exponents are subtracted again.
+        constexpr double TwoPow52 = 4503599627370496.0;
+        constexpr double TwoPow84 = 19342813113834066795298816.0;
+        constexpr double TwoPow84Plus52 = 19342813118337666422669312.0;
+
+        RATES_TARGET_SSE2 __m128d toDouble(const __m128i x) {
+            const __m128i low = _mm_or_si128(_mm_and_si128(x, _mm_set1_epi64x(0xFFFFFFFF)),
+                                             _mm_castpd_si128(_mm_set1_pd(TwoPow52)));
+            const __m128i high = _mm_or_si128(_mm_srli_epi64(x, 32), _mm_castpd_si128(_mm_set1_pd(TwoPow84)));
+            return _mm_add_pd(_mm_sub_pd(_mm_castsi128_pd(high), _mm_set1_pd(TwoPow84Plus52)),
+                              _mm_castsi128_pd(low));
+        }
+
+        RATES_TARGET_SSE2 void computeSse2(const uint64_t *previous, const uint64_t *current,
+                                           const uint64_t *wallDelta, const double scale, double *out,
+                                           const size_t n) {
+            const __m128d scaleV = _mm_set1_pd(scale);
+            const __m128d zero = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128i was = _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous + i));
+                const __m128i is = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current + i));
+                const __m128d delta = toDouble(_mm_sub_epi64(is, was));
+                const __m128d wall = toDouble(_mm_loadu_si128(reinterpret_cast<const __m128i *>(wallDelta + i)));
+                const __m128d valid = _mm_cmpgt_pd(wall, zero);
+                _mm_storeu_pd(out + i, _mm_and_pd(_mm_div_pd(_mm_mul_pd(delta, scaleV), wall), valid));
+            }
+            computeScalar(previous + i, current + i, wallDelta + i, scale, out + i, n - i);
+        }
+
+        RATES_TARGET_AVX2 __m256d toDouble(const __m256i x) {
+            const __m256i low = _mm256_blend_epi32(x, _mm256_castpd_si256(_mm256_set1_pd(TwoPow52)), 0xAA);
+            const __m256i high = _mm256_or_si256(_mm256_srli_epi64(x, 32),
+                                                 _mm256_castpd_si256(_mm256_set1_pd(TwoPow84)));
+            return _mm256_add_pd(_mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(TwoPow84Plus52)),
+                                 _mm256_castsi256_pd(low));
+        }
+
+        RATES_TARGET_AVX2 void computeAvx2(const uint64_t *previous, const uint64_t *current,
+                                           const uint64_t *wallDelta, const double scale, double *out,
+                                           const size_t n) {
+            const __m256d scaleV = _mm256_set1_pd(scale);
+            const __m256d zero = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256i was = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(previous + i));
+                const __m256i is = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current + i));
+                const __m256d delta = toDouble(_mm256_sub_epi64(is, was));
+                const __m256d wall = toDouble(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(wallDelta + i)));
+                const __m256d valid = _mm256_cmp_pd(wall, zero, _CMP_GT_OQ);
+                _mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_div_pd(_mm256_mul_pd(delta, scaleV), wall), valid));
+            }
+            computeScalar(previous + i, current + i, wallDelta + i, scale, out + i, n - i);
+        }
+
+        bool hasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int regs[4];
+            __cpuid(regs, 0);
+            if (regs[0] < 7) {
+                return false;
+            }
+            __cpuid(regs, 1);
+            constexpr int OsXsave = 1 << 27;
+            constexpr int Avx = 1 << 28;
+            if ((regs[2] & (OsXsave | Avx)) != (OsXsave | Avx) || (_xgetbv(0) & 6) != 6) {
+                return false;  // the OS does not save YMM state
+            }
+            __cpuidex(regs, 7, 0);
+            return (regs[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+    }
+
+    Kernel best() {
+#ifdef RATES_X86
+        static const Kernel kernel = hasAvx2() ? Kernel::Avx2 : Kernel::Sse2;
+        return kernel;
+#else
+        return Kernel::Scalar;
+#endif
+    }
+
+    void compute(const uint64_t *previous, const uint64_t *current, const uint64_t *wallDelta, const double scale,
+                 double *out, const size_t n) {
+        compute(best(), previous, current, wallDelta, scale, out, n);
+    }
+
+    void compute(const Kernel kernel, const uint64_t *previous, const uint64_t *current, const uint64_t *wallDelta,
+                 const double scale, double *out, const size_t n) {
+        switch (kernel) {
+#ifdef RATES_X86
+            case Kernel::Avx2:
+                computeAvx2(previous, current, wallDelta, scale, out, n);
+                return;
+            case Kernel::Sse2:
+                computeSse2(previous, current, wallDelta, scale, out, n);
+                return;
+#endif
+            default:
+                computeScalar(previous, current, wallDelta, scale, out, n);
+        }
+    }
+}
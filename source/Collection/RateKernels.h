@@ -0,0 +1,50 @@
+#ifndef RateKernels_h
+#define RateKernels_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batch rate computation over counters gathered into columns.
+//
+// Every row is (current - previous) * scale / wallDelta, with the difference
+// taken modulo 2^64 so a counter that wrapped still gives its true delta, and
+// rows with wallDelta == 0 (no previous reading) coming out as exactly 0. Both
+// cases are masks, not branches. The widest kernel the CPU supports is picked
+// once at startup: AVX2, then SSE2, then a scalar loop.
+namespace rates {
+    enum class Kernel { Scalar, Sse2, Avx2 };
+
+    // Widest kernel this machine can run.
+    Kernel best();
+
+    void compute(const uint64_t *previous, const uint64_t *current, const uint64_t *wallDelta, double scale,
+                 double *out, size_t n);
+    // A specific kernel, for comparisons; it must be supported.
+    void compute(Kernel kernel, const uint64_t *previous, const uint64_t *current, const uint64_t *wallDelta,
+                 double scale, double *out, size_t n);
+
+    // One counter's columns for a batch. The wall deltas live with the
+    // caller, as several counters usually share them.
+    struct Column {
+        std::vector<uint64_t> previous;
+        std::vector<uint64_t> current;
+        std::vector<double> rates;
+
+        void clear() {
+            previous.clear();
+            current.clear();
+        }
+        void push(const uint64_t was, const uint64_t is) {
+            previous.push_back(was);
+            current.push_back(is);
+        }
+        // Fills rates, one per pushed row.
+        void compute(const std::vector<uint64_t> &wallDelta, const double scale) {
+            rates.resize(current.size());
+            rates::compute(previous.data(), current.data(), wallDelta.data(), scale, rates.data(), rates.size());
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include "ReplayDriver.h"
+
+#include <thread>
+
+#include "ReplayProcessSource.h"
+
+ReplayDriver::Result ReplayDriver::run(const uint64_t maxTicks, ProcessMonitor::UpdateCallback consumer,
+                                       const std::chrono::milliseconds pollInterval) {
+    Result result;
+    monitor_.setUpdateCallback([&result, &consumer](const ProcessUpdateData &data) {
+        ++result.batches;
+        result.added += data.added.size();
+        result.removed += data.removed_pids.size();
+        result.updated += data.updated.size();
+        if (consumer) {
+            consumer(data);
+        }
+    });
+
+    while (!source_.finished() && (maxTicks == 0 || result.ticks < maxTicks)) {
+        const uint64_t replayed = source_.ticksReplayed();
+        const auto start = std::chrono::steady_clock::now();
+        monitor_.pollOnce();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        // The poll that finds the recording exhausted replays nothing.
+        if (source_.finished() && source_.ticksReplayed() == replayed) {
+            break;
+        }
+
+        ++result.ticks;
+        result.total += elapsed;
+        result.worstTick = std::max<std::chrono::nanoseconds>(result.worstTick, elapsed);
+
+        if (pollInterval.count() > 0) {
+            std::this_thread::sleep_for(pollInterval);
+        }
+    }
+
+    monitor_.setUpdateCallback(nullptr);
+    return result;
+}
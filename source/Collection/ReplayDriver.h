@@ -0,0 +1,44 @@
+#ifndef ReplayDriver_h
+#define ReplayDriver_h
+
+#include <chrono>
+#include <cstdint>
+
+#include "ProcessMonitor.h"
+
+class ReplayProcessSource;
+
+// Repeatable benchmark of the collect -> diff -> ProcessUpdateData -> consumer
+// path. The monitor must be built with interval == 0 around `source`; the
+// driver then polls it on the calling thread until the recording runs out.
+class ReplayDriver {
+public:
+    struct Result {
+        uint64_t ticks = 0;
+        uint64_t batches = 0;  // ticks that produced a non-empty update
+        uint64_t added = 0;
+        uint64_t removed = 0;
+        uint64_t updated = 0;
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds worstTick{0};
+
+        [[nodiscard]] double ticksPerSecond() const {
+            return total.count() > 0 ? static_cast<double>(ticks) * 1e9 / static_cast<double>(total.count()) : 0.0;
+        }
+    };
+
+    ReplayDriver(ProcessMonitor &monitor, const ReplayProcessSource &source)
+        : monitor_(monitor), source_(source) {}
+
+    // maxTicks == 0 runs to the end of the recording. `consumer` sees every
+    // update after it has been counted; pollInterval paces the paced replay modes.
+    Result run(uint64_t maxTicks = 0,
+               ProcessMonitor::UpdateCallback consumer = nullptr,
+               std::chrono::milliseconds pollInterval = std::chrono::milliseconds(0));
+
+private:
+    ProcessMonitor &monitor_;
+    const ReplayProcessSource &source_;
+};
+
+#endif
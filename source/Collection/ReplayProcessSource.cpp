@@ -0,0 +1,111 @@
+#include "ReplayProcessSource.h"
+
+#include <iostream>
+
+ReplayProcessSource::ReplayProcessSource(std::wstring basePath, const ReplayOptions options, const uint64_t firstSegment)
+    : reader_(std::move(basePath), firstSegment), options_(options) {
+    if (!reader_.isOpen()) {
+        std::cerr << "ReplayProcessSource: recording could not be opened" << std::endl;
+        finished_ = true;
+    }
+    if (options_.pacing == ReplayPacing::RealTime || options_.speedFactor <= 0.0) {
+        options_.speedFactor = 1.0;
+    }
+}
+
+bool ReplayProcessSource::fetch() {
+    if (has_pending_) {
+        return true;
+    }
+    if (reader_.next(pending_)) {
+        has_pending_ = true;
+        return true;
+    }
+    if (options_.loop && ticks_replayed_ > 0 && reader_.rewind() && reader_.next(pending_)) {
+        // Recorded timestamps restart, so restart the replay clock with them.
+        started_ = false;
+        has_pending_ = true;
+        return true;
+    }
+    return false;
+}
+
+bool ReplayProcessSource::due(const SnapshotReader::Tick &tick) const {
+    if (options_.pacing == ReplayPacing::AsFastAsPossible || !started_) {
+        return true;
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_at_).count();
+    // FILETIME ticks are 100 ns.
+    const double recorded = static_cast<double>(tick.timestamp - first_timestamp_) / 1e7;
+    return recorded <= elapsed * options_.speedFactor;
+}
+
+void ReplayProcessSource::apply(const SnapshotReader::Tick &tick) {
+    if (!started_) {
+        started_ = true;
+        started_at_ = std::chrono::steady_clock::now();
+        first_timestamp_ = tick.timestamp;
+    }
+    if (tick.keyframe) {
+        identities_.clear();
+    }
+    for (const uint32_t pid: tick.removed) {
+        identities_.erase(pid);
+    }
+    tick.forEachAdded([this](const SnapshotReader::Added &added) {
+        identities_[added.pid] = Identity{added.parentPid, std::wstring(added.name), std::wstring(added.path),
+                                          std::wstring(added.commandLine)};
+    });
+
+    // Updated in place so rows that persist keep their nodes and strings.
+    if (tick.keyframe) {
+        table_.clear();
+    }
+    for (const uint32_t pid: tick.removed) {
+        table_.erase(pid);
+    }
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t row = 0; row < tick.pids.size(); ++row) {
+        const DWORD pid = tick.pids[row];
+        auto [entry, inserted] = table_.try_emplace(pid, pid);
+        ProcessInfo &info = entry->second;
+        if (inserted) {
+            if (const auto it = identities_.find(pid); it != identities_.end()) {
+                info.parentPid = it->second.parentPid;
+                info.name = it->second.name;
+                info.path = it->second.path;
+                info.commandLine = it->second.commandLine;
+            }
+        }
+        info.cpuUsage = tick.cpu[row];
+        info.ramUsage = static_cast<SIZE_T>(tick.ram[row]);
+        info.ioRate = tick.io[row];
+        info.lastUpdateTime = now;
+    }
+    ++ticks_replayed_;
+}
+
+bool ReplayProcessSource::collect(CollectedProcesses &out, const std::stop_token &st) {
+    if (options_.pacing == ReplayPacing::AsFastAsPossible) {
+        if (fetch()) {
+            apply(pending_);
+            has_pending_ = false;
+        } else {
+            finished_ = true;
+        }
+    } else {
+        while (!st.stop_requested() && fetch() && due(pending_)) {
+            apply(pending_);
+            has_pending_ = false;
+        }
+        if (!has_pending_ && !fetch()) {
+            finished_ = true;
+        }
+    }
+
+    out.reserve(table_.size());
+    for (const auto &[pid, info]: table_) {
+        out.try_emplace(pid, info);
+    }
+    return ticks_replayed_ > 0;
+}
@@ -0,0 +1,71 @@
+#ifndef ReplayProcessSource_h
+#define ReplayProcessSource_h
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include "ProcessSource.h"
+#include "Recording/SnapshotReader.h"
+
+enum class ReplayPacing {
+    RealTime,          // ticks are due at their recorded spacing
+    Accelerated,       // recorded spacing divided by speedFactor
+    AsFastAsPossible,  // one recorded tick per collect()
+};
+
+struct ReplayOptions {
+    ReplayPacing pacing = ReplayPacing::RealTime;
+    double speedFactor = 1.0;
+    bool loop = false;
+};
+
+// Feeds a recording made by SnapshotRecorder back through ProcessMonitor, so the
+// diff and publish path sees exactly the same sequence of tables on every run.
+//
+// In the paced modes collect() presents the newest recorded tick that is due on
+// the replay clock; ticks skipped in between still apply their added/removed
+// records so names stay correct. With nothing due, the previous table is
+// presented again and the diff is empty.
+class ReplayProcessSource final : public ProcessSource {
+public:
+    ReplayProcessSource(std::wstring basePath, ReplayOptions options, uint64_t firstSegment = 0);
+
+    bool collect(CollectedProcesses &out, const std::stop_token &st) override;
+
+    // The recording is exhausted (never true when looping). Safe to poll
+    // from another thread while ticks run.
+    [[nodiscard]] bool finished() const { return finished_.load(); }
+    [[nodiscard]] uint64_t ticksReplayed() const { return ticks_replayed_; }
+    [[nodiscard]] bool isOpen() const { return reader_.isOpen(); }
+
+private:
+    struct Identity {
+        DWORD parentPid;
+        std::wstring name;
+        std::wstring path;
+        std::wstring commandLine;
+    };
+
+    bool fetch();
+    void apply(const SnapshotReader::Tick &tick);
+    bool due(const SnapshotReader::Tick &tick) const;
+
+    SnapshotReader reader_;
+    ReplayOptions options_;
+
+    SnapshotReader::Tick pending_;
+    bool has_pending_ = false;
+    std::atomic<bool> finished_ = false;
+
+    std::unordered_map<DWORD, Identity> identities_;
+    std::unordered_map<DWORD, ProcessInfo> table_;
+
+    int64_t first_timestamp_ = 0;
+    std::chrono::steady_clock::time_point started_at_;
+    bool started_ = false;
+    uint64_t ticks_replayed_ = 0;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "SystemSampler.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    constexpr ULONG SystemProcessorPerformanceInformation = 8;
+    constexpr ULONG SystemInterruptInformation = 23;
+
+    // SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION with its reserved fields named.
+    struct ProcessorPerformance {
+        LARGE_INTEGER IdleTime;
+        LARGE_INTEGER KernelTime;
+        LARGE_INTEGER UserTime;
+        LARGE_INTEGER DpcTime;
+        LARGE_INTEGER InterruptTime;
+        ULONG InterruptCount;
+    };
+
+    // SYSTEM_INTERRUPT_INFORMATION
+    struct ProcessorInterrupts {
+        ULONG ContextSwitches;
+        ULONG DpcCount;
+        ULONG DpcRate;
+        ULONG TimeIncrement;
+        ULONG DpcBypassCount;
+        ULONG ApcBypassCount;
+    };
+
+    using NtQuerySystemInformationPtr = LONG(WINAPI*)(ULONG, PVOID, ULONG, PULONG);
+
+    CpuTimes share(const int64_t user, const int64_t system, const int64_t idle, const int64_t dpc,
+                   const int64_t interrupt) {
+        CpuTimes times;
+        const int64_t elapsed = user + system + idle + dpc + interrupt;
+        if (elapsed <= 0) {
+            times.idle = 100.0;
+            return times;
+        }
+        const double scale = 100.0 / static_cast<double>(elapsed);
+        times.user = static_cast<double>(user) * scale;
+        times.system = static_cast<double>(system) * scale;
+        times.idle = static_cast<double>(idle) * scale;
+        times.dpc = static_cast<double>(dpc) * scale;
+        times.interrupt = static_cast<double>(interrupt) * scale;
+        return times;
+    }
+}
+
+bool SystemSampler::sample() {
+    const auto now = std::chrono::steady_clock::now();
+    if (!read(current_)) {
+        return false;
+    }
+    const auto previousTime = std::exchange(previous_time_, now);
+    if (current_.size() != previous_.size()) {
+        std::swap(previous_, current_);
+        return false;  // priming, or the visible processor set changed
+    }
+
+    const double seconds = std::chrono::duration<double>(now - previousTime).count();
+    std::scoped_lock lk(mtx_);
+    latest_.time = now;
+    latest_.cores.resize(previous_.size());
+
+    int64_t user = 0, system = 0, idle = 0, dpc = 0, interrupt = 0;
+    uint64_t contextSwitches = 0, interrupts = 0;
+    for (size_t i = 0; i < previous_.size(); ++i) {
+        const Counters &was = previous_[i];
+        const Counters &is = current_[i];
+        const int64_t coreIdle = std::max<int64_t>(is.idle - was.idle, 0);
+        const int64_t coreUser = std::max<int64_t>(is.user - was.user, 0);
+        const int64_t coreDpc = std::max<int64_t>(is.dpc - was.dpc, 0);
+        const int64_t coreInterrupt = std::max<int64_t>(is.interrupt - was.interrupt, 0);
+        const int64_t coreSystem = std::max<int64_t>(is.kernel - was.kernel - coreIdle - coreDpc - coreInterrupt, 0);
+        latest_.cores[i] = share(coreUser, coreSystem, coreIdle, coreDpc, coreInterrupt);
+
+        user += coreUser;
+        system += coreSystem;
+        idle += coreIdle;
+        dpc += coreDpc;
+        interrupt += coreInterrupt;
+        // 32-bit counters; unsigned subtraction survives one wrap.
+        contextSwitches += static_cast<uint32_t>(is.contextSwitches - was.contextSwitches);
+        interrupts += static_cast<uint32_t>(is.interrupts - was.interrupts);
+    }
+    latest_.total = share(user, system, idle, dpc, interrupt);
+    latest_.contextSwitchesPerSec = seconds > 0.0 ? static_cast<double>(contextSwitches) / seconds : 0.0;
+    latest_.interruptsPerSec = seconds > 0.0 ? static_cast<double>(interrupts) / seconds : 0.0;
+    has_latest_ = true;
+    std::swap(previous_, current_);
+    return true;
+}
+
+bool SystemSampler::latest(SystemSample &out) const {
+    std::scoped_lock lk(mtx_);
+    if (!has_latest_) {
+        return false;
+    }
+    out.time = latest_.time;
+    out.total = latest_.total;
+    out.cores.assign(latest_.cores.begin(), latest_.cores.end());
+    out.contextSwitchesPerSec = latest_.contextSwitchesPerSec;
+    out.interruptsPerSec = latest_.interruptsPerSec;
+    return true;
+}
+
+bool SystemSampler::read(std::vector<Counters> &out) {
+    static const auto query = [] {
+        HMODULE hMod = ::GetModuleHandleW(L"ntdll.dll");
+        return hMod ? reinterpret_cast<NtQuerySystemInformationPtr>(
+                          ::GetProcAddress(hMod, "NtQuerySystemInformation"))
+                    : nullptr;
+    }();
+    static const size_t processors = [] {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return static_cast<size_t>(si.dwNumberOfProcessors);
+    }();
+    if (!query || processors == 0) {
+        return false;
+    }
+
+    buffer_.resize(processors * std::max(sizeof(ProcessorPerformance), sizeof(ProcessorInterrupts)));
+    const auto bufferSize = static_cast<ULONG>(buffer_.size());
+
+    ULONG returned = 0;
+    if (query(SystemProcessorPerformanceInformation, buffer_.data(), bufferSize, &returned) < 0) {
+        return false;
+    }
+    const size_t count = returned / sizeof(ProcessorPerformance);
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        ProcessorPerformance perf;
+        std::memcpy(&perf, buffer_.data() + i * sizeof(perf), sizeof(perf));
+        Counters &counters = out[i];
+        counters.idle = perf.IdleTime.QuadPart;
+        counters.kernel = perf.KernelTime.QuadPart;
+        counters.user = perf.UserTime.QuadPart;
+        counters.dpc = perf.DpcTime.QuadPart;
+        counters.interrupt = perf.InterruptTime.QuadPart;
+        counters.interrupts = perf.InterruptCount;
+    }
+
+    if (query(SystemInterruptInformation, buffer_.data(), bufferSize, &returned) < 0) {
+        return false;
+    }
+    const size_t interruptCount = std::min(count, returned / sizeof(ProcessorInterrupts));
+    for (size_t i = 0; i < interruptCount; ++i) {
+        ProcessorInterrupts info;
+        std::memcpy(&info, buffer_.data() + i * sizeof(info), sizeof(info));
+        out[i].contextSwitches = info.ContextSwitches;
+    }
+    return count > 0;
+}
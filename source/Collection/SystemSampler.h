@@ -0,0 +1,71 @@
+#ifndef SystemSampler_h
+#define SystemSampler_h
+
+#include <windows.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Share of one processor's (or all processors') time over the last interval,
+// in percent. The five parts add up to 100.
+struct CpuTimes {
+    double user = 0.0;
+    double system = 0.0;     // kernel time outside idle, DPCs and interrupts
+    double idle = 0.0;
+    double dpc = 0.0;        // deferred procedure calls
+    double interrupt = 0.0;  // hardware interrupt service
+
+    [[nodiscard]] double busy() const { return 100.0 - idle; }
+};
+
+struct SystemSample {
+    std::chrono::steady_clock::time_point time;
+    CpuTimes total;                 // every core weighted equally
+    std::vector<CpuTimes> cores;
+    double contextSwitchesPerSec = 0.0;
+    double interruptsPerSec = 0.0;
+};
+
+// Machine-wide CPU and scheduler counters.
+//
+// One sample() is two NtQuerySystemInformation calls, each returning a fixed
+// record per processor, so the cost does not grow with the number of
+// processes. Rates need a previous reading: the first sample() only primes.
+// Windows has no iowait or steal time; DPC and interrupt time are reported in
+// their place. Only processors in the calling thread's group are seen, which
+// is every processor on machines with 64 or fewer.
+class SystemSampler {
+public:
+    // Read the counters and turn them into a sample. Returns false while
+    // priming or when the counters cannot be read.
+    bool sample();
+
+    // Copy of the last sample into out (reusing its storage). False before
+    // the first complete one.
+    bool latest(SystemSample &out) const;
+
+private:
+    struct Counters {
+        int64_t idle = 0;
+        int64_t kernel = 0;  // includes idle, DPC and interrupt time
+        int64_t user = 0;
+        int64_t dpc = 0;
+        int64_t interrupt = 0;
+        uint32_t interrupts = 0;
+        uint32_t contextSwitches = 0;
+    };
+
+    bool read(std::vector<Counters> &out);
+
+    std::vector<std::byte> buffer_;
+    std::vector<Counters> previous_;
+    std::vector<Counters> current_;
+    std::chrono::steady_clock::time_point previous_time_;
+
+    mutable std::mutex mtx_;
+    SystemSample latest_;
+    bool has_latest_ = false;
+};
+
+#endif
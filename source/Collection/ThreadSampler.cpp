@@ -0,0 +1,108 @@
+#include "ThreadSampler.h"
+#include <ranges>
+
+#include "HandleWrapper.h"
+
+void ThreadSampler::expand(const DWORD pid) {
+    std::scoped_lock lk(mtx_);
+    ++expanded_[pid].refs;
+}
+
+void ThreadSampler::collapse(const DWORD pid) {
+    std::scoped_lock lk(mtx_);
+    if (const auto it = expanded_.find(pid); it != expanded_.end() && --it->second.refs == 0) {
+        expanded_.erase(it);
+    }
+}
+
+bool ThreadSampler::hasExpanded() const {
+    std::scoped_lock lk(mtx_);
+    return !expanded_.empty();
+}
+
+void ThreadSampler::onProcessRemoved(const DWORD pid) {
+    std::scoped_lock lk(mtx_);
+    if (const auto it = expanded_.find(pid); it != expanded_.end()) {
+        // Keep the subscription (the consumer collapses it) but drop the threads.
+        it->second.threads.clear();
+    }
+}
+
+void ThreadSampler::describe(Tracked &tracked) {
+    const HandleWrapper hThread(OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, tracked.info.tid));
+    if (!hThread.isValid()) {
+        return;
+    }
+    PWSTR description = nullptr;
+    if (SUCCEEDED(GetThreadDescription(hThread, &description)) && description) {
+        tracked.info.description = description;
+    }
+    LocalFree(description);
+}
+
+void ThreadSampler::sample(const ProcessTableReader &table) {
+    std::scoped_lock lk(mtx_);
+    if (expanded_.empty()) {
+        return;
+    }
+
+    const uint64_t wall = table.elapsedAt();
+    size_t pending = expanded_.size();
+    for (const ProcessTableReader::Record record: table) {
+        const auto it = expanded_.find(record.pid());
+        if (it == expanded_.end()) {
+            continue;
+        }
+        for (const SystemThreadEntry &entry: record.threads()) {
+            const auto tid = static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(entry.ClientId.UniqueThread));
+            const auto createTime = static_cast<uint64_t>(entry.CreateTime.QuadPart);
+            auto [threadIt, inserted] = it->second.threads.try_emplace(tid);
+            Tracked &tracked = threadIt->second;
+            if (inserted || tracked.createTime != createTime) {
+                tracked = Tracked{};
+                tracked.createTime = createTime;
+                tracked.info.tid = tid;
+                describe(tracked);
+            }
+
+            const uint64_t cpuTime = static_cast<uint64_t>(entry.KernelTime.QuadPart) +
+                                     static_cast<uint64_t>(entry.UserTime.QuadPart);
+            if (const auto usage = ProcessMetrics::CpuPercent(tracked.cpu, cpuTime, wall)) {
+                tracked.info.cpuUsage = *usage;
+            }
+            tracked.info.basePriority = entry.BasePriority;
+            tracked.info.priority = entry.Priority;
+            tracked.info.state = static_cast<ThreadState>(entry.ThreadState);
+            tracked.info.waitReason = entry.WaitReason;
+            tracked.info.contextSwitches = entry.ContextSwitches;
+            tracked.seen = true;
+        }
+        if (--pending == 0) {
+            break;
+        }
+    }
+
+    // Threads missing from the table have exited.
+    for (auto &process: expanded_ | std::views::values) {
+        for (auto it = process.threads.begin(); it != process.threads.end();) {
+            if (!it->second.seen) {
+                it = process.threads.erase(it);
+            } else {
+                it->second.seen = false;
+                ++it;
+            }
+        }
+    }
+}
+
+std::vector<ThreadInfo> ThreadSampler::getThreads(const DWORD pid) const {
+    std::scoped_lock lk(mtx_);
+    std::vector<ThreadInfo> out;
+    if (const auto it = expanded_.find(pid); it != expanded_.end()) {
+        out.reserve(it->second.threads.size());
+        for (const auto &tracked: it->second.threads | std::views::values) {
+            out.push_back(tracked.info);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,77 @@
+#ifndef ThreadSampler_h
+#define ThreadSampler_h
+
+#include <windows.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessTableReader.h"
+#include "ProcessMetrics.h"
+
+// KTHREAD_STATE, as the process table reports it.
+enum class ThreadState : uint8_t {
+    Initialized = 0,
+    Ready = 1,                    // runnable, waiting for a processor
+    Running = 2,
+    Standby = 3,                  // picked to run next on a processor
+    Terminated = 4,
+    Waiting = 5,                  // see ThreadInfo::waitReason
+    Transition = 6,               // runnable, but its kernel stack is paged out
+    DeferredReady = 7,
+    GateWait = 8,
+    WaitingForProcessInSwap = 9,
+};
+
+struct ThreadInfo {
+    DWORD tid = 0;
+    double cpuUsage = 0.0;   // % of the machine, same scale as ProcessInfo::cpuUsage
+    LONG basePriority = 0;
+    LONG priority = 0;       // current (dynamic) priority, 0-31
+    ThreadState state = ThreadState::Initialized;
+    ULONG waitReason = 0;    // KWAIT_REASON while Waiting (e.g. 6 UserRequest, 15 WrQueue)
+    ULONG contextSwitches = 0;
+    std::wstring description; // SetThreadDescription name, if any
+};
+
+// Per-thread CPU and scheduler state for the processes a consumer has
+// expanded, and only those.
+//
+// Everything but the description comes from the thread records that follow
+// each process in the SystemProcessInformation table the source already reads
+// per tick, so sampling costs no system call; the description is read once per
+// thread. Expansion is reference counted so several consumers can watch the
+// same process.
+class ThreadSampler {
+public:
+    void expand(DWORD pid);
+    void collapse(DWORD pid);
+    [[nodiscard]] bool hasExpanded() const;
+
+    void sample(const ProcessTableReader &table);
+    void onProcessRemoved(DWORD pid);
+
+    // Threads of an expanded pid as of the last sample (empty otherwise).
+    [[nodiscard]] std::vector<ThreadInfo> getThreads(DWORD pid) const;
+
+private:
+    struct Tracked {
+        uint64_t createTime = 0;  // tells a reused TID from the thread that held it
+        ProcessMetrics::CpuSample cpu;
+        ThreadInfo info;
+        bool seen = false;
+    };
+
+    struct Expanded {
+        unsigned refs = 0;
+        std::unordered_map<DWORD, Tracked> threads;
+    };
+
+    static void describe(Tracked &tracked);
+
+    mutable std::mutex mtx_;
+    std::unordered_map<DWORD, Expanded> expanded_;
+};
+
+#endif
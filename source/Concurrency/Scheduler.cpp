@@ -35,7 +35,9 @@ void Scheduler::scheduler_loop(const std::stop_token &st) const {
             }
 
             if (now >= task->next_execution) {
-                std::cout << "Executing task " << task->name <<std::endl;
+                dispatched_.fetch_add(1, std::memory_order_relaxed);
+                lateness_us_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                           now - task->next_execution).count(), std::memory_order_relaxed);
                 const auto nextExecutionForThisTask = now + task->interval;
                 task_mgr_.updateTaskNextRunTime(task->id, nextExecutionForThisTask);
 
@@ -64,12 +66,14 @@ void Scheduler::scheduler_loop(const std::stop_token &st) const {
             } else {
                 earliestNextRun = std::min(earliestNextRun, task->next_execution);
             }
+        }
 
-            if (earliestNextRun > std::chrono::steady_clock::now()) {
-                std::this_thread::sleep_until(earliestNextRun);
-            } else {
-                std::this_thread::yield();
-            }
+        // Once per pass, after every due task is queued; with no tasks this
+        // still waits out the precision instead of spinning.
+        if (earliestNextRun > std::chrono::steady_clock::now()) {
+            std::this_thread::sleep_until(earliestNextRun);
+        } else {
+            std::this_thread::yield();
         }
     }
 }
@@ -1,6 +1,8 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <stop_token>
 #include <thread>
 
@@ -21,12 +23,22 @@ public:
     Scheduler(Scheduler&&) = delete;
     Scheduler& operator=(Scheduler&&) = delete;
 
+    // Telemetry. Lateness is how long after its due time a task was queued,
+    // summed over all dispatches; divided by dispatches it is the mean.
+    [[nodiscard]] uint64_t dispatchedTasks() const { return dispatched_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::chrono::microseconds totalLateness() const {
+        return std::chrono::microseconds(lateness_us_.load(std::memory_order_relaxed));
+    }
+
 private:
     void scheduler_loop(const std::stop_token &st) const;
 
     TaskManager& task_mgr_;
     ThreadPool& thread_pool_;
     std::chrono::milliseconds precision_{50ms};
+    // Before the thread, which starts updating them in the constructor.
+    mutable std::atomic<uint64_t> dispatched_{0};
+    mutable std::atomic<uint64_t> lateness_us_{0};
     std::stop_source scheduler_stop_source_;
     std::jthread scheduler_thread_;
     std::atomic<bool> scheduler_stopped_;
@@ -16,17 +16,24 @@ ThreadPool::ThreadPool(std::size_t num_threads) {
 }
 
 ThreadPool::~ThreadPool() {
-    if (!stopped_.exchange(true)) {
-        stop_all_.request_stop();
-        condition_.notify_all();
-    }
+    stop();
 }
 
+// Joins here rather than in the members' destructors, which would run after
+// the queue and its mutex are gone.
 void ThreadPool::stop() {
     if (!stopped_.exchange(true)) {
-        stop_all_.request_stop();
+        {
+            std::lock_guard lock(queue_mutex_);
+            stop_all_.request_stop();
+        }
         condition_.notify_all();
     }
+    for (std::jthread &worker: worker_threads_) {
+        if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+            worker.join();
+        }
+    }
 }
 
 void ThreadPool::enqueue(std::function<void()> task) {
@@ -36,6 +43,7 @@ void ThreadPool::enqueue(std::function<void()> task) {
     {
         std::unique_lock lock(queue_mutex_);
         tasks_.emplace(std::move(task));
+        queued_.fetch_add(1, std::memory_order_relaxed);
     }
     condition_.notify_one();
 }
@@ -56,8 +64,10 @@ void ThreadPool::workerLoop(const std::stop_token &st) {
             if (!tasks_.empty()) {
                 task = std::move(tasks_.front());
                 tasks_.pop();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
             }
         }
+        busy_.fetch_add(1, std::memory_order_relaxed);
         try {
             task();
         } catch (const std::exception& e) {
@@ -67,5 +77,7 @@ void ThreadPool::workerLoop(const std::stop_token &st) {
             std::cerr << "ThreadPool: Worker thread [" << std::this_thread::get_id()
                       << "] caught unknown exception.\n";
         }
+        busy_.fetch_sub(1, std::memory_order_relaxed);
+        completed_.fetch_add(1, std::memory_order_relaxed);
     }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef THREAD_POOL_H
 #define THREAD_POOL_H
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <queue>
@@ -13,10 +15,17 @@ public:
 
     ~ThreadPool();
 
+    // Lets running tasks finish, drops queued ones and waits for the workers.
     void stop();
     void enqueue(std::function<void()> task);
     void workerLoop(const std::stop_token &st);
 
+    // Telemetry; each value is read on its own, not as one snapshot.
+    [[nodiscard]] std::size_t workerCount() const { return worker_threads_.size(); }
+    [[nodiscard]] std::size_t queuedTasks() const { return queued_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t busyWorkers() const { return busy_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t completedTasks() const { return completed_.load(std::memory_order_relaxed); }
+
 private:
     std::vector<std::jthread> worker_threads_;
     std::queue<std::function<void()>> tasks_;
@@ -24,6 +33,9 @@ private:
     std::condition_variable condition_;
     std::stop_source stop_all_;
     std::atomic<bool> stopped_{false};
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> busy_{0};
+    std::atomic<uint64_t> completed_{0};
 };
 
 #endif
\ No newline at end of file
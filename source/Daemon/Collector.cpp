@@ -0,0 +1,112 @@
+#include "Collector.h"
+
+#include <iostream>
+
+#include "Concurrency/Scheduler.h"
+#include "Concurrency/TaskManager.h"
+#include "Concurrency/ThreadPool.h"
+#include "Recording/SnapshotRecorder.h"
+
+Collector::Collector(Options options) : options_(std::move(options)) {}
+
+Collector::~Collector() {
+    stop();
+}
+
+void Collector::addSink(std::shared_ptr<UpdateSink> sink) {
+    if (running_) {
+        std::cerr << "Collector: sinks must be added before start()" << std::endl;
+        return;
+    }
+    sinks_.push_back(std::move(sink));
+}
+
+bool Collector::start() {
+    if (running_) {
+        return true;
+    }
+
+    std::unique_ptr<ProcessSource> source;
+    if (!options_.replayPath.empty()) {
+        auto replay = std::make_unique<ReplayProcessSource>(options_.replayPath, options_.replay);
+        if (!replay->isOpen()) {
+            std::cerr << "Collector: cannot open the recording" << std::endl;
+            return false;
+        }
+        replay_ = replay.get();
+        source = std::move(replay);
+    }
+
+    std::shared_ptr<SnapshotRecorder> recorder;
+    if (!options_.recordPath.empty()) {
+        recorder = std::make_shared<SnapshotRecorder>(options_.recordPath);
+        if (!recorder->isOpen()) {
+            std::cerr << "Collector: cannot create the recording" << std::endl;
+            replay_ = nullptr;
+            return false;
+        }
+    }
+
+    // The monitor queues its task right away; without a scheduler yet,
+    // nothing runs until the callbacks and rules below are in place.
+    task_manager_ = std::make_unique<TaskManager>();
+    thread_pool_ = std::make_unique<ThreadPool>(options_.workerThreads);
+    monitor_ = std::make_unique<ProcessMonitor>(*task_manager_, nullptr, nullptr, std::move(source),
+                                                options_.interval);
+
+    for (const std::wstring &text: options_.alertRules) {
+        std::string error;
+        if (!monitor_->addAlertRule(text, &error)) {
+            std::cerr << "Collector: " << error << std::endl;
+            monitor_.reset();
+            thread_pool_.reset();
+            task_manager_.reset();
+            replay_ = nullptr;
+            return false;
+        }
+    }
+    monitor_->setUpdateCallback([this](const ProcessUpdateData &update) { dispatch(update); });
+    monitor_->addAlertSink([this](const AlertEvent &event) {
+        for (const auto &sink: sinks_) {
+            sink->onAlert(event);
+        }
+    });
+    if (recorder) {
+        monitor_->setRecorder(std::move(recorder));
+    }
+
+    scheduler_ = std::make_unique<Scheduler>(*task_manager_, *thread_pool_, options_.schedulerPrecision);
+    running_ = true;
+    return true;
+}
+
+void Collector::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+
+    // Sinks read the scheduler and the pool while rendering, so both stay
+    // alive until the monitor, and with it every tick and lifecycle
+    // notification, is gone.
+    thread_pool_->stop();
+    monitor_.reset();
+    scheduler_.reset();
+    thread_pool_.reset();
+    task_manager_.reset();
+    replay_ = nullptr;
+
+    for (const auto &sink: sinks_) {
+        sink->close();
+    }
+}
+
+bool Collector::finished() const {
+    return replay_ && replay_->finished();
+}
+
+void Collector::dispatch(const ProcessUpdateData &update) const {
+    for (const auto &sink: sinks_) {
+        sink->onUpdate(update);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef Collector_h
+#define Collector_h
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "UpdateSink.h"
+#include "ProcessMonitor.h"
+#include "Collection/ReplayProcessSource.h"
+
+class Scheduler;
+class TaskManager;
+class ThreadPool;
+
+// The process collector without a window: the same TaskManager, ThreadPool,
+// Scheduler and ProcessMonitor the GUI builds, with every tick fanned out to
+// UpdateSinks instead of posted to a list view.
+//
+// The source is the live system, or a recording when replayPath is set; with
+// recordPath set every tick is also written to disk. Sinks are added before
+// start() and run on the tick thread (see UpdateSink).
+//
+// start() and stop() are called from one controlling thread. stop() first
+// stops the pool, which finishes the tick in flight and runs nothing after
+// it; then tears down the monitor, the scheduler and the rest, and closes
+// the sinks last.
+class Collector {
+public:
+    struct Options {
+        std::chrono::milliseconds interval{1000};
+        size_t workerThreads = 1;
+        // The scheduler never sleeps longer than this; it only bounds how
+        // quickly stop() is noticed, ticks are scheduled exactly.
+        std::chrono::milliseconds schedulerPrecision{250};
+        std::wstring recordPath;  // base path for SnapshotRecorder; empty: off
+        std::wstring replayPath;  // base path of a recording; empty: live system
+        ReplayOptions replay;
+        std::vector<std::wstring> alertRules;
+    };
+
+    explicit Collector(Options options);
+    ~Collector();
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    void addSink(std::shared_ptr<UpdateSink> sink);
+
+    // False (with the reason on std::cerr) if the recording, the recorder or
+    // an alert rule cannot be set up; nothing is left running then.
+    bool start();
+    void stop();
+
+    // A replayed recording ran out; the owner decides whether to stop.
+    [[nodiscard]] bool finished() const;
+
+    // Valid between start() and stop().
+    [[nodiscard]] ProcessMonitor *monitor() const { return monitor_.get(); }
+    [[nodiscard]] const Scheduler *scheduler() const { return scheduler_.get(); }
+    [[nodiscard]] const ThreadPool *threadPool() const { return thread_pool_.get(); }
+
+private:
+    void dispatch(const ProcessUpdateData &update) const;
+
+    Options options_;
+    std::vector<std::shared_ptr<UpdateSink>> sinks_;
+    std::unique_ptr<TaskManager> task_manager_;
+    std::unique_ptr<ThreadPool> thread_pool_;
+    std::unique_ptr<Scheduler> scheduler_;
+    std::unique_ptr<ProcessMonitor> monitor_;
+    const ReplayProcessSource *replay_ = nullptr;  // owned by monitor_
+    bool running_ = false;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "SummarySink.h"
+
+#include <format>
+
+#include "Export/TextEncoding.h"
+
+SummarySink::SummarySink(std::ostream &out, const std::chrono::seconds period) : out_(out), period_(period) {}
+
+void SummarySink::onUpdate(const ProcessUpdateData &update) {
+    ++batches_;
+    added_ += update.added.size();
+    removed_ += update.removed_pids.size();
+    updated_ += update.updated.size();
+    transient_ += update.transient.size();
+    processes_ += static_cast<int64_t>(update.added.size()) - static_cast<int64_t>(update.removed_pids.size());
+
+    if (const auto now = std::chrono::steady_clock::now(); now - last_flush_ >= period_) {
+        flush(now);
+    }
+}
+
+void SummarySink::onAlert(const AlertEvent &event) {
+    ++alerts_;
+    out_ << std::format("[alert] {} pid {} ({}) {} value {:.2f}\n",
+                        event.kind == AlertEvent::Kind::Fired ? "FIRED   " : "resolved",
+                        event.pid, toUtf8(event.processName), toUtf8(event.ruleText), event.value);
+}
+
+void SummarySink::close() {
+    flush(std::chrono::steady_clock::now());
+}
+
+void SummarySink::flush(const std::chrono::steady_clock::time_point now) {
+    out_ << std::format("[collector] {} processes, +{} -{} ~{} updates, {} transient, {} alerts over {} batches\n",
+                        processes_, added_, removed_, updated_, transient_, alerts_, batches_);
+    out_.flush();
+    last_flush_ = now;
+    batches_ = added_ = removed_ = updated_ = transient_ = alerts_ = 0;
+}
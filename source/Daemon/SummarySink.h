@@ -0,0 +1,36 @@
+#ifndef SummarySink_h
+#define SummarySink_h
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "UpdateSink.h"
+
+// Human-readable log for the headless collector: one summary line per
+// `period` with the table size and what changed since the last line, plus
+// one line per alert as it happens. Process names are written as UTF-8.
+class SummarySink final : public UpdateSink {
+public:
+    SummarySink(std::ostream &out, std::chrono::seconds period);
+
+    void onUpdate(const ProcessUpdateData &update) override;
+    void onAlert(const AlertEvent &event) override;
+    void close() override;
+
+private:
+    void flush(std::chrono::steady_clock::time_point now);
+
+    std::ostream &out_;
+    std::chrono::seconds period_;
+    std::chrono::steady_clock::time_point last_flush_ = std::chrono::steady_clock::now();
+    int64_t processes_ = 0;
+    uint64_t batches_ = 0;
+    uint64_t added_ = 0;
+    uint64_t removed_ = 0;
+    uint64_t updated_ = 0;
+    uint64_t transient_ = 0;
+    uint64_t alerts_ = 0;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef UpdateSink_h
+#define UpdateSink_h
+
+#include "ProcessInfo.h"
+#include "Alerts/AlertEngine.h"
+
+// A consumer of the collector's output when there is no window to post to.
+//
+// Calls arrive on the monitor's tick thread, one tick at a time, in the order
+// ticks were published: alerts first, then the diff. They hold up the next
+// tick, so a sink that writes to disk or the network copies what it needs
+// and hands it to its own thread.
+class UpdateSink {
+public:
+    virtual ~UpdateSink() = default;
+
+    // One tick's diff; never empty. Only valid for the duration of the call.
+    virtual void onUpdate(const ProcessUpdateData &update) = 0;
+
+    virtual void onAlert(const AlertEvent &) {}
+
+    // After the last onUpdate: flush and release. Called from the thread
+    // that stops the collector.
+    virtual void close() {}
+};
+
+#endif
@@ -0,0 +1,313 @@
+#include "ColumnarCodec.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "TextEncoding.h"
+
+namespace columnar {
+    namespace {
+        // One fixed-width column, zero-padded to 8 bytes.
+        template<typename T, typename Items, typename Get>
+        void appendColumn(std::string &out, const Items &items, Get get) {
+            const size_t start = out.size();
+            out.resize(start + align8(items.size() * sizeof(T)));
+            char *cursor = out.data() + start;
+            for (const auto &item: items) {
+                const T value = get(item);
+                std::memcpy(cursor, &value, sizeof(T));
+                cursor += sizeof(T);
+            }
+        }
+
+        // Offsets, then the concatenated bytes.
+        void appendStringColumn(std::string &out, const std::vector<Row> &rows, std::string Row::*field) {
+            const size_t offsetsAt = out.size();
+            out.resize(offsetsAt + align8((rows.size() + 1) * sizeof(uint32_t)));
+            uint32_t offset = 0;
+            for (size_t i = 0; i <= rows.size(); ++i) {
+                std::memcpy(out.data() + offsetsAt + i * sizeof(uint32_t), &offset, sizeof(offset));
+                if (i < rows.size()) {
+                    offset += static_cast<uint32_t>((rows[i].*field).size());
+                }
+            }
+
+            const size_t start = out.size();
+            out.resize(start + align8(offset));
+            char *cursor = out.data() + start;
+            for (const Row &row: rows) {
+                const std::string &text = row.*field;
+                std::memcpy(cursor, text.data(), text.size());
+                cursor += text.size();
+            }
+        }
+
+        void appendProcessColumns(std::string &out, const std::vector<Row> &rows) {
+            appendColumn<uint32_t>(out, rows, [](const Row &row) { return static_cast<uint32_t>(row.pid); });
+            appendColumn<uint32_t>(out, rows, [](const Row &row) { return static_cast<uint32_t>(row.parentPid); });
+            appendColumn<double>(out, rows, [](const Row &row) { return row.cpu; });
+            appendColumn<uint64_t>(out, rows, [](const Row &row) { return row.ram; });
+            appendColumn<double>(out, rows, [](const Row &row) { return row.io; });
+            appendStringColumn(out, rows, &Row::name);
+            appendStringColumn(out, rows, &Row::path);
+            appendStringColumn(out, rows, &Row::commandLine);
+        }
+
+        // A table frame has the same layout as a diff, with the table as
+        // `added` and the other sections empty.
+        void encode(std::string &out, const FrameInfo &frame, const FrameKind kind, const ProcessUpdateData &update,
+                    const std::vector<Row> &added, const std::vector<Row> &transient) {
+            const size_t start = out.size();
+            out.resize(start + sizeof(FrameHeader));
+
+            const auto &updated = update.updated;
+            appendColumn<uint32_t>(out, update.removed_pids, [](const DWORD pid) { return static_cast<uint32_t>(pid); });
+            appendProcessColumns(out, added);
+            appendColumn<uint32_t>(out, updated, [](const ProcessDelta &d) { return static_cast<uint32_t>(d.pid); });
+            appendColumn<uint8_t>(out, updated, [](const ProcessDelta &d) { return d.changed; });
+            appendColumn<double>(out, updated, [](const ProcessDelta &d) {
+                return d.changed & ProcessDelta::Cpu ? d.cpuUsage : 0.0;
+            });
+            appendColumn<uint64_t>(out, updated, [](const ProcessDelta &d) {
+                return d.changed & ProcessDelta::Ram ? static_cast<uint64_t>(d.ramUsage) : uint64_t{0};
+            });
+            appendColumn<double>(out, updated, [](const ProcessDelta &d) {
+                return d.changed & ProcessDelta::Io ? d.ioRate : 0.0;
+            });
+            appendProcessColumns(out, transient);
+
+            FrameHeader header{};
+            header.magic = FrameMagic;
+            header.version = FormatVersion;
+            header.kind = kind;
+            header.headerBytes = sizeof(FrameHeader);
+            header.frameBytes = out.size() - start;
+            header.tick = frame.tick;
+            header.timestamp = frame.timestamp;
+            header.mergedTicks = frame.merged;
+            header.droppedTicks = frame.dropped;
+            header.addedCount = static_cast<uint32_t>(added.size());
+            header.removedCount = static_cast<uint32_t>(update.removed_pids.size());
+            header.updatedCount = static_cast<uint32_t>(updated.size());
+            header.transientCount = static_cast<uint32_t>(transient.size());
+            std::memcpy(out.data() + start, &header, sizeof(header));
+        }
+
+        // Bounds-checked walk over a frame's columns.
+        class Reader {
+        public:
+            explicit Reader(const std::string_view data) : data_(data) {}
+
+            // Calls each(i, value) for n values of T.
+            template<typename T, typename Each>
+            bool column(const size_t n, Each each) {
+                const char *values = take(align8(n * sizeof(T)));
+                if (!values) {
+                    return false;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    T value;
+                    std::memcpy(&value, values + i * sizeof(T), sizeof(T));
+                    each(i, value);
+                }
+                return true;
+            }
+
+            // column<double>, rejecting NaN and infinities: rankings order by
+            // these values and cannot hold one that compares false to all.
+            template<typename Each>
+            bool finiteColumn(const size_t n, Each each) {
+                bool finite = true;
+                return column<double>(n, [&](const size_t i, const double value) {
+                           finite = finite && std::isfinite(value);
+                           each(i, value);
+                       }) &&
+                       finite;
+            }
+
+            // Calls each(i, text) for n strings; each returns false to reject.
+            template<typename Each>
+            bool strings(const size_t n, Each each) {
+                const char *offsets = take(align8((n + 1) * sizeof(uint32_t)));
+                if (!offsets) {
+                    return false;
+                }
+                const auto offsetAt = [offsets](const size_t i) {
+                    uint32_t offset;
+                    std::memcpy(&offset, offsets + i * sizeof(uint32_t), sizeof(offset));
+                    return offset;
+                };
+                const uint32_t total = offsetAt(n);
+                const char *bytes = take(align8(total));
+                if (!bytes || offsetAt(0) != 0) {
+                    return false;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    const uint32_t begin = offsetAt(i);
+                    const uint32_t end = offsetAt(i + 1);
+                    if (end < begin || end > total || !each(i, std::string_view(bytes + begin, end - begin))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        private:
+            const char *take(const size_t bytes) {
+                if (bytes > data_.size() - offset_) {
+                    return nullptr;
+                }
+                const char *at = data_.data() + offset_;
+                offset_ += bytes;
+                return at;
+            }
+
+            std::string_view data_;
+            size_t offset_ = 0;
+        };
+
+        bool readProcesses(Reader &reader, const size_t n, std::vector<ProcessInfo> &out) {
+            out.resize(n);
+            return reader.column<uint32_t>(n, [&](const size_t i, const uint32_t v) { out[i].pid = v; }) &&
+                   reader.column<uint32_t>(n, [&](const size_t i, const uint32_t v) { out[i].parentPid = v; }) &&
+                   reader.finiteColumn(n, [&](const size_t i, const double v) { out[i].cpuUsage = v; }) &&
+                   reader.column<uint64_t>(n, [&](const size_t i, const uint64_t v) {
+                       out[i].ramUsage = static_cast<SIZE_T>(v);
+                   }) &&
+                   reader.finiteColumn(n, [&](const size_t i, const double v) { out[i].ioRate = v; }) &&
+                   reader.strings(n, [&](const size_t i, const std::string_view s) {
+                       return assignUtf16(out[i].name, s);
+                   }) &&
+                   reader.strings(n, [&](const size_t i, const std::string_view s) {
+                       return assignUtf16(out[i].path, s);
+                   }) &&
+                   reader.strings(n, [&](const size_t i, const std::string_view s) {
+                       return assignUtf16(out[i].commandLine, s);
+                   });
+        }
+    }
+
+    void toRow(const ProcessInfo &info, Row &row) {
+        row.pid = info.pid;
+        row.parentPid = info.parentPid;
+        row.name.clear();
+        appendUtf8(row.name, info.name);
+        row.path.clear();
+        appendUtf8(row.path, info.path);
+        row.commandLine.clear();
+        appendUtf8(row.commandLine, info.commandLine);
+        row.cpu = info.cpuUsage;
+        row.ram = info.ramUsage;
+        row.io = info.ioRate;
+    }
+
+    void toRows(const std::vector<ProcessInfo> &infos, std::vector<Row> &rows) {
+        rows.resize(infos.size());
+        for (size_t i = 0; i < infos.size(); ++i) {
+            toRow(infos[i], rows[i]);
+        }
+    }
+
+    void RowTable::apply(const ProcessUpdateData &update) {
+        for (const DWORD pid: update.removed_pids) {
+            const auto it = index_.find(pid);
+            if (it == index_.end()) {
+                continue;
+            }
+            const size_t slot = it->second;
+            index_.erase(it);
+            if (slot != rows_.size() - 1) {
+                rows_[slot] = std::move(rows_.back());
+                index_[rows_[slot].pid] = slot;
+            }
+            rows_.pop_back();
+        }
+        for (const ProcessInfo &info: update.added) {
+            const auto [it, inserted] = index_.try_emplace(info.pid, rows_.size());
+            if (inserted) {
+                rows_.emplace_back();
+            }
+            toRow(info, rows_[it->second]);
+        }
+        for (const ProcessDelta &delta: update.updated) {
+            const auto it = index_.find(delta.pid);
+            if (it == index_.end()) {
+                continue;
+            }
+            Row &row = rows_[it->second];
+            if (delta.changed & ProcessDelta::Cpu) {
+                row.cpu = delta.cpuUsage;
+            }
+            if (delta.changed & ProcessDelta::Ram) {
+                row.ram = delta.ramUsage;
+            }
+            if (delta.changed & ProcessDelta::Io) {
+                row.io = delta.ioRate;
+            }
+        }
+    }
+
+    void encodeDiff(std::string &out, const FrameInfo &frame, const ProcessUpdateData &update,
+                    const std::vector<Row> &added, const std::vector<Row> &transient) {
+        encode(out, frame, FrameDiff, update, added, transient);
+    }
+
+    void encodeTable(std::string &out, const FrameInfo &frame, const std::vector<Row> &rows) {
+        static const ProcessUpdateData none;
+        static const std::vector<Row> noRows;
+        encode(out, frame, FrameTable, none, rows, noRows);
+    }
+
+    Peek peekFrame(const std::string_view data, const uint64_t maxFrameBytes, FrameHeader &header) {
+        if (data.size() < sizeof(FrameHeader)) {
+            return Peek::NeedMore;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.magic != FrameMagic || header.version != FormatVersion ||
+            (header.kind != FrameDiff && header.kind != FrameTable) ||
+            header.headerBytes < sizeof(FrameHeader) || header.headerBytes % 8 != 0 ||
+            header.frameBytes < header.headerBytes || header.frameBytes % 8 != 0 ||
+            header.frameBytes > maxFrameBytes) {
+            return Peek::Invalid;
+        }
+        return data.size() < header.frameBytes ? Peek::NeedMore : Peek::Ready;
+    }
+
+    bool decodeFrame(const std::string_view data, const FrameHeader &header, ProcessUpdateData &out) {
+        // Counts come off the wire: check they can fit before sizing anything.
+        constexpr uint64_t ProcessBytes = 4 + 4 + 8 + 8 + 8 + 3 * 4;  // columns plus string offsets
+        constexpr uint64_t DeltaBytes = 4 + 1 + 8 + 8 + 8;
+        const uint64_t body = header.frameBytes - header.headerBytes;
+        if (uint64_t{header.removedCount} * 4 + uint64_t{header.updatedCount} * DeltaBytes +
+            (uint64_t{header.addedCount} + header.transientCount) * ProcessBytes > body) {
+            return false;
+        }
+
+        Reader reader(data.substr(header.headerBytes, body));
+
+        out.removed_pids.resize(header.removedCount);
+        out.updated.resize(header.updatedCount);
+        auto &updated = out.updated;
+        return reader.column<uint32_t>(header.removedCount, [&](const size_t i, const uint32_t pid) {
+                   out.removed_pids[i] = pid;
+               }) &&
+               readProcesses(reader, header.addedCount, out.added) &&
+               reader.column<uint32_t>(updated.size(), [&](const size_t i, const uint32_t v) {
+                   updated[i] = ProcessDelta{};
+                   updated[i].pid = v;
+               }) &&
+               reader.column<uint8_t>(updated.size(), [&](const size_t i, const uint8_t v) {
+                   updated[i].changed = v;
+               }) &&
+               reader.finiteColumn(updated.size(), [&](const size_t i, const double v) {
+                   updated[i].cpuUsage = v;
+               }) &&
+               reader.column<uint64_t>(updated.size(), [&](const size_t i, const uint64_t v) {
+                   updated[i].ramUsage = static_cast<SIZE_T>(v);
+               }) &&
+               reader.finiteColumn(updated.size(), [&](const size_t i, const double v) {
+                   updated[i].ioRate = v;
+               }) &&
+               readProcesses(reader, header.transientCount, out.transient);
+    }
+}
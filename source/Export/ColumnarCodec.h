@@ -0,0 +1,72 @@
+#ifndef ColumnarCodec_h
+#define ColumnarCodec_h
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ColumnarFormat.h"
+#include "ProcessInfo.h"
+
+// Writing and reading ColumnarFormat frames; shared by the stream exporter
+// and the fleet agent and aggregator.
+namespace columnar {
+    // One process in UTF-8, converted once when it is added.
+    struct Row {
+        DWORD pid = 0;
+        DWORD parentPid = 0;
+        std::string name;
+        std::string path;
+        std::string commandLine;
+        double cpu = 0.0;
+        uint64_t ram = 0;
+        double io = 0.0;
+    };
+
+    void toRow(const ProcessInfo &info, Row &row);
+    // Reuses the strings already in `rows` from earlier ticks.
+    void toRows(const std::vector<ProcessInfo> &infos, std::vector<Row> &rows);
+
+    // The whole table as rows, kept current from diffs, for table frames.
+    // Rows are unordered: removal moves the last row into the hole.
+    class RowTable {
+    public:
+        void apply(const ProcessUpdateData &update);
+        [[nodiscard]] const std::vector<Row> &rows() const { return rows_; }
+
+    private:
+        std::vector<Row> rows_;
+        std::unordered_map<DWORD, size_t> index_;
+    };
+
+    struct FrameInfo {
+        uint64_t tick;
+        int64_t timestamp;  // FILETIME
+        uint32_t merged = 1;
+        uint32_t dropped = 0;
+    };
+
+    // Appends a diff frame: `update` with its added and transient processes
+    // already converted to rows.
+    void encodeDiff(std::string &out, const FrameInfo &frame, const ProcessUpdateData &update,
+                    const std::vector<Row> &added, const std::vector<Row> &transient);
+    void encodeTable(std::string &out, const FrameInfo &frame, const std::vector<Row> &rows);
+
+    enum class Peek { NeedMore, Ready, Invalid };
+
+    // Whether `data` starts with a whole frame of at most maxFrameBytes; with
+    // Ready, `header` holds its header. Invalid means the stream is not a
+    // frame stream (or is a newer version) and cannot be resynchronized.
+    Peek peekFrame(std::string_view data, uint64_t maxFrameBytes, FrameHeader &header);
+
+    // Decodes the frame peekFrame() found into `out` (cleared first; a table
+    // frame's rows land in `added`). False if any column runs past the frame,
+    // a string is malformed or a CPU or I/O value is not finite; the input is
+    // untrusted.
+    bool decodeFrame(std::string_view data, const FrameHeader &header, ProcessUpdateData &out);
+}
+
+#endif
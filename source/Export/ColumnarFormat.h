@@ -0,0 +1,61 @@
+#ifndef ColumnarFormat_h
+#define ColumnarFormat_h
+
+#include <cstdint>
+
+// Wire layout of StreamExportSink's binary frames, for bulk loaders.
+//
+// A stream is back-to-back frames with no stream header, so a reader can start
+// at any frame boundary and a truncated file loses at most its last frame. All
+// integers are little-endian; every column starts on an 8-byte boundary.
+//
+//   FrameHeader
+//   uint32_t removed[removedCount]
+//   process columns x addedCount     (FrameTable: the whole table)
+//   uint32_t updatedPid[updatedCount]
+//   uint8_t  updatedFields[updatedCount]   (ProcessDelta::Field bits)
+//   double   updatedCpu[updatedCount]      (0 unless the Cpu bit is set)
+//   uint64_t updatedRam[updatedCount]
+//   double   updatedIo[updatedCount]
+//   process columns x transientCount
+//
+// Process columns are
+//
+//   uint32_t pid[n], uint32_t parentPid[n], double cpu[n], uint64_t ram[n],
+//   double io[n], then name, path and command line, each as
+//   uint32_t offset[n + 1] followed by offset[n] bytes of UTF-8.
+//
+// Apply a diff frame as removed, then added, then updated: a reused PID is
+// both removed and added in one frame.
+namespace columnar {
+    constexpr uint32_t FrameMagic = 0x46434c50;  // "PLCF"
+    constexpr uint16_t FormatVersion = 1;
+
+    enum FrameKind : uint16_t {
+        FrameDiff = 0,
+        FrameTable = 1,
+    };
+
+    struct FrameHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t kind;
+        uint32_t headerBytes;
+        uint32_t reserved;
+        uint64_t frameBytes;    // including this header and trailing padding
+        uint64_t tick;          // last tick the frame covers, counted from 1
+        int64_t timestamp;      // FILETIME, 100 ns since 1601
+        uint32_t mergedTicks;   // ticks folded into this diff (1 unless the writer fell behind)
+        uint32_t droppedTicks;  // ticks skipped since the previous frame
+        uint32_t addedCount;
+        uint32_t removedCount;
+        uint32_t updatedCount;
+        uint32_t transientCount;
+    };
+
+    static_assert(sizeof(FrameHeader) % 8 == 0);
+
+    constexpr size_t align8(const size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+}
+
+#endif
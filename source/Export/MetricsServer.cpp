@@ -0,0 +1,323 @@
+#include "MetricsServer.h"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#include <windows.h>
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+
+#include "TextEncoding.h"
+
+namespace {
+    constexpr std::chrono::milliseconds PollInterval{250};  // bounds how long stop() waits
+
+    SOCKET toSocket(const uintptr_t socket) {
+        return static_cast<SOCKET>(socket);
+    }
+
+    bool setNonBlocking(const SOCKET socket) {
+        u_long enabled = 1;
+        return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+    }
+
+    bool wouldBlock() {
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+
+    int hexValue(const char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    std::string percentDecode(const std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '+') {
+                out += ' ';
+            } else if (text[i] == '%' && i + 2 < text.size() &&
+                       hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+                out += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                i += 2;
+            } else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+}
+
+MetricsServer::MetricsServer(PayloadProvider provider) : provider_(std::move(provider)) {
+    WSADATA data;
+    winsock_ready_ = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    if (!winsock_ready_) {
+        std::cerr << "MetricsServer: WSAStartup failed" << std::endl;
+    }
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+    if (winsock_ready_) {
+        WSACleanup();
+    }
+}
+
+bool MetricsServer::listenTcp(const uint16_t port) {
+    stop();
+    if (!winsock_ready_) {
+        return false;
+    }
+    const SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        std::cerr << "MetricsServer: socket failed. Error: " << WSAGetLastError() << std::endl;
+        return false;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    int length = sizeof(address);
+    if (bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+        std::cerr << "MetricsServer: cannot bind 127.0.0.1:" << port << ". Error: " << WSAGetLastError()
+                  << std::endl;
+        closesocket(listener);
+        return false;
+    }
+    port_ = ntohs(address.sin_port);
+    return start(static_cast<uintptr_t>(listener));
+}
+
+bool MetricsServer::listenUnix(const std::wstring &path) {
+    stop();
+    if (!winsock_ready_) {
+        return false;
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string narrow = toUtf8(path);
+    if (narrow.empty() || narrow.size() >= sizeof(address.sun_path)) {
+        std::cerr << "MetricsServer: socket path is empty or too long" << std::endl;
+        return false;
+    }
+    std::copy(narrow.begin(), narrow.end(), address.sun_path);
+
+    const SOCKET listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET) {
+        std::cerr << "MetricsServer: AF_UNIX is not available. Error: " << WSAGetLastError() << std::endl;
+        return false;
+    }
+    DeleteFileW(path.c_str());
+    if (bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        std::cerr << "MetricsServer: cannot bind " << narrow << ". Error: " << WSAGetLastError() << std::endl;
+        closesocket(listener);
+        return false;
+    }
+    if (!start(static_cast<uintptr_t>(listener))) {
+        DeleteFileW(path.c_str());
+        return false;
+    }
+    unix_path_ = path;
+    return true;
+}
+
+bool MetricsServer::start(const uintptr_t listener) {
+    if (listen(toSocket(listener), SOMAXCONN) != 0 || !setNonBlocking(toSocket(listener))) {
+        std::cerr << "MetricsServer: listen failed. Error: " << WSAGetLastError() << std::endl;
+        closesocket(toSocket(listener));
+        return false;
+    }
+    listener_ = listener;
+    thread_ = std::jthread([this](const std::stop_token &st) { run(st); });
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+    for (const Connection &connection: connections_) {
+        closesocket(toSocket(connection.socket));
+    }
+    connections_.clear();
+    if (toSocket(listener_) != INVALID_SOCKET) {
+        closesocket(toSocket(listener_));
+        listener_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    }
+    if (!unix_path_.empty()) {
+        DeleteFileW(unix_path_.c_str());
+        unix_path_.clear();
+    }
+}
+
+void MetricsServer::addRoute(std::string path, RouteHandler handler) {
+    routes_.emplace_back(std::move(path), std::move(handler));
+}
+
+std::string MetricsServer::queryParameter(std::string_view query, const std::string_view name) {
+    while (!query.empty()) {
+        const size_t end = std::min(query.find('&'), query.size());
+        const std::string_view pair = query.substr(0, end);
+        const size_t equals = pair.find('=');
+        if (pair.substr(0, equals) == name) {
+            return equals == std::string_view::npos ? std::string() : percentDecode(pair.substr(equals + 1));
+        }
+        query.remove_prefix(std::min(end + 1, query.size()));
+    }
+    return {};
+}
+
+void MetricsServer::run(const std::stop_token &st) {
+    std::vector<WSAPOLLFD> fds;
+    while (!st.stop_requested()) {
+        fds.clear();
+        fds.push_back(WSAPOLLFD{toSocket(listener_), static_cast<SHORT>(
+                                    connections_.size() < MaxConnections ? POLLRDNORM : 0), 0});
+        for (const Connection &connection: connections_) {
+            fds.push_back(WSAPOLLFD{toSocket(connection.socket),
+                                    static_cast<SHORT>(connection.body ? POLLWRNORM : POLLRDNORM), 0});
+        }
+
+        const int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), static_cast<INT>(PollInterval.count()));
+        if (ready == SOCKET_ERROR) {
+            std::cerr << "MetricsServer: WSAPoll failed. Error: " << WSAGetLastError() << std::endl;
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        // Connections accepted below are not in `fds` yet; only walk the polled ones.
+        const size_t polled = connections_.size();
+        size_t kept = 0;
+        for (size_t i = 0; i < polled; ++i) {
+            Connection &connection = connections_[i];
+            const SHORT events = fds[i + 1].revents;
+            bool open = now - connection.since < IdleTimeout;
+            if (open && (events & (POLLERR | POLLNVAL))) {
+                open = false;
+            } else if (open && (events & (POLLRDNORM | POLLHUP)) && !connection.body) {
+                open = readRequest(connection);
+            } else if (open && (events & POLLWRNORM)) {
+                open = writeResponse(connection);
+            }
+            if (!open) {
+                closesocket(toSocket(connection.socket));
+                continue;
+            }
+            if (kept != i) {
+                connections_[kept] = std::move(connection);
+            }
+            ++kept;
+        }
+        connections_.resize(kept);
+
+        if (fds[0].revents & POLLRDNORM) {
+            acceptConnections();
+        }
+    }
+}
+
+void MetricsServer::acceptConnections() {
+    while (connections_.size() < MaxConnections) {
+        const SOCKET socket = accept(toSocket(listener_), nullptr, nullptr);
+        if (socket == INVALID_SOCKET) {
+            return;  // WSAEWOULDBLOCK: drained
+        }
+        if (!setNonBlocking(socket)) {
+            closesocket(socket);
+            continue;
+        }
+        connections_.push_back(Connection{static_cast<uintptr_t>(socket), {}, {}, nullptr, 0,
+                                          std::chrono::steady_clock::now()});
+    }
+}
+
+// False closes the connection.
+bool MetricsServer::readRequest(Connection &connection) {
+    char buffer[1024];
+    const int received = recv(toSocket(connection.socket), buffer, static_cast<int>(sizeof(buffer)), 0);
+    if (received == 0 || (received == SOCKET_ERROR && !wouldBlock())) {
+        return false;
+    }
+    if (received > 0) {
+        connection.request.append(buffer, received);
+    }
+    if (connection.request.find("\r\n\r\n") == std::string::npos) {
+        return connection.request.size() <= MaxRequestBytes;
+    }
+    respond(connection);
+    return writeResponse(connection);  // usually completes without another poll
+}
+
+void MetricsServer::respond(Connection &connection) {
+    const std::string_view request = connection.request;
+    const std::string_view line = request.substr(0, request.find("\r\n"));
+    const bool get = line.starts_with("GET ");
+    const std::string_view target = get ? line.substr(4, line.find(' ', 4) - 4) : std::string_view{};
+    const size_t question = target.find('?');
+    const std::string_view path = target.substr(0, question);
+    const std::string_view query = question == std::string_view::npos ? std::string_view{}
+                                                                       : target.substr(question + 1);
+    const auto route = std::find_if(routes_.begin(), routes_.end(),
+                                    [path](const auto &entry) { return entry.first == path; });
+
+    if (get && provider_ && (path == "/metrics" || path == "/")) {
+        connection.body = provider_();
+        connection.header = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n";
+    } else if (get && route != routes_.end()) {
+        RouteResponse response = route->second(query);
+        connection.body = response.body ? std::move(response.body) : std::make_shared<const std::string>();
+        connection.header = response.ok ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 400 Bad Request\r\n";
+        connection.header += "Content-Type: text/plain; charset=utf-8\r\n";
+    } else {
+        static const Payload notFound = std::make_shared<const std::string>("Not found; try /metrics\n");
+        connection.body = notFound;
+        connection.header = get ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\n";
+        connection.header += "Content-Type: text/plain; charset=utf-8\r\n";
+    }
+    connection.header += "Content-Length: " + std::to_string(connection.body->size()) +
+                         "\r\nConnection: close\r\n\r\n";
+    connection.request.clear();
+    served_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Header and body go out in one gathered send, resuming where a partial
+// send stopped. False closes the connection (done or failed).
+bool MetricsServer::writeResponse(Connection &connection) {
+    const size_t total = connection.header.size() + connection.body->size();
+    while (connection.sent < total) {
+        WSABUF buffers[2];
+        DWORD count = 0;
+        if (connection.sent < connection.header.size()) {
+            buffers[count].buf = connection.header.data() + connection.sent;
+            buffers[count++].len = static_cast<ULONG>(connection.header.size() - connection.sent);
+        }
+        const size_t bodyOffset = connection.sent > connection.header.size()
+                                      ? connection.sent - connection.header.size()
+                                      : 0;
+        if (bodyOffset < connection.body->size()) {
+            buffers[count].buf = const_cast<char *>(connection.body->data() + bodyOffset);
+            buffers[count++].len = static_cast<ULONG>(connection.body->size() - bodyOffset);
+        }
+
+        DWORD sent = 0;
+        if (WSASend(toSocket(connection.socket), buffers, count, &sent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+            return wouldBlock();
+        }
+        connection.sent += sent;
+    }
+    shutdown(toSocket(connection.socket), SD_SEND);
+    return false;
+}
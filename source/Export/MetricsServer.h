@@ -0,0 +1,93 @@
+#ifndef MetricsServer_h
+#define MetricsServer_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A minimal HTTP/1.1 server for local scrapers: GET /metrics (or /) answers
+// with whatever body the provider returns, as OpenMetrics text; anything else
+// is a 404. Further GET paths can be routed to handlers that answer with
+// plain text. One thread multiplexes every connection with WSAPoll.
+//
+// The provider is called once per request and must be cheap and lock-light
+// (OpenMetricsSink::payload copies a shared_ptr). The body is sent straight
+// from the shared buffer with a gathered WSASend, never copied, and the
+// connection is closed after the response.
+//
+// Listens on loopback TCP or on an AF_UNIX socket (Windows 10 1803+); never
+// on an external interface.
+class MetricsServer {
+public:
+    using Payload = std::shared_ptr<const std::string>;
+    using PayloadProvider = std::function<Payload()>;
+    struct RouteResponse {
+        Payload body;
+        bool ok = true;  // false: a 400, with the reason as the body
+    };
+    // Called with the raw query string, after the '?'; may be empty.
+    using RouteHandler = std::function<RouteResponse(std::string_view query)>;
+
+    // An empty provider leaves /metrics a 404.
+    explicit MetricsServer(PayloadProvider provider);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // 127.0.0.1:port; port 0 picks a free one (see port()). False, with the
+    // reason on std::cerr, if the socket cannot be set up. Either call
+    // replaces the previous listener.
+    bool listenTcp(uint16_t port);
+    // Replaces a stale socket file at `path`.
+    bool listenUnix(const std::wstring &path);
+    void stop();
+
+    // Before listening; handlers run on the server thread, one at a time.
+    void addRoute(std::string path, RouteHandler handler);
+    // The percent-decoded value of `name` in a query string, or empty.
+    static std::string queryParameter(std::string_view query, std::string_view name);
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+    [[nodiscard]] uint64_t requestsServed() const { return served_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MaxConnections = 64;
+    static constexpr size_t MaxRequestBytes = 8 * 1024;
+    static constexpr std::chrono::seconds IdleTimeout{10};
+
+    struct Connection {
+        uintptr_t socket;
+        std::string request;
+        std::string header;
+        Payload body;        // null while the request is still being read
+        size_t sent = 0;     // bytes of header + body written so far
+        std::chrono::steady_clock::time_point since;
+    };
+
+    bool start(uintptr_t listener);
+    void run(const std::stop_token &st);
+    void acceptConnections();
+    bool readRequest(Connection &connection);
+    bool writeResponse(Connection &connection);
+    void respond(Connection &connection);
+
+    PayloadProvider provider_;
+    std::vector<std::pair<std::string, RouteHandler>> routes_;
+    bool winsock_ready_ = false;
+    uintptr_t listener_ = ~uintptr_t{0};  // INVALID_SOCKET
+    uint16_t port_ = 0;
+    std::wstring unix_path_;
+    std::vector<Connection> connections_;  // owned by the server thread
+    std::atomic<uint64_t> served_{0};
+    std::jthread thread_;
+};
+
+#endif
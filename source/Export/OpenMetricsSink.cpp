@@ -0,0 +1,209 @@
+#include "OpenMetricsSink.h"
+
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+
+#include "TextEncoding.h"
+#include "Concurrency/Scheduler.h"
+#include "Concurrency/ThreadPool.h"
+#include "Daemon/Collector.h"
+
+namespace {
+    // OpenMetrics spells the non-finite values NaN, +Inf and -Inf, where
+    // to_chars writes nan and inf.
+    void appendNumber(std::string &out, const double value) {
+        if (std::isnan(value)) {
+            out += "NaN";
+            return;
+        }
+        if (std::isinf(value)) {
+            out += value > 0 ? "+Inf" : "-Inf";
+            return;
+        }
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void appendNumber(std::string &out, const uint64_t value) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    // Label values escape backslash, double quote and newline.
+    std::string labelsFor(const ProcessInfo &info) {
+        std::string labels = "{pid=\"";
+        appendNumber(labels, static_cast<uint64_t>(info.pid));
+        labels += "\",name=\"";
+        for (const char c: toUtf8(info.name)) {
+            switch (c) {
+                case '\\': labels += "\\\\"; break;
+                case '"': labels += "\\\""; break;
+                case '\n': labels += "\\n"; break;
+                default: labels += c;
+            }
+        }
+        labels += "\"}";
+        return labels;
+    }
+
+    void appendFamily(std::string &out, const std::string_view name, const std::string_view type,
+                      const std::string_view help) {
+        out += "# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += "\n# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += '\n';
+    }
+
+    template<typename T>
+    void appendSample(std::string &out, const std::string_view name, const T value) {
+        out += name;
+        out += ' ';
+        appendNumber(out, value);
+        out += '\n';
+    }
+
+    template<typename T>
+    void appendGauge(std::string &out, const std::string_view name, const std::string_view help, const T value) {
+        appendFamily(out, name, "gauge", help);
+        appendSample(out, name, value);
+    }
+
+    // OpenMetrics names the family without the _total suffix its sample carries.
+    template<typename T>
+    void appendCounter(std::string &out, const std::string_view name, const std::string_view help, const T value) {
+        appendFamily(out, name, "counter", help);
+        out += name;
+        out += "_total ";
+        appendNumber(out, value);
+        out += '\n';
+    }
+}
+
+OpenMetricsSink::OpenMetricsSink(const Collector &collector)
+    : collector_(collector), payload_(std::make_shared<const std::string>("# EOF\n")) {}
+
+void OpenMetricsSink::onUpdate(const ProcessUpdateData &update) {
+    apply(update);
+    render();
+}
+
+OpenMetricsSink::Payload OpenMetricsSink::payload() const {
+    std::lock_guard lock(payload_mutex_);
+    return payload_;
+}
+
+void OpenMetricsSink::apply(const ProcessUpdateData &update) {
+    for (const DWORD pid: update.removed_pids) {
+        const auto it = index_.find(pid);
+        if (it == index_.end()) {
+            continue;
+        }
+        const size_t slot = it->second;
+        index_.erase(it);
+        if (slot != rows_.size() - 1) {
+            rows_[slot] = std::move(rows_.back());
+            index_[rows_[slot].pid] = slot;
+        }
+        rows_.pop_back();
+    }
+
+    for (const ProcessInfo &info: update.added) {
+        Row row{info.pid, labelsFor(info), info.cpuUsage, static_cast<double>(info.ramUsage), info.ioRate};
+        if (const auto [it, inserted] = index_.try_emplace(info.pid, rows_.size()); !inserted) {
+            rows_[it->second] = std::move(row);
+        } else {
+            rows_.push_back(std::move(row));
+        }
+    }
+
+    for (const ProcessDelta &delta: update.updated) {
+        const auto it = index_.find(delta.pid);
+        if (it == index_.end()) {
+            continue;
+        }
+        Row &row = rows_[it->second];
+        if (delta.changed & ProcessDelta::Cpu) {
+            row.cpu = delta.cpuUsage;
+        }
+        if (delta.changed & ProcessDelta::Ram) {
+            row.ram = static_cast<double>(delta.ramUsage);
+        }
+        if (delta.changed & ProcessDelta::Io) {
+            row.io = delta.ioRate;
+        }
+    }
+}
+
+void OpenMetricsSink::render() {
+    const auto started = std::chrono::steady_clock::now();
+
+    std::shared_ptr<std::string> &slot = buffers_[next_buffer_];
+    if (!slot || slot.use_count() != 1) {
+        slot = std::make_shared<std::string>();  // first use, or a scraper still holds it
+    } else {
+        // Pairs with the release in the scraper's final shared_ptr decrement.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    std::string &out = *slot;
+    out.clear();
+
+    const auto perProcess = [&](const std::string_view name, const std::string_view help, double Row::*field) {
+        appendFamily(out, name, "gauge", help);
+        for (const Row &row: rows_) {
+            out += name;
+            out += row.labels;
+            out += ' ';
+            appendNumber(out, row.*field);
+            out += '\n';
+        }
+    };
+    perProcess("processlite_process_cpu_percent", "CPU usage, percent of all logical processors.", &Row::cpu);
+    perProcess("processlite_process_resident_bytes", "Working set size.", &Row::ram);
+    perProcess("processlite_process_io_bytes_per_second", "Read plus write transfer rate.", &Row::io);
+    appendGauge(out, "processlite_processes", "Processes in the table.", static_cast<uint64_t>(rows_.size()));
+
+    if (const ProcessMonitor *monitor = collector_.monitor()) {
+        if (const auto sample = monitor->getSystemSample()) {
+            appendGauge(out, "processlite_system_cpu_busy_percent", "Machine-wide CPU busy over the last tick.",
+                        sample->total.busy());
+            appendGauge(out, "processlite_system_context_switches_per_second", "Context switch rate.",
+                        sample->contextSwitchesPerSec);
+            appendGauge(out, "processlite_system_interrupts_per_second", "Interrupt rate.",
+                        sample->interruptsPerSec);
+        }
+    }
+    if (const Scheduler *scheduler = collector_.scheduler()) {
+        appendCounter(out, "processlite_scheduler_dispatched_tasks", "Task runs the scheduler queued.",
+                      scheduler->dispatchedTasks());
+        appendCounter(out, "processlite_scheduler_lateness_seconds", "Time tasks were queued after they were due.",
+                      std::chrono::duration<double>(scheduler->totalLateness()).count());
+    }
+    if (const ThreadPool *pool = collector_.threadPool()) {
+        appendGauge(out, "processlite_pool_workers", "Worker threads.", static_cast<uint64_t>(pool->workerCount()));
+        appendGauge(out, "processlite_pool_busy_workers", "Workers running a task.",
+                    static_cast<uint64_t>(pool->busyWorkers()));
+        appendGauge(out, "processlite_pool_queued_tasks", "Tasks waiting for a worker.",
+                    static_cast<uint64_t>(pool->queuedTasks()));
+        appendCounter(out, "processlite_pool_completed_tasks", "Tasks the workers finished.", pool->completedTasks());
+    }
+    appendCounter(out, "processlite_exporter_renders", "Expositions rendered.", ++renders_);
+    appendGauge(out, "processlite_exporter_render_seconds", "Time to render the previous exposition.",
+                last_render_.count());
+    out += "# EOF\n";
+
+    {
+        std::lock_guard lock(payload_mutex_);
+        payload_ = slot;
+    }
+    next_buffer_ ^= 1;
+    last_render_ = std::chrono::steady_clock::now() - started;
+}
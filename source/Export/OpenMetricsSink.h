@@ -0,0 +1,65 @@
+#ifndef OpenMetricsSink_h
+#define OpenMetricsSink_h
+
+#include <windows.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Daemon/UpdateSink.h"
+
+class Collector;
+
+// Renders the collector's state as an OpenMetrics text exposition, once per
+// tick, for any number of scrapers to share.
+//
+// The sink keeps its own copy of the table, maintained from the diffs it is
+// given (the label set of each process is escaped once, when it is added),
+// so rendering reads neither the monitor's table nor its lock. Scheduler,
+// thread pool and machine-wide telemetry come from the collector.
+//
+// The body is rendered into one of two buffers and published by swapping a
+// shared_ptr under a small mutex. A scrape copies that pointer and sends from
+// it, so it never waits for rendering or for another scrape. The buffer a
+// tick renders into is the one published before last; if a slow scraper
+// still holds it, that tick renders into a fresh buffer instead.
+class OpenMetricsSink final : public UpdateSink {
+public:
+    using Payload = std::shared_ptr<const std::string>;
+
+    explicit OpenMetricsSink(const Collector &collector);
+
+    void onUpdate(const ProcessUpdateData &update) override;
+
+    // The latest body; an empty exposition ("# EOF") before the first tick.
+    // Safe from any thread.
+    [[nodiscard]] Payload payload() const;
+
+private:
+    struct Row {
+        DWORD pid;
+        std::string labels;  // {pid="..",name=".."}
+        double cpu;
+        double ram;
+        double io;
+    };
+
+    void apply(const ProcessUpdateData &update);
+    void render();
+
+    const Collector &collector_;
+    std::vector<Row> rows_;  // dense, so rendering walks contiguous memory
+    std::unordered_map<DWORD, size_t> index_;
+    std::shared_ptr<std::string> buffers_[2];
+    size_t next_buffer_ = 0;
+    std::chrono::duration<double> last_render_{0};
+    uint64_t renders_ = 0;
+
+    mutable std::mutex payload_mutex_;
+    Payload payload_;
+};
+
+#endif
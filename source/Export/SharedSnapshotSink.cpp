@@ -0,0 +1,197 @@
+#include "SharedSnapshotSink.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "TextEncoding.h"
+
+namespace {
+    constexpr uint64_t CacheLine = 64;
+
+    constexpr uint64_t roundToCacheLine(const uint64_t bytes) {
+        return (bytes + CacheLine - 1) / CacheLine * CacheLine;
+    }
+
+    plsnap_process rowFor(const ProcessInfo &info) {
+        plsnap_process row{};
+        row.pid = info.pid;
+        row.parentPid = info.parentPid;
+        row.cpu = info.cpuUsage;
+        row.ram = info.ramUsage;
+        row.io = info.ioRate;
+        const size_t length = std::min<size_t>(info.name.size(), PLSNAP_NAME_CHARS - 1);
+        std::copy_n(info.name.data(), length, row.name);
+        return row;
+    }
+
+    bool processRunning(const DWORD pid) {
+        if (pid == 0 || pid == GetCurrentProcessId()) {
+            return false;
+        }
+        const HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+        if (!process) {
+            return false;
+        }
+        const bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return running;
+    }
+}
+
+SharedSnapshotSink::SharedSnapshotSink(Options options) : options_(std::move(options)) {
+    static_assert(sizeof(plsnap_header) == CacheLine && sizeof(plsnap_slot) == CacheLine);
+
+    const uint64_t headerBytes = roundToCacheLine(sizeof(plsnap_header));
+    const uint64_t slotBytes = roundToCacheLine(sizeof(plsnap_slot) +
+                                                uint64_t{options_.capacity} * sizeof(plsnap_process));
+    const uint64_t regionBytes = headerBytes + 2 * slotBytes;
+
+    mapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(regionBytes >> 32), static_cast<DWORD>(regionBytes),
+                                  options_.name.c_str());
+    if (!mapping_) {
+        std::cerr << "SharedSnapshotSink: cannot create " << toUtf8(options_.name) << ". Error: "
+                  << GetLastError() << std::endl;
+        return;
+    }
+    // Readers can keep a region alive after its writer exits; a new writer
+    // takes it over, layout and sequences included, so they carry on.
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    auto *header = static_cast<plsnap_header *>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0));
+    if (!header) {
+        std::cerr << "SharedSnapshotSink: cannot map " << toUtf8(options_.name) << ". Error: " << GetLastError()
+                  << std::endl;
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+        return;
+    }
+
+    if (existed) {
+        const char *problem = nullptr;
+        if (header->magic != PLSNAP_MAGIC || header->version != PLSNAP_VERSION ||
+            header->rowBytes != sizeof(plsnap_process)) {
+            problem = "holds a different layout; close its readers first";
+        } else if (processRunning(static_cast<DWORD>(header->writerPid))) {
+            problem = "is being written by another process";
+        }
+        if (problem) {
+            std::cerr << "SharedSnapshotSink: " << toUtf8(options_.name) << " " << problem
+                      << " (writer PID " << header->writerPid << ")" << std::endl;
+            UnmapViewOfFile(header);
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+            return;
+        }
+        options_.capacity = header->capacity;
+    } else {
+        // A new mapping is zero-filled: both slots at sequence 0, empty.
+        header->magic = PLSNAP_MAGIC;
+        header->version = PLSNAP_VERSION;
+        header->headerBytes = static_cast<uint16_t>(headerBytes);
+        header->rowBytes = sizeof(plsnap_process);
+        header->capacity = options_.capacity;
+        header->slotBytes = slotBytes;
+        header->regionBytes = regionBytes;
+        InterlockedExchange64(&header->latest, -1);
+    }
+    InterlockedExchange(&header->writerPid, static_cast<LONG>(GetCurrentProcessId()));
+    header_ = header;
+    if (existed && header_->latest >= 0) {
+        ticks_ = slotAt(header_->latest & 1)->tick;  // so ticks keep counting up for readers
+    }
+}
+
+SharedSnapshotSink::~SharedSnapshotSink() {
+    close();
+}
+
+void SharedSnapshotSink::onUpdate(const ProcessUpdateData &update) {
+    if (!header_) {
+        return;
+    }
+    apply(update);
+    publish();
+}
+
+void SharedSnapshotSink::close() {
+    if (!header_) {
+        return;
+    }
+    InterlockedExchange(&header_->writerPid, 0);
+    UnmapViewOfFile(header_);
+    CloseHandle(mapping_);
+    header_ = nullptr;
+    mapping_ = nullptr;
+}
+
+void SharedSnapshotSink::apply(const ProcessUpdateData &update) {
+    for (const DWORD pid: update.removed_pids) {
+        const auto it = index_.find(pid);
+        if (it == index_.end()) {
+            continue;
+        }
+        const size_t slot = it->second;
+        index_.erase(it);
+        if (slot != rows_.size() - 1) {
+            rows_[slot] = rows_.back();
+            index_[rows_[slot].pid] = slot;
+        }
+        rows_.pop_back();
+    }
+
+    for (const ProcessInfo &info: update.added) {
+        if (const auto [it, inserted] = index_.try_emplace(info.pid, rows_.size()); !inserted) {
+            rows_[it->second] = rowFor(info);
+        } else {
+            rows_.push_back(rowFor(info));
+        }
+    }
+
+    for (const ProcessDelta &delta: update.updated) {
+        const auto it = index_.find(delta.pid);
+        if (it == index_.end()) {
+            continue;
+        }
+        plsnap_process &row = rows_[it->second];
+        if (delta.changed & ProcessDelta::Cpu) {
+            row.cpu = delta.cpuUsage;
+        }
+        if (delta.changed & ProcessDelta::Ram) {
+            row.ram = delta.ramUsage;
+        }
+        if (delta.changed & ProcessDelta::Io) {
+            row.io = delta.ioRate;
+        }
+    }
+}
+
+void SharedSnapshotSink::publish() {
+    // Readers are on `latest`; write the other slot.
+    const LONG64 latest = header_->latest;
+    const LONG64 index = latest < 0 ? 0 : (latest & 1) ^ 1;
+    plsnap_slot *slot = slotAt(index);
+
+    // The exchanges are full barriers: the odd sequence is visible before
+    // any row changes, and every row before the even one. A slot left odd by
+    // a writer that died mid-copy stays odd until it is written again.
+    const LONG64 writing = slot->sequence | 1;
+    InterlockedExchange64(&slot->sequence, writing);
+
+    const auto count = static_cast<uint32_t>(std::min<size_t>(rows_.size(), options_.capacity));
+    std::copy_n(rows_.data(), count, reinterpret_cast<plsnap_process *>(slot + 1));
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    slot->tick = ++ticks_;
+    slot->timestamp = static_cast<int64_t>(static_cast<uint64_t>(now.dwHighDateTime) << 32 | now.dwLowDateTime);
+    slot->count = count;
+    slot->total = static_cast<uint32_t>(rows_.size());
+
+    InterlockedExchange64(&slot->sequence, writing + 1);
+    InterlockedExchange64(&header_->latest, index);
+}
+
+plsnap_slot *SharedSnapshotSink::slotAt(const LONG64 index) const {
+    return reinterpret_cast<plsnap_slot *>(reinterpret_cast<char *>(header_) + header_->headerBytes +
+                                           index * header_->slotBytes);
+}
@@ -0,0 +1,55 @@
+#ifndef SharedSnapshotSink_h
+#define SharedSnapshotSink_h
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SnapshotRegion.h"
+#include "Daemon/UpdateSink.h"
+
+// Publishes the table after every tick into a named file mapping (see
+// SnapshotRegion.h), for readers on the same machine that want the whole
+// table without a socket, a parser or a lock.
+//
+// The sink keeps the table as ready-made plsnap_process rows, maintained from
+// the diffs, and copies them into the region's idle slot once per tick, so
+// publishing is one memcpy of the table bracketed by the slot's sequence
+// bumps. Rows past the slot capacity are left out; the slot's `total` says
+// how many there were.
+class SharedSnapshotSink final : public UpdateSink {
+public:
+    struct Options {
+        std::wstring name = PLSNAP_DEFAULT_NAME;  // Global\... for readers in other sessions
+        uint32_t capacity = 16384;                // rows per slot
+    };
+
+    explicit SharedSnapshotSink(Options options);
+    ~SharedSnapshotSink() override;
+
+    SharedSnapshotSink(const SharedSnapshotSink&) = delete;
+    SharedSnapshotSink& operator=(const SharedSnapshotSink&) = delete;
+
+    // False, with the reason on std::cerr, if the region could not be created.
+    [[nodiscard]] bool isOpen() const { return header_ != nullptr; }
+
+    void onUpdate(const ProcessUpdateData &update) override;
+    // Marks the region as having no writer; readers keep the last table.
+    void close() override;
+
+private:
+    void apply(const ProcessUpdateData &update);
+    void publish();
+    [[nodiscard]] plsnap_slot *slotAt(LONG64 index) const;
+
+    Options options_;
+    HANDLE mapping_ = nullptr;
+    plsnap_header *header_ = nullptr;
+    std::vector<plsnap_process> rows_;  // dense, in the order they are published
+    std::unordered_map<DWORD, size_t> index_;
+    uint64_t ticks_ = 0;
+};
+
+#endif
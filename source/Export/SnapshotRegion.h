@@ -0,0 +1,192 @@
+#ifndef SnapshotRegion_h
+#define SnapshotRegion_h
+
+/*
+ * The process table as processlited --shm publishes it: a named, read-only
+ * file mapping any process on the machine can map and read without a system
+ * call or a lock per read. Plain C, so it can be included as is from C,
+ * C++ or anything with a C FFI.
+ *
+ * Layout: a plsnap_header, then two slots, each a plsnap_slot followed by
+ * `capacity` fixed-size plsnap_process rows. The writer fills the slot that
+ * `latest` does not name and then points `latest` at it, so a reader of the
+ * newest table is only disturbed if it is still reading it a whole tick
+ * later. Each slot is a seqlock: its sequence is odd while the writer is in
+ * it and moves on every write, so a reader that sees the same even sequence
+ * before and after reading has a consistent table.
+ *
+ *     plsnap_view view;
+ *     if (plsnap_open(&view, PLSNAP_DEFAULT_NAME)) {
+ *         LONG64 ticket;
+ *         const plsnap_slot *slot;
+ *         do {
+ *             slot = plsnap_begin(&view, &ticket);
+ *             ... read slot->count rows from plsnap_rows(slot) ...
+ *         } while (slot && !plsnap_validate(slot, ticket));
+ *         plsnap_close(&view);
+ *     }
+ *
+ * Nothing read between plsnap_begin and a successful plsnap_validate may be
+ * acted on (a name may be half written); copy out first, or use plsnap_read.
+ */
+
+#include <windows.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PLSNAP_MAGIC 0x4D534C50u /* "PLSM" */
+#define PLSNAP_VERSION 1
+#define PLSNAP_NAME_CHARS 64
+#define PLSNAP_DEFAULT_NAME L"Local\\processlite.snapshot"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct plsnap_process {
+    uint32_t pid;
+    uint32_t parentPid;
+    double cpu;                    /* percent of all logical processors */
+    uint64_t ram;                  /* working set, bytes */
+    double io;                     /* read plus write, bytes per second */
+    WCHAR name[PLSNAP_NAME_CHARS]; /* NUL-terminated; truncated if longer */
+} plsnap_process;
+
+typedef struct plsnap_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;   /* offset of the first slot */
+    uint32_t rowBytes;      /* sizeof(plsnap_process) */
+    uint32_t capacity;      /* rows per slot */
+    uint64_t slotBytes;     /* slot header plus rows, rounded to a cache line */
+    uint64_t regionBytes;
+    volatile LONG64 latest; /* slot holding the newest table; -1 before the first */
+    volatile LONG writerPid; /* 0 once the writer has exited cleanly */
+    uint32_t reserved[5];
+} plsnap_header;
+
+typedef struct plsnap_slot {
+    volatile LONG64 sequence; /* odd while being written */
+    uint64_t tick;            /* counted from 1, and on across writer restarts */
+    int64_t timestamp;        /* FILETIME (UTC) the tick was published */
+    uint32_t count;           /* rows that follow */
+    uint32_t total;           /* processes in the table; more than count if it outgrew the slot */
+    uint8_t reserved[32];
+} plsnap_slot;
+
+typedef struct plsnap_view {
+    HANDLE mapping;
+    const plsnap_header *header;
+} plsnap_view;
+
+/* Maps the region read-only. FALSE, with GetLastError() set, if it does not
+ * exist (no writer has run) or is not a layout this header understands. */
+static inline BOOL plsnap_open(plsnap_view *view, const WCHAR *name) {
+    const plsnap_header *header;
+    view->mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name);
+    view->header = NULL;
+    if (!view->mapping) {
+        return FALSE;
+    }
+    header = (const plsnap_header *) MapViewOfFile(view->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!header) {
+        const DWORD error = GetLastError();
+        CloseHandle(view->mapping);
+        view->mapping = NULL;
+        SetLastError(error);
+        return FALSE;
+    }
+    if (header->magic != PLSNAP_MAGIC || header->version != PLSNAP_VERSION ||
+        header->rowBytes != sizeof(plsnap_process) || header->headerBytes < sizeof(plsnap_header)) {
+        UnmapViewOfFile(header);
+        CloseHandle(view->mapping);
+        view->mapping = NULL;
+        SetLastError(ERROR_INVALID_DATA);
+        return FALSE;
+    }
+    view->header = header;
+    return TRUE;
+}
+
+static inline void plsnap_close(plsnap_view *view) {
+    if (view->header) {
+        UnmapViewOfFile(view->header);
+        view->header = NULL;
+    }
+    if (view->mapping) {
+        CloseHandle(view->mapping);
+        view->mapping = NULL;
+    }
+}
+
+static inline const plsnap_slot *plsnap_slot_at(const plsnap_view *view, const LONG64 index) {
+    return (const plsnap_slot *) ((const char *) view->header + view->header->headerBytes +
+                                  (size_t) index * view->header->slotBytes);
+}
+
+static inline const plsnap_process *plsnap_rows(const plsnap_slot *slot) {
+    return (const plsnap_process *) (slot + 1);
+}
+
+/* The newest table, and the ticket plsnap_validate checks it against; NULL
+ * before the writer's first tick. */
+static inline const plsnap_slot *plsnap_begin(const plsnap_view *view, LONG64 *ticket) {
+    for (;;) {
+        const LONG64 latest = view->header->latest;
+        const plsnap_slot *slot;
+        LONG64 sequence;
+        MemoryBarrier();
+        if (latest < 0) {
+            return NULL;
+        }
+        slot = plsnap_slot_at(view, latest & 1);
+        sequence = slot->sequence;
+        MemoryBarrier();
+        if ((sequence & 1) == 0) {
+            *ticket = sequence;
+            return slot;
+        }
+        /* The writer has moved on to this slot; `latest` names the other. */
+        YieldProcessor();
+    }
+}
+
+/* Whether everything read from `slot` since plsnap_begin is consistent. */
+static inline BOOL plsnap_validate(const plsnap_slot *slot, const LONG64 ticket) {
+    MemoryBarrier();
+    return slot->sequence == ticket;
+}
+
+/* Copies the newest table: up to `capacity` rows into `rows`, and the slot
+ * header (tick, timestamp, count, total) into `info` if not NULL. Returns the
+ * rows copied, or -1 before the writer's first tick. */
+static inline int plsnap_read(const plsnap_view *view, plsnap_process *rows, const uint32_t capacity,
+                              plsnap_slot *info) {
+    for (;;) {
+        LONG64 ticket;
+        plsnap_slot copy;
+        uint32_t count;
+        const plsnap_slot *slot = plsnap_begin(view, &ticket);
+        if (!slot) {
+            return -1;
+        }
+        memcpy(&copy, (const void *) slot, sizeof(copy));
+        count = copy.count < capacity ? copy.count : capacity;
+        if (count > view->header->capacity) {
+            continue; /* torn header; the check below would fail too */
+        }
+        memcpy(rows, plsnap_rows(slot), count * sizeof(plsnap_process));
+        if (plsnap_validate(slot, ticket)) {
+            if (info) {
+                *info = copy;
+            }
+            return (int) count;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
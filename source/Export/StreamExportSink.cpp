@@ -0,0 +1,364 @@
+#include "StreamExportSink.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <string_view>
+
+#include "TextEncoding.h"
+
+namespace {
+    using columnar::FrameInfo;
+    using columnar::Row;
+
+    constexpr int64_t UnixEpochFileTime = 116444736000000000;  // 1970-01-01 in 100 ns since 1601
+
+    // NDJSON
+
+    void appendNumber(std::string &out, const double value) {
+        if (!std::isfinite(value)) {
+            out += "null";
+            return;
+        }
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void appendNumber(std::string &out, const uint64_t value) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void appendNumber(std::string &out, const int64_t value) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void appendJsonString(std::string &out, const std::string_view text) {
+        static constexpr char Hex[] = "0123456789abcdef";
+        out += '"';
+        for (const char c: text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += "\\u00";
+                        out += Hex[(c >> 4) & 0xf];
+                        out += Hex[c & 0xf];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    void appendJsonRows(std::string &out, const std::string_view key, const std::vector<Row> &rows) {
+        out += ",\"";
+        out += key;
+        out += "\":[";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row &row = rows[i];
+            out += i ? ",{\"pid\":" : "{\"pid\":";
+            appendNumber(out, static_cast<uint64_t>(row.pid));
+            out += ",\"ppid\":";
+            appendNumber(out, static_cast<uint64_t>(row.parentPid));
+            out += ",\"name\":";
+            appendJsonString(out, row.name);
+            out += ",\"path\":";
+            appendJsonString(out, row.path);
+            out += ",\"cmdline\":";
+            appendJsonString(out, row.commandLine);
+            out += ",\"cpu\":";
+            appendNumber(out, row.cpu);
+            out += ",\"ram\":";
+            appendNumber(out, row.ram);
+            out += ",\"io\":";
+            appendNumber(out, row.io);
+            out += '}';
+        }
+        out += ']';
+    }
+
+    void appendJsonHeader(std::string &out, const FrameInfo &frame) {
+        out += "{\"tick\":";
+        appendNumber(out, frame.tick);
+        out += ",\"ts\":";
+        appendNumber(out, (frame.timestamp - UnixEpochFileTime) / 10000);  // Unix milliseconds
+    }
+
+    void encodeNdjsonTable(std::string &out, const FrameInfo &frame, const std::vector<Row> &rows) {
+        appendJsonHeader(out, frame);
+        out += ",\"dropped\":";
+        appendNumber(out, static_cast<uint64_t>(frame.dropped));
+        appendJsonRows(out, "processes", rows);
+        out += "}\n";
+    }
+
+    // Updated entries carry only the fields that changed.
+    void encodeNdjsonDiff(std::string &out, const FrameInfo &frame, const ProcessUpdateData &update,
+                          const std::vector<Row> &added, const std::vector<Row> &transient) {
+        appendJsonHeader(out, frame);
+        out += ",\"merged\":";
+        appendNumber(out, static_cast<uint64_t>(frame.merged));
+        out += ",\"removed\":[";
+        for (size_t i = 0; i < update.removed_pids.size(); ++i) {
+            if (i) {
+                out += ',';
+            }
+            appendNumber(out, static_cast<uint64_t>(update.removed_pids[i]));
+        }
+        out += ']';
+        appendJsonRows(out, "added", added);
+        out += ",\"updated\":[";
+        for (size_t i = 0; i < update.updated.size(); ++i) {
+            const ProcessDelta &delta = update.updated[i];
+            out += i ? ",{\"pid\":" : "{\"pid\":";
+            appendNumber(out, static_cast<uint64_t>(delta.pid));
+            if (delta.changed & ProcessDelta::Cpu) {
+                out += ",\"cpu\":";
+                appendNumber(out, delta.cpuUsage);
+            }
+            if (delta.changed & ProcessDelta::Ram) {
+                out += ",\"ram\":";
+                appendNumber(out, static_cast<uint64_t>(delta.ramUsage));
+            }
+            if (delta.changed & ProcessDelta::Io) {
+                out += ",\"io\":";
+                appendNumber(out, delta.ioRate);
+            }
+            out += '}';
+        }
+        out += ']';
+        appendJsonRows(out, "transient", transient);
+        out += "}\n";
+    }
+
+    int64_t now() {
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        return static_cast<int64_t>((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime);
+    }
+}
+
+StreamExportSink::StreamExportSink(const std::wstring &target, Options options) : options_(options) {
+    if (target == L"-") {
+        output_ = GetStdHandle(STD_OUTPUT_HANDLE);
+        if (output_ == nullptr) {
+            output_ = INVALID_HANDLE_VALUE;  // no console and nothing redirected
+        }
+    } else {
+        // A pipe must already exist; anything else is created or truncated.
+        const bool pipe = target.starts_with(LR"(\\.\pipe\)");
+        file_ = HandleWrapper(CreateFileW(target.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                          pipe ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+        output_ = file_.get();
+    }
+    if (!isOpen()) {
+        std::cerr << "StreamExportSink: cannot open the export target. Error: " << GetLastError() << std::endl;
+        closed_ = true;
+        return;
+    }
+
+    pending_.reserve(options_.batchBytes);
+    writer_ = std::jthread([this](const std::stop_token &st) { run(st); });
+}
+
+StreamExportSink::~StreamExportSink() {
+    close();
+}
+
+void StreamExportSink::onUpdate(const ProcessUpdateData &update) {
+    if (closed_) {
+        return;
+    }
+    ++tick_;
+    if (options_.content == Content::Table) {
+        table_.apply(update);
+    }
+
+    bool full;
+    {
+        std::lock_guard lock(mutex_);
+        full = pending_.size() >= options_.maxPendingBytes;
+    }
+    if (full) {
+        if (options_.content == Content::Table) {
+            ++dropped_;
+            dropped_total_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            mergeIntoBacklog(update);
+            merged_total_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    if (backlog_.ticks > 0) {
+        mergeIntoBacklog(update);
+        const uint32_t merged = backlog_.ticks;
+        ProcessUpdateData combined;
+        takeBacklog(combined);
+        encode(combined, merged, 0);
+    } else {
+        encode(update, 1, dropped_);
+    }
+    dropped_ = 0;
+}
+
+void StreamExportSink::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    if (backlog_.ticks > 0) {
+        const uint32_t merged = backlog_.ticks;
+        ProcessUpdateData combined;
+        takeBacklog(combined);
+        encode(combined, merged, 0);
+    } else if (dropped_ > 0) {
+        encode(ProcessUpdateData(), 1, dropped_ - 1);  // the latest table, in place of the last dropped one
+    }
+    writer_.request_stop();  // the writer drains pending_ before it returns
+    writer_.join();
+    file_ = HandleWrapper();
+    output_ = INVALID_HANDLE_VALUE;
+}
+
+// Folds one tick into the backlog so that applying the backlog afterwards
+// gives the same table as applying every tick in turn.
+void StreamExportSink::mergeIntoBacklog(const ProcessUpdateData &update) {
+    for (const DWORD pid: update.removed_pids) {
+        if (backlog_.added.erase(pid) == 0) {
+            backlog_.removed.insert(pid);
+        }
+        backlog_.updated.erase(pid);
+    }
+    for (const ProcessInfo &info: update.added) {
+        backlog_.added.insert_or_assign(info.pid, info);
+    }
+    for (const ProcessDelta &delta: update.updated) {
+        if (const auto it = backlog_.added.find(delta.pid); it != backlog_.added.end()) {
+            // Still reported as added; fold the change into it.
+            ProcessInfo &info = it->second;
+            if (delta.changed & ProcessDelta::Cpu) {
+                info.cpuUsage = delta.cpuUsage;
+            }
+            if (delta.changed & ProcessDelta::Ram) {
+                info.ramUsage = delta.ramUsage;
+            }
+            if (delta.changed & ProcessDelta::Io) {
+                info.ioRate = delta.ioRate;
+            }
+            continue;
+        }
+        ProcessDelta &merged = backlog_.updated[delta.pid];
+        merged.pid = delta.pid;
+        merged.changed |= delta.changed;
+        if (delta.changed & ProcessDelta::Cpu) {
+            merged.cpuUsage = delta.cpuUsage;
+        }
+        if (delta.changed & ProcessDelta::Ram) {
+            merged.ramUsage = delta.ramUsage;
+        }
+        if (delta.changed & ProcessDelta::Io) {
+            merged.ioRate = delta.ioRate;
+        }
+    }
+    const size_t room = MaxBacklogTransient - std::min(backlog_.transient.size(), MaxBacklogTransient);
+    const size_t take = std::min(room, update.transient.size());
+    backlog_.transient.insert(backlog_.transient.end(), update.transient.begin(), update.transient.begin() + take);
+    ++backlog_.ticks;
+}
+
+void StreamExportSink::takeBacklog(ProcessUpdateData &out) {
+    out.removed_pids.assign(backlog_.removed.begin(), backlog_.removed.end());
+    out.added.reserve(backlog_.added.size());
+    for (auto &[pid, info]: backlog_.added) {
+        out.added.push_back(std::move(info));
+    }
+    out.updated.reserve(backlog_.updated.size());
+    for (const auto &[pid, delta]: backlog_.updated) {
+        out.updated.push_back(delta);
+    }
+    out.transient = std::move(backlog_.transient);
+    backlog_ = Backlog();
+}
+
+// Appends one frame to the pending batch. Only the writer ever shrinks the
+// batch, so it can overshoot maxPendingBytes by at most this frame.
+void StreamExportSink::encode(const ProcessUpdateData &update, const uint32_t merged, const uint32_t dropped) {
+    const FrameInfo frame{tick_, now(), merged, dropped};
+    const bool table = options_.content == Content::Table;
+    if (!table) {
+        columnar::toRows(update.added, added_rows_);
+        columnar::toRows(update.transient, transient_rows_);
+    }
+
+    std::lock_guard lock(mutex_);
+    if (options_.format == Format::Ndjson) {
+        table ? encodeNdjsonTable(pending_, frame, table_.rows())
+              : encodeNdjsonDiff(pending_, frame, update, added_rows_, transient_rows_);
+    } else {
+        table ? columnar::encodeTable(pending_, frame, table_.rows())
+              : columnar::encodeDiff(pending_, frame, update, added_rows_, transient_rows_);
+    }
+    ++pending_frames_;
+    if (pending_.size() >= options_.batchBytes) {
+        ready_.notify_one();
+    }
+}
+
+void StreamExportSink::run(const std::stop_token &st) {
+    std::string writing;
+    writing.reserve(options_.batchBytes);
+
+    std::unique_lock lock(mutex_);
+    while (true) {
+        ready_.wait_for(lock, st, options_.flushInterval,
+                        [this] { return pending_.size() >= options_.batchBytes; });
+        if (pending_.empty()) {
+            if (st.stop_requested()) {
+                return;
+            }
+            continue;
+        }
+
+        // The buffers trade places, capacity and all.
+        pending_.swap(writing);
+        const uint64_t frames = pending_frames_;
+        pending_frames_ = 0;
+        lock.unlock();
+        write(writing);
+        frames_.fetch_add(frames, std::memory_order_relaxed);
+        writing.clear();
+        lock.lock();
+    }
+}
+
+void StreamExportSink::write(const std::string &batch) {
+    if (write_failed_) {
+        return;  // a reader went away; keep draining so the collector never blocks
+    }
+    size_t offset = 0;
+    while (offset < batch.size()) {
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(batch.size() - offset, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(output_, batch.data() + offset, chunk, &written, nullptr)) {
+            std::cerr << "StreamExportSink: write failed, dropping further output. Error: " << GetLastError()
+                      << std::endl;
+            write_failed_ = true;
+            return;
+        }
+        offset += written;
+    }
+    bytes_written_.fetch_add(batch.size(), std::memory_order_relaxed);
+}
@@ -0,0 +1,111 @@
+#ifndef StreamExportSink_h
+#define StreamExportSink_h
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ColumnarCodec.h"
+#include "HandleWrapper.h"
+#include "Daemon/UpdateSink.h"
+
+// Streams every tick to a file, a named pipe or stdout, as NDJSON (one object
+// per line, for jq and friends) or as binary columnar frames (see
+// ColumnarFormat.h). Each frame is a tick's diff, exactly as ProcessUpdateData
+// carries it, or the whole table.
+//
+// The tick thread encodes straight into the pending batch; a writer thread
+// swaps the batch out once it holds batchBytes, or every flushInterval, and
+// writes it with one WriteFile. The two buffers trade places, so after
+// warm-up nothing is allocated per tick.
+//
+// The collector never waits for the writer. While maxPendingBytes are still
+// queued, a diff tick is merged into a backlog that goes out as one frame
+// once there is room (mergedTicks > 1); a table tick is dropped, since the
+// next one supersedes it (droppedTicks on the next frame).
+class StreamExportSink final : public UpdateSink {
+public:
+    enum class Format { Ndjson, Columnar };
+    enum class Content { Diff, Table };
+
+    struct Options {
+        Format format = Format::Ndjson;
+        Content content = Content::Diff;
+        size_t batchBytes = 1 << 20;
+        size_t maxPendingBytes = 32 << 20;
+        std::chrono::milliseconds flushInterval{1000};
+    };
+
+    // `target` is a file path (truncated), a pipe name (\\.\pipe\...) that a
+    // reader has already created, or "-" for stdout.
+    StreamExportSink(const std::wstring &target, Options options);
+    ~StreamExportSink() override;
+
+    StreamExportSink(const StreamExportSink&) = delete;
+    StreamExportSink& operator=(const StreamExportSink&) = delete;
+
+    [[nodiscard]] bool isOpen() const { return output_ != INVALID_HANDLE_VALUE; }
+
+    void onUpdate(const ProcessUpdateData &update) override;
+    // Writes what is queued, including a pending backlog or the latest table
+    // if it was dropped, and closes the target.
+    void close() override;
+
+    [[nodiscard]] uint64_t framesWritten() const { return frames_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t ticksMerged() const { return merged_total_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t ticksDropped() const { return dropped_total_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesWritten() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MaxBacklogTransient = 16384;
+
+    // Ticks that did not fit, folded into one diff.
+    struct Backlog {
+        std::unordered_set<DWORD> removed;  // present before the backlog began
+        std::unordered_map<DWORD, ProcessInfo> added;
+        std::unordered_map<DWORD, ProcessDelta> updated;
+        std::vector<ProcessInfo> transient;  // capped at MaxBacklogTransient
+        uint32_t ticks = 0;
+    };
+
+    void mergeIntoBacklog(const ProcessUpdateData &update);
+    void takeBacklog(ProcessUpdateData &out);
+    void encode(const ProcessUpdateData &update, uint32_t merged, uint32_t dropped);
+    void run(const std::stop_token &st);
+    void write(const std::string &batch);
+
+    Options options_;
+    HandleWrapper file_;
+    HANDLE output_ = INVALID_HANDLE_VALUE;  // file_ or stdout
+    bool closed_ = false;
+
+    // Tick thread only.
+    uint64_t tick_ = 0;
+    uint32_t dropped_ = 0;
+    Backlog backlog_;
+    columnar::RowTable table_;  // for Content::Table
+    std::vector<columnar::Row> added_rows_;
+    std::vector<columnar::Row> transient_rows_;
+
+    std::mutex mutex_;
+    std::condition_variable_any ready_;
+    std::string pending_;          // guarded by mutex_
+    uint64_t pending_frames_ = 0;  // guarded by mutex_
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> merged_total_{0};
+    std::atomic<uint64_t> dropped_total_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    bool write_failed_ = false;  // writer thread only
+    std::jthread writer_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TextEncoding_h
+#define TextEncoding_h
+
+#include <windows.h>
+#include <string>
+#include <string_view>
+
+// Process names and paths are UTF-16; everything that leaves the process
+// (logs, metrics, exports) is UTF-8. Appends to `out` so callers can build
+// into a reused buffer.
+inline void appendUtf8(std::string &out, const std::wstring_view text) {
+    if (text.empty()) {
+        return;
+    }
+    const int size = WideCharToMultiByte(CP_UTF8, 0, text.data(), static_cast<int>(text.size()),
+                                         nullptr, 0, nullptr, nullptr);
+    if (size <= 0) {
+        return;
+    }
+    const size_t start = out.size();
+    out.resize(start + size);
+    WideCharToMultiByte(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), out.data() + start, size,
+                        nullptr, nullptr);
+}
+
+inline std::string toUtf8(const std::wstring_view text) {
+    std::string out;
+    appendUtf8(out, text);
+    return out;
+}
+
+// UTF-8 coming back in (the fleet aggregator reads it off the network), into
+// any wide string type. False, leaving `out` empty, if it is not valid UTF-8.
+template<typename WString>
+bool assignUtf16(WString &out, const std::string_view text) {
+    out.clear();
+    if (text.empty()) {
+        return true;
+    }
+    const int size = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(), static_cast<int>(text.size()),
+                                         nullptr, 0);
+    if (size <= 0) {
+        return false;
+    }
+    out.resize(size);
+    MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.data(), static_cast<int>(text.size()), out.data(), size);
+    return true;
+}
+
+#endif
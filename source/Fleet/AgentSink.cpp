@@ -0,0 +1,233 @@
+#include "AgentSink.h"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "FleetProtocol.h"
+#include "Export/TextEncoding.h"
+
+namespace {
+    constexpr std::chrono::milliseconds PollInterval{250};  // bounds how long close() waits
+    constexpr std::chrono::seconds ConnectTimeout{5};
+
+    SOCKET toSocket(const uintptr_t socket) {
+        return static_cast<SOCKET>(socket);
+    }
+
+    int64_t now() {
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        return static_cast<int64_t>((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime);
+    }
+
+    std::wstring computerName() {
+        wchar_t buffer[MAX_COMPUTERNAME_LENGTH + 1];
+        DWORD size = MAX_COMPUTERNAME_LENGTH + 1;
+        return GetComputerNameW(buffer, &size) ? std::wstring(buffer, size) : L"unknown";
+    }
+
+    // Waits until the socket is writable; false on error, stop or timeout.
+    bool waitWritable(const SOCKET socket, const std::stop_token &st, const std::chrono::milliseconds limit) {
+        const auto deadline = std::chrono::steady_clock::now() + limit;
+        while (!st.stop_requested() && std::chrono::steady_clock::now() < deadline) {
+            WSAPOLLFD fd{socket, POLLWRNORM, 0};
+            const int ready = WSAPoll(&fd, 1, static_cast<INT>(PollInterval.count()));
+            if (ready == SOCKET_ERROR || (fd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+                return false;
+            }
+            if (fd.revents & POLLWRNORM) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+AgentSink::AgentSink(Options options) : options_(std::move(options)) {
+    WSADATA data;
+    winsock_ready_ = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    if (!winsock_ready_) {
+        std::cerr << "AgentSink: WSAStartup failed" << std::endl;
+        closed_ = true;
+        return;
+    }
+
+    std::string name = toUtf8(options_.hostName.empty() ? computerName() : options_.hostName);
+    if (name.size() > fleet::MaxHostNameBytes) {
+        size_t size = fleet::MaxHostNameBytes;
+        while (size > 0 && (static_cast<unsigned char>(name[size]) & 0xc0) == 0x80) {
+            --size;  // do not split a UTF-8 sequence
+        }
+        name.resize(size);
+    }
+    const fleet::Hello hello{fleet::HelloMagic, fleet::ProtocolVersion, static_cast<uint16_t>(name.size())};
+    hello_.resize(sizeof(hello) + columnar::align8(name.size()));
+    std::memcpy(hello_.data(), &hello, sizeof(hello));
+    std::memcpy(hello_.data() + sizeof(hello), name.data(), name.size());
+
+    sender_ = std::jthread([this](const std::stop_token &st) { run(st); });
+}
+
+AgentSink::~AgentSink() {
+    close();
+    if (winsock_ready_) {
+        WSACleanup();
+    }
+}
+
+bool AgentSink::connected() const {
+    std::lock_guard lock(mutex_);
+    return connected_;
+}
+
+void AgentSink::onUpdate(const ProcessUpdateData &update) {
+    if (closed_) {
+        return;
+    }
+    ++tick_;
+    table_.apply(update);
+    columnar::toRows(update.added, added_rows_);
+    columnar::toRows(update.transient, transient_rows_);
+
+    std::lock_guard lock(mutex_);
+    if (!connected_) {
+        return;  // the table goes out first on the next connection
+    }
+    if (!need_table_ && pending_.size() >= options_.maxPendingBytes) {
+        // Whole frames the sender has not taken yet; the table supersedes them.
+        dropped_ += pending_ticks_;
+        pending_.clear();
+        pending_ticks_ = 0;
+        need_table_ = true;
+        resyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (need_table_) {
+        columnar::encodeTable(pending_, columnar::FrameInfo{tick_, now(), 1, dropped_}, table_.rows());
+        need_table_ = false;
+        dropped_ = 0;
+    } else {
+        columnar::encodeDiff(pending_, columnar::FrameInfo{tick_, now()}, update, added_rows_, transient_rows_);
+    }
+    ++pending_ticks_;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    ready_.notify_one();
+}
+
+void AgentSink::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    sender_.request_stop();
+    sender_.join();
+}
+
+void AgentSink::run(const std::stop_token &st) {
+    std::string sending;
+    bool reported = false;
+    while (!st.stop_requested()) {
+        const SOCKET socket = toSocket(connect(st));
+        if (socket == INVALID_SOCKET) {
+            if (!reported && !st.stop_requested()) {
+                std::cerr << "AgentSink: cannot reach " << options_.address << ":" << options_.port
+                          << "; retrying" << std::endl;
+                reported = true;
+            }
+            std::unique_lock lock(mutex_);
+            ready_.wait_for(lock, st, options_.reconnectDelay, [] { return false; });
+            continue;
+        }
+        reported = false;
+
+        bool open = sendAll(socket, hello_.data(), hello_.size(), st);
+        if (open) {
+            std::lock_guard lock(mutex_);
+            pending_.clear();
+            pending_ticks_ = 0;
+            need_table_ = true;
+            connected_ = true;
+        }
+        while (open) {
+            {
+                std::unique_lock lock(mutex_);
+                if (!ready_.wait(lock, st, [this] { return !pending_.empty(); })) {
+                    break;  // stopping
+                }
+                // The buffers trade places, capacity and all.
+                pending_.swap(sending);
+                pending_ticks_ = 0;
+            }
+            open = sendAll(socket, sending.data(), sending.size(), st);
+            sending.clear();
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            connected_ = false;
+            dropped_ = 0;
+        }
+        closesocket(socket);
+        if (!open && !st.stop_requested()) {
+            std::cerr << "AgentSink: lost the aggregator; reconnecting" << std::endl;
+        }
+    }
+}
+
+// A connected non-blocking socket, or INVALID_SOCKET.
+uintptr_t AgentSink::connect(const std::stop_token &st) const {
+    if (!winsock_ready_) {
+        return static_cast<uintptr_t>(INVALID_SOCKET);
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(options_.address.c_str(), std::to_string(options_.port).c_str(), &hints, &found) != 0) {
+        return static_cast<uintptr_t>(INVALID_SOCKET);
+    }
+
+    SOCKET connected = INVALID_SOCKET;
+    for (const addrinfo *address = found; address && connected == INVALID_SOCKET; address = address->ai_next) {
+        const SOCKET socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket == INVALID_SOCKET) {
+            continue;
+        }
+        u_long enabled = 1;
+        int error = 0;
+        int length = sizeof(error);
+        if (ioctlsocket(socket, FIONBIO, &enabled) == 0 &&
+            (::connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 ||
+             (WSAGetLastError() == WSAEWOULDBLOCK && waitWritable(socket, st, ConnectTimeout) &&
+              getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &length) == 0 &&
+              error == 0))) {
+            connected = socket;
+        } else {
+            closesocket(socket);
+        }
+    }
+    freeaddrinfo(found);
+    return static_cast<uintptr_t>(connected);
+}
+
+bool AgentSink::sendAll(const uintptr_t socket, const char *data, size_t size, const std::stop_token &st) {
+    while (size > 0) {
+        const int sent = send(toSocket(socket), data, static_cast<int>(std::min<size_t>(size, 1u << 30)), 0);
+        if (sent == SOCKET_ERROR) {
+            // A stalled aggregator blocks only this thread; the tick resyncs instead.
+            if (WSAGetLastError() != WSAEWOULDBLOCK || st.stop_requested()) {
+                return false;
+            }
+            waitWritable(toSocket(socket), st, PollInterval);
+            continue;
+        }
+        data += sent;
+        size -= sent;
+        bytes_sent_.fetch_add(sent, std::memory_order_relaxed);
+    }
+    return true;
+}
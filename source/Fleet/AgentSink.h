@@ -0,0 +1,84 @@
+#ifndef AgentSink_h
+#define AgentSink_h
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Daemon/UpdateSink.h"
+#include "Export/ColumnarCodec.h"
+
+// Streams this machine's ticks to a fleet Aggregator (see FleetProtocol.h).
+//
+// The tick thread keeps a copy of the table and encodes each diff as a
+// columnar frame into a pending buffer; a sender thread owns the connection,
+// writes whatever is pending with non-blocking sends, and reconnects after
+// reconnectDelay when the aggregator is down or goes away.
+//
+// Nothing is queued while disconnected: the first frame on every connection
+// is the whole table. Likewise, when maxPendingBytes are still unsent, the
+// pending diffs are thrown away and replaced by the current table, so a slow
+// aggregator costs at most one table of memory and never blocks the tick.
+// Frames still pending at close() are not sent.
+class AgentSink final : public UpdateSink {
+public:
+    struct Options {
+        std::string address;    // aggregator host name or IP literal
+        uint16_t port = 0;
+        std::wstring hostName;  // this machine, as the aggregator labels it; empty: the computer name
+        size_t maxPendingBytes = 8 << 20;
+        std::chrono::milliseconds reconnectDelay{2000};
+    };
+
+    explicit AgentSink(Options options);
+    ~AgentSink() override;
+
+    AgentSink(const AgentSink&) = delete;
+    AgentSink& operator=(const AgentSink&) = delete;
+
+    void onUpdate(const ProcessUpdateData &update) override;
+    void close() override;
+
+    [[nodiscard]] bool connected() const;
+    [[nodiscard]] uint64_t framesQueued() const { return frames_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesSent() const { return bytes_sent_.load(std::memory_order_relaxed); }
+    // Tables sent because diffs had to be dropped.
+    [[nodiscard]] uint64_t resyncs() const { return resyncs_.load(std::memory_order_relaxed); }
+
+private:
+    void run(const std::stop_token &st);
+    uintptr_t connect(const std::stop_token &st) const;
+    bool sendAll(uintptr_t socket, const char *data, size_t size, const std::stop_token &st);
+
+    Options options_;
+    std::string hello_;  // Hello + host name, sent first on every connection
+    bool winsock_ready_ = false;
+    bool closed_ = false;
+
+    // Tick thread only.
+    uint64_t tick_ = 0;
+    columnar::RowTable table_;
+    std::vector<columnar::Row> added_rows_;
+    std::vector<columnar::Row> transient_rows_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any ready_;
+    std::string pending_;          // guarded by mutex_
+    uint32_t pending_ticks_ = 0;   // guarded by mutex_
+    bool connected_ = false;       // guarded by mutex_
+    bool need_table_ = true;       // guarded by mutex_
+    uint32_t dropped_ = 0;         // guarded by mutex_; diffs the next table replaces
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> resyncs_{0};
+    std::jthread sender_;
+};
+
+#endif
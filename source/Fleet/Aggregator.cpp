@@ -0,0 +1,371 @@
+#include "Aggregator.h"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include "FleetProtocol.h"
+#include "Export/ColumnarCodec.h"
+#include "Export/TextEncoding.h"
+#include "Query/Query.h"
+
+namespace {
+    constexpr std::chrono::milliseconds PollInterval{250};  // bounds how long stop() waits
+
+    SOCKET toSocket(const uintptr_t socket) {
+        return static_cast<SOCKET>(socket);
+    }
+
+    bool setNonBlocking(const SOCKET socket) {
+        u_long enabled = 1;
+        return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+    }
+}
+
+Aggregator::Aggregator() {
+    WSADATA data;
+    winsock_ready_ = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    if (!winsock_ready_) {
+        std::cerr << "Aggregator: WSAStartup failed" << std::endl;
+    }
+}
+
+Aggregator::~Aggregator() {
+    stop();
+    if (winsock_ready_) {
+        WSACleanup();
+    }
+}
+
+bool Aggregator::listen(const uint16_t port, const bool loopbackOnly) {
+    stop();
+    if (!winsock_ready_) {
+        return false;
+    }
+    const SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        std::cerr << "Aggregator: socket failed. Error: " << WSAGetLastError() << std::endl;
+        return false;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    address.sin_port = htons(port);
+    int length = sizeof(address);
+    if (bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)) {
+        std::cerr << "Aggregator: cannot listen on port " << port << ". Error: " << WSAGetLastError() << std::endl;
+        closesocket(listener);
+        return false;
+    }
+    port_ = ntohs(address.sin_port);
+    listener_ = static_cast<uintptr_t>(listener);
+    thread_ = std::jthread([this](const std::stop_token &st) { run(st); });
+    return true;
+}
+
+void Aggregator::stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+    for (const Connection &connection: connections_) {
+        disconnect(connection);
+        closesocket(toSocket(connection.socket));
+    }
+    connections_.clear();
+    if (toSocket(listener_) != INVALID_SOCKET) {
+        closesocket(toSocket(listener_));
+        listener_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    }
+}
+
+std::vector<Aggregator::Host> Aggregator::hosts() const {
+    std::shared_lock lock(hosts_mutex_);
+    std::vector<Host> out;
+    out.reserve(hosts_.size());
+    for (const auto &[name, host]: hosts_) {
+        out.push_back(host->summary);
+        out.back().processes = host->table.rows();
+    }
+    return out;
+}
+
+std::vector<Aggregator::Process> Aggregator::topK(const MetricHistory::Metric metric, const size_t k) const {
+    struct Candidate {
+        double value;
+        const HostState *host;
+        DWORD pid;
+    };
+
+    std::shared_lock lock(hosts_mutex_);
+    std::vector<Candidate> candidates;
+    for (const auto &[name, host]: hosts_) {
+        for (const TopKTracker::Entry &entry: host->ranking.topK(metric, k)) {
+            candidates.push_back(Candidate{entry.value, host.get(), entry.pid});
+        }
+    }
+    const size_t n = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<ptrdiff_t>(n), candidates.end(),
+                      [](const Candidate &a, const Candidate &b) { return a.value > b.value; });
+
+    std::vector<Process> out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const HostState &host = *candidates[i].host;
+        const uint32_t row = *host.table.rowOf(candidates[i].pid);
+        const auto name = host.names.find(candidates[i].pid);
+        out.push_back(Process{
+            host.summary.name, candidates[i].pid, name != host.names.end() ? name->second : std::wstring(),
+            host.table.numeric(ProcessTable::Column::Cpu)[row],
+            static_cast<uint64_t>(host.table.numeric(ProcessTable::Column::Ram)[row]),
+            host.table.numeric(ProcessTable::Column::Io)[row]});
+    }
+    return out;
+}
+
+std::optional<std::vector<Aggregator::Process>> Aggregator::query(const std::wstring_view text,
+                                                                  std::string *error) const {
+    if (!Query::compile(text, error)) {
+        return std::nullopt;
+    }
+
+    std::shared_lock lock(hosts_mutex_);
+    std::vector<Process> out;
+    std::vector<uint8_t> mask;
+    for (const auto &[name, host]: hosts_) {
+        // A compiled query caches per interner, so each host gets its own.
+        std::optional<Query> q = Query::compile(text);
+        q->evaluate(host->table, mask);
+        for (size_t row = 0; row < mask.size(); ++row) {
+            if (!mask[row]) {
+                continue;
+            }
+            const DWORD pid = host->table.pidAt(row);
+            const auto processName = host->names.find(pid);
+            out.push_back(Process{
+                name, pid, processName != host->names.end() ? processName->second : std::wstring(),
+                host->table.numeric(ProcessTable::Column::Cpu)[row],
+                static_cast<uint64_t>(host->table.numeric(ProcessTable::Column::Ram)[row]),
+                host->table.numeric(ProcessTable::Column::Io)[row]});
+        }
+    }
+    return out;
+}
+
+void Aggregator::run(const std::stop_token &st) {
+    std::vector<WSAPOLLFD> fds;
+    while (!st.stop_requested()) {
+        fds.clear();
+        fds.push_back(WSAPOLLFD{toSocket(listener_), static_cast<SHORT>(
+                                    connections_.size() < MaxConnections ? POLLRDNORM : 0), 0});
+        for (const Connection &connection: connections_) {
+            fds.push_back(WSAPOLLFD{toSocket(connection.socket), POLLRDNORM, 0});
+        }
+
+        const int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), static_cast<INT>(PollInterval.count()));
+        if (ready == SOCKET_ERROR) {
+            std::cerr << "Aggregator: WSAPoll failed. Error: " << WSAGetLastError() << std::endl;
+            return;
+        }
+
+        // Connections accepted below are not in `fds` yet; only walk the polled ones.
+        const size_t polled = connections_.size();
+        size_t kept = 0;
+        for (size_t i = 0; i < polled; ++i) {
+            Connection &connection = connections_[i];
+            const SHORT events = fds[i + 1].revents;
+            bool open = true;
+            if (events & (POLLRDNORM | POLLHUP | POLLERR)) {
+                open = readFrom(connection) && consume(connection);
+            } else if (events & POLLNVAL) {
+                open = false;
+            }
+            if (!open) {
+                disconnect(connection);
+                closesocket(toSocket(connection.socket));
+                continue;
+            }
+            if (kept != i) {
+                connections_[kept] = std::move(connection);
+            }
+            ++kept;
+        }
+        connections_.resize(kept);
+
+        if (fds[0].revents & POLLRDNORM) {
+            acceptConnections();
+        }
+    }
+}
+
+void Aggregator::acceptConnections() {
+    while (connections_.size() < MaxConnections) {
+        const SOCKET socket = accept(toSocket(listener_), nullptr, nullptr);
+        if (socket == INVALID_SOCKET) {
+            return;  // WSAEWOULDBLOCK: drained
+        }
+        if (!setNonBlocking(socket)) {
+            closesocket(socket);
+            continue;
+        }
+        connections_.push_back(Connection{static_cast<uintptr_t>(socket), next_connection_++});
+    }
+}
+
+// Reads what the socket has, up to MaxReadPerPoll. False closes the
+// connection.
+bool Aggregator::readFrom(Connection &connection) {
+    if (connection.consumed > 0 && connection.consumed >= connection.buffer.size() / 2) {
+        connection.buffer.erase(0, connection.consumed);
+        connection.consumed = 0;
+    }
+    for (size_t read = 0; read < MaxReadPerPoll;) {
+        const size_t start = connection.buffer.size();
+        connection.buffer.resize(start + ReadChunk);
+        const int received = recv(toSocket(connection.socket), connection.buffer.data() + start,
+                                  static_cast<int>(ReadChunk), 0);
+        connection.buffer.resize(start + std::max(received, 0));
+        if (received == 0) {
+            return false;
+        }
+        if (received == SOCKET_ERROR) {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+        read += received;
+        bytes_.fetch_add(received, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// Applies every whole message in the buffer. False closes the connection.
+bool Aggregator::consume(Connection &connection) {
+    while (true) {
+        const std::string_view data = std::string_view(connection.buffer).substr(connection.consumed);
+        size_t used = 0;
+        const bool ok = connection.host.empty() ? readHello(connection, data, used)
+                                                : applyFrame(connection, data, used);
+        if (!ok) {
+            return false;
+        }
+        if (used == 0) {
+            return true;  // need more
+        }
+        connection.consumed += used;
+    }
+}
+
+bool Aggregator::readHello(Connection &connection, const std::string_view data, size_t &used) {
+    fleet::Hello hello;
+    if (data.size() < sizeof(hello)) {
+        return true;
+    }
+    std::memcpy(&hello, data.data(), sizeof(hello));
+    if (hello.magic != fleet::HelloMagic || hello.version != fleet::ProtocolVersion ||
+        hello.hostNameBytes == 0 || hello.hostNameBytes > fleet::MaxHostNameBytes) {
+        std::cerr << "Aggregator: rejected a connection that is not a processlite agent" << std::endl;
+        return false;
+    }
+    const size_t size = sizeof(hello) + columnar::align8(hello.hostNameBytes);
+    if (data.size() < size) {
+        return true;
+    }
+    std::wstring name;
+    if (!assignUtf16(name, data.substr(sizeof(hello), hello.hostNameBytes))) {
+        return false;
+    }
+
+    std::unique_lock lock(hosts_mutex_);
+    std::unique_ptr<HostState> &host = hosts_[name];
+    if (!host) {
+        host = std::make_unique<HostState>();
+        host->summary.name = name;
+    }
+    if (host->summary.connected) {
+        // The agent reconnected before its old connection timed out; the old
+        // one no longer owns the host and is closed when it next polls.
+        for (const Connection &other: connections_) {
+            if (other.id == host->connection) {
+                shutdown(toSocket(other.socket), SD_BOTH);
+            }
+        }
+    }
+    host->connection = connection.id;
+    host->summary.connected = true;
+    ++host->summary.connections;
+    connection.host = std::move(name);
+    used = size;
+    return true;
+}
+
+bool Aggregator::applyFrame(const Connection &connection, const std::string_view data, size_t &used) {
+    columnar::FrameHeader header;
+    switch (columnar::peekFrame(data, MaxFrameBytes, header)) {
+        case columnar::Peek::NeedMore:
+            return true;
+        case columnar::Peek::Invalid:
+            std::cerr << "Aggregator: malformed frame from " << toUtf8(connection.host) << std::endl;
+            return false;
+        case columnar::Peek::Ready:
+            break;
+    }
+    if (!columnar::decodeFrame(data, header, scratch_)) {
+        std::cerr << "Aggregator: malformed frame from " << toUtf8(connection.host) << std::endl;
+        return false;
+    }
+
+    std::unique_lock lock(hosts_mutex_);
+    HostState &host = *hosts_[connection.host];
+    if (header.kind == columnar::FrameTable) {
+        if (header.droppedTicks > 0) {
+            ++host.summary.resyncs;
+        }
+        host.table = ProcessTable();
+        host.ranking = TopKTracker();
+        host.names.clear();
+    }
+    host.table.apply(scratch_);
+    for (const DWORD pid: scratch_.removed_pids) {
+        host.ranking.remove(pid);
+        host.names.erase(pid);
+    }
+    for (const ProcessInfo &info: scratch_.added) {
+        host.ranking.add(info);
+        host.names.insert_or_assign(info.pid, std::wstring(info.name));
+    }
+    for (const ProcessDelta &delta: scratch_.updated) {
+        host.ranking.update(delta);
+    }
+    ++host.summary.frames;
+    host.summary.bytes += header.frameBytes;
+    host.summary.lastTick = header.tick;
+    lock.unlock();
+
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    rows_.fetch_add(scratch_.added.size() + scratch_.removed_pids.size() + scratch_.updated.size(),
+                    std::memory_order_relaxed);
+    used = header.frameBytes;
+    return true;
+}
+
+// The host's processes leave the view, unless a newer connection took over.
+void Aggregator::disconnect(const Connection &connection) {
+    if (connection.host.empty()) {
+        return;
+    }
+    std::unique_lock lock(hosts_mutex_);
+    HostState &host = *hosts_[connection.host];
+    if (host.connection != connection.id) {
+        return;
+    }
+    host.summary.connected = false;
+    host.table = ProcessTable();
+    host.ranking = TopKTracker();
+    host.names.clear();
+}
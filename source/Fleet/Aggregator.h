@@ -0,0 +1,127 @@
+#ifndef Aggregator_h
+#define Aggregator_h
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+#include "Analysis/TopKTracker.h"
+#include "History/MetricHistory.h"
+#include "Query/ProcessTable.h"
+
+// The fleet view: accepts AgentSink streams (see FleetProtocol.h) from many
+// machines and keeps one process table per host, with a TopKTracker beside
+// it so fleet-wide top-K merges K entries per host instead of sorting every
+// process.
+//
+// One thread multiplexes every agent connection with WSAPoll over
+// non-blocking sockets, reads whole frames into a per-connection buffer and
+// applies each under a unique lock; queries take the lock shared. A host's
+// processes leave the view when its connection closes.
+class Aggregator {
+public:
+    struct Host {
+        std::wstring name;
+        bool connected = false;
+        size_t processes = 0;
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t lastTick = 0;   // as counted by the agent
+        uint64_t resyncs = 0;    // tables sent in place of diffs the agent dropped
+        uint64_t connections = 0;
+    };
+
+    struct Process {
+        std::wstring host;
+        DWORD pid = 0;
+        std::wstring name;
+        double cpu = 0.0;
+        uint64_t ram = 0;
+        double io = 0.0;
+    };
+
+    Aggregator();
+    ~Aggregator();
+
+    Aggregator(const Aggregator&) = delete;
+    Aggregator& operator=(const Aggregator&) = delete;
+
+    // All interfaces, or only 127.0.0.1; port 0 picks a free one (see
+    // port()). False, with the reason on std::cerr, if the socket cannot be
+    // set up.
+    bool listen(uint16_t port, bool loopbackOnly = false);
+    void stop();
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+
+    // Sorted by name; includes hosts that disconnected.
+    [[nodiscard]] std::vector<Host> hosts() const;
+    // The k largest across every connected host, largest first.
+    [[nodiscard]] std::vector<Process> topK(MetricHistory::Metric metric, size_t k) const;
+    // Every process matching a Query filter, by host; nullopt if the text
+    // does not compile.
+    [[nodiscard]] std::optional<std::vector<Process>> query(std::wstring_view text,
+                                                            std::string *error = nullptr) const;
+
+    [[nodiscard]] uint64_t framesReceived() const { return frames_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t bytesReceived() const { return bytes_.load(std::memory_order_relaxed); }
+    // Added, removed and updated entries applied.
+    [[nodiscard]] uint64_t rowsApplied() const { return rows_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MaxConnections = 1024;
+    static constexpr uint64_t MaxFrameBytes = 256ull << 20;
+    static constexpr size_t ReadChunk = 256 << 10;
+    static constexpr size_t MaxReadPerPoll = 4 << 20;  // per connection, so one agent cannot starve the rest
+
+    struct HostState {
+        Host summary;
+        uint64_t connection = 0;  // id of the connection feeding it
+        ProcessTable table;
+        TopKTracker ranking;
+        std::unordered_map<DWORD, std::wstring> names;
+    };
+
+    struct Connection {
+        uintptr_t socket;
+        uint64_t id;
+        std::string buffer;
+        size_t consumed = 0;
+        std::wstring host;  // empty until the hello is in
+    };
+
+    void run(const std::stop_token &st);
+    void acceptConnections();
+    bool readFrom(Connection &connection);
+    bool consume(Connection &connection);
+    bool readHello(Connection &connection, std::string_view data, size_t &used);
+    bool applyFrame(const Connection &connection, std::string_view data, size_t &used);
+    void disconnect(const Connection &connection);
+
+    bool winsock_ready_ = false;
+    uintptr_t listener_ = ~uintptr_t{0};  // INVALID_SOCKET
+    uint16_t port_ = 0;
+    std::vector<Connection> connections_;  // server thread only
+    uint64_t next_connection_ = 1;
+    ProcessUpdateData scratch_;            // server thread only
+
+    mutable std::shared_mutex hosts_mutex_;
+    std::map<std::wstring, std::unique_ptr<HostState>> hosts_;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> rows_{0};
+    std::jthread thread_;
+};
+
+#endif
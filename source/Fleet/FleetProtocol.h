@@ -0,0 +1,31 @@
+#ifndef FleetProtocol_h
+#define FleetProtocol_h
+
+#include <cstdint>
+
+// What an agent sends the aggregator over one TCP connection:
+//
+//   Hello + host name (UTF-8, hostNameBytes, zero-padded to 8 bytes)
+//   ColumnarFormat frames, back to back
+//
+// The first frame is a table; the aggregator replaces the host's processes
+// with it and applies every diff after it. The agent sends a table again
+// whenever it had to drop diffs (the aggregator fell behind), so the stream
+// never needs a reply. A host is whatever name the agent sends; a second
+// connection under the same name replaces the first.
+namespace fleet {
+    constexpr uint32_t HelloMagic = 0x47414c50;  // "PLAG"
+    constexpr uint16_t ProtocolVersion = 1;
+    constexpr uint16_t DefaultPort = 9417;
+    constexpr size_t MaxHostNameBytes = 255;
+
+    struct Hello {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t hostNameBytes;
+    };
+
+    static_assert(sizeof(Hello) == 8);
+}
+
+#endif
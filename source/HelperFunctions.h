@@ -5,6 +5,8 @@
 #include <string>
 #include <format>
 
+#include "Collection/SystemSampler.h"
+
 typedef LONG(WINAPI* RtlGetVersionPtr)(PRTL_OSVERSIONINFOW);
 
 inline std::wstring GetWindowsVersionString() {
@@ -193,4 +195,13 @@ inline std::wstring GetMemoryLoadPercentage() {
     return L"Failed to retrieve memory information";
 }
 
+inline std::wstring GetCpuUtilisation(const SystemSample &sample) {
+    return std::format(
+        L"{:.1f}% (User {:.1f}%, Kernel {:.1f}%), {:.0f} Switches/s, {:.0f} Interrupts/s",
+        sample.total.busy(), sample.total.user,
+        sample.total.system + sample.total.dpc + sample.total.interrupt,
+        sample.contextSwitchesPerSec, sample.interruptsPerSec
+    );
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "MetricHistory.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Recording/SeriesCodec.h"
+
+MetricHistory::MetricHistory(const size_t samplesPerMetric, const size_t memoryBudgetBytes)
+    : samples_per_metric_(std::max<size_t>(samplesPerMetric, 1)) {
+    const size_t slots = std::max<size_t>(memoryBudgetBytes / bytesPerSlot(samples_per_metric_), 1);
+
+    arena_ = ReservedArray<double>(slots * MetricCount * samples_per_metric_);
+    rings_.resize(slots);
+    free_slots_.reserve(slots);
+    // Hand out low slots first so a small process count stays in a compact part of the arena.
+    for (size_t i = slots; i-- > 0;) {
+        free_slots_.push_back(static_cast<uint32_t>(i));
+    }
+    slot_by_pid_.reserve(slots);
+}
+
+bool MetricHistory::track(const DWORD pid) {
+    if (slot_by_pid_.contains(pid)) {
+        return true;
+    }
+    if (free_slots_.empty() ||
+        !arena_.commit((static_cast<size_t>(free_slots_.back()) + 1) * MetricCount * samples_per_metric_)) {
+        if (!exhausted_logged_) {
+            std::cerr << "MetricHistory: memory budget exhausted, " << slotsInUse()
+                    << " processes tracked" << std::endl;
+            exhausted_logged_ = true;
+        }
+        return false;
+    }
+
+    const uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    rings_[slot] = Ring{pid, 0, 0};
+    slot_by_pid_.emplace(pid, slot);
+    return true;
+}
+
+void MetricHistory::release(const DWORD pid) {
+    const auto it = slot_by_pid_.find(pid);
+    if (it == slot_by_pid_.end()) {
+        return;
+    }
+    rings_[it->second] = Ring{};
+    free_slots_.push_back(it->second);
+    slot_by_pid_.erase(it);
+}
+
+bool MetricHistory::append(const DWORD pid, const double cpuUsage, const SIZE_T ramUsage, const double ioRate) {
+    const auto it = slot_by_pid_.find(pid);
+    if (it == slot_by_pid_.end()) {
+        return false;
+    }
+
+    const uint32_t slot = it->second;
+    Ring &ring = rings_[slot];
+    column(slot, Metric::Cpu)[ring.head] = cpuUsage;
+    column(slot, Metric::Ram)[ring.head] = static_cast<double>(ramUsage);
+    column(slot, Metric::Io)[ring.head] = ioRate;
+
+    if (++ring.head == samples_per_metric_) {
+        ring.head = 0;
+    }
+    if (ring.count < samples_per_metric_) {
+        ++ring.count;
+    }
+    return true;
+}
+
+size_t MetricHistory::copySeries(const DWORD pid, const Metric metric, double *out, const size_t maxCount) const {
+    const auto it = slot_by_pid_.find(pid);
+    if (it == slot_by_pid_.end() || !out) {
+        return 0;
+    }
+
+    const Ring &ring = rings_[it->second];
+    const double *data = column(it->second, metric);
+    const size_t n = std::min<size_t>(ring.count, maxCount);
+
+    // Oldest of the n most recent samples.
+    const size_t pos = (ring.head + samples_per_metric_ - n) % samples_per_metric_;
+    const size_t firstRun = std::min(n, samples_per_metric_ - pos);
+    std::copy_n(data + pos, firstRun, out);
+    std::copy_n(data, n - firstRun, out + firstRun);
+    return n;
+}
+
+std::vector<double> MetricHistory::getSeries(const DWORD pid, const Metric metric) const {
+    std::vector<double> series(samples_per_metric_);
+    series.resize(copySeries(pid, metric, series.data(), series.size()));
+    return series;
+}
+
+size_t MetricHistory::compressSeries(const DWORD pid, const Metric metric, std::vector<uint8_t> &out) const {
+    const std::vector<double> series = getSeries(pid, metric);
+    const size_t before = out.size();
+    codec::putVarint(series.size(), out);
+
+    if (metric == Metric::Ram) {
+        std::vector<uint64_t> bytes(series.begin(), series.end());
+        codec::encodeIntegers(std::span<const uint64_t>(bytes), codec::IntegerOrder::Delta, out);
+    } else {
+        codec::encodeDoubles(series, out);
+    }
+    return out.size() - before;
+}
+
+std::vector<double> MetricHistory::decompressSeries(const std::span<const uint8_t> in, const Metric metric) {
+    uint64_t count = 0;
+    const size_t header = codec::getVarint(in, count);
+    if (header == 0 || count == 0 || count > (1u << 24)) {
+        return {};
+    }
+
+    std::vector<double> series(count);
+    if (metric == Metric::Ram) {
+        std::vector<uint64_t> bytes(count);
+        if (codec::decodeIntegers(in.subspan(header), count, codec::IntegerOrder::Delta, bytes.data()) == 0) {
+            return {};
+        }
+        std::copy(bytes.begin(), bytes.end(), series.begin());
+    } else if (codec::decodeDoubles(in.subspan(header), count, series.data()) == 0) {
+        return {};
+    }
+    return series;
+}
+
+size_t MetricHistory::memoryFootprint() const {
+    return arena_.committedBytes() + rings_.size() * sizeof(Ring) + free_slots_.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,94 @@
+#ifndef MetricHistory_h
+#define MetricHistory_h
+
+#include <windows.h>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "Memory/ReservedArray.h"
+
+// Fixed-memory per-process history of the sampled metrics.
+//
+// Every tracked process owns one slot in a single arena sized from the budget. A slot
+// holds one ring per metric (CPU %, working set bytes, I/O B/s), all sharing the
+// same head/count so index i refers to the same tick in every metric. Slots of
+// exited processes go back to a free list and are handed to the next new PID.
+// The arena is reserved up front but committed as slots are first handed
+// out, so the budget is a ceiling rather than a startup cost.
+//
+// The class is not synchronized; ProcessMonitor mutates it under its unique
+// lock and reads it under the shared lock.
+class MetricHistory {
+public:
+    enum class Metric : uint8_t { Cpu = 0, Ram = 1, Io = 2 };
+    static constexpr size_t MetricCount = 3;
+
+    static constexpr size_t DefaultSamplesPerMetric = 600;  // 10 min at 1 s ticks
+    // Processes the default budget holds; see RollupStore::DefaultProcessCapacity.
+    static constexpr size_t DefaultProcessCapacity = 8192;
+
+    explicit MetricHistory(size_t samplesPerMetric = DefaultSamplesPerMetric,
+                           size_t memoryBudgetBytes = budgetFor(DefaultProcessCapacity, DefaultSamplesPerMetric));
+
+    // Budget that holds `processes` rings of samplesPerMetric samples each.
+    static constexpr size_t budgetFor(const size_t processes, const size_t samplesPerMetric) {
+        return processes * bytesPerSlot(samplesPerMetric);
+    }
+
+    MetricHistory(const MetricHistory&) = delete;
+    MetricHistory& operator=(const MetricHistory&) = delete;
+    MetricHistory(MetricHistory&&) = default;
+    MetricHistory& operator=(MetricHistory&&) = default;
+
+    // Assign a ring to pid. Returns false when the arena is exhausted.
+    bool track(DWORD pid);
+
+    // Return the ring of pid to the free list.
+    void release(DWORD pid);
+
+    // O(1), allocation-free. Returns false if pid has no ring.
+    bool append(DWORD pid, double cpuUsage, SIZE_T ramUsage, double ioRate);
+
+    // Copies the stored samples of one metric, oldest first, into out.
+    // Returns the number of samples written (at most maxCount).
+    size_t copySeries(DWORD pid, Metric metric, double *out, size_t maxCount) const;
+    std::vector<double> getSeries(DWORD pid, Metric metric) const;
+
+    // Appends the series of one metric in SeriesCodec form (sample count first)
+    // to out. Used to ship or archive history without the 8 bytes per sample.
+    size_t compressSeries(DWORD pid, Metric metric, std::vector<uint8_t> &out) const;
+    static std::vector<double> decompressSeries(std::span<const uint8_t> in, Metric metric);
+
+    [[nodiscard]] size_t samplesPerMetric() const { return samples_per_metric_; }
+    [[nodiscard]] size_t slotCapacity() const { return rings_.size(); }
+    [[nodiscard]] size_t slotsInUse() const { return rings_.size() - free_slots_.size(); }
+    // Committed bytes, not the budget.
+    [[nodiscard]] size_t memoryFootprint() const;
+
+private:
+    struct Ring {
+        DWORD pid = 0;
+        uint32_t head = 0;   // next write position
+        uint32_t count = 0;  // valid samples, <= samples_per_metric_
+    };
+
+    static constexpr size_t bytesPerSlot(const size_t samplesPerMetric) {
+        return samplesPerMetric * MetricCount * sizeof(double) + sizeof(Ring);
+    }
+
+    double *column(uint32_t slot, Metric metric) const {
+        return arena_.data() + (static_cast<size_t>(slot) * MetricCount + static_cast<size_t>(metric))
+                              * samples_per_metric_;
+    }
+
+    size_t samples_per_metric_;
+    ReservedArray<double> arena_;
+    std::vector<Ring> rings_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<DWORD, uint32_t> slot_by_pid_;
+    bool exhausted_logged_ = false;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "RollupStore.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    size_t metricIndex(const MetricHistory::Metric metric) {
+        return metric == MetricHistory::Metric::Cpu ? 0 : 1;
+    }
+
+    uint32_t windowOf(const int64_t seconds, const std::chrono::seconds width) {
+        return static_cast<uint32_t>(seconds / width.count());
+    }
+}
+
+RollupStore::RollupStore(const size_t memoryBudgetBytes) {
+    const size_t slots = std::max<size_t>(memoryBudgetBytes / bytesPerSlot(), 1);
+
+    arena_ = ReservedArray<Bucket>(slots * RolledMetrics * bucketsPerMetric());
+    slots_.resize(slots);
+    free_slots_.reserve(slots);
+    for (size_t i = slots; i-- > 0;) {
+        free_slots_.push_back(static_cast<uint32_t>(i));
+    }
+    slot_by_pid_.reserve(slots);
+}
+
+bool RollupStore::track(const DWORD pid) {
+    if (slot_by_pid_.contains(pid)) {
+        return true;
+    }
+    if (free_slots_.empty() ||
+        !arena_.commit((static_cast<size_t>(free_slots_.back()) + 1) * RolledMetrics * bucketsPerMetric())) {
+        if (refused_tracks_++ == 0) {
+            std::cerr << "RollupStore: memory budget exhausted, " << slot_by_pid_.size()
+                      << " processes rolled up; newer ones only keep raw history" << std::endl;
+        }
+        return false;
+    }
+    const uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot] = Slot{pid};
+    slot_by_pid_.emplace(pid, slot);
+    return true;
+}
+
+void RollupStore::release(const DWORD pid) {
+    if (const auto it = slot_by_pid_.find(pid); it != slot_by_pid_.end()) {
+        free_slots_.push_back(it->second);
+        slot_by_pid_.erase(it);
+    }
+}
+
+RollupStore::Bucket *RollupStore::ring(const uint32_t slot, const size_t metric, const size_t tier) const {
+    size_t offset = (static_cast<size_t>(slot) * RolledMetrics + metric) * bucketsPerMetric();
+    for (size_t t = 0; t < tier; ++t) {
+        offset += Tiers[t].retention;
+    }
+    return arena_.data() + offset;
+}
+
+void RollupStore::accumulate(Accumulator &acc, const Accumulator &in) {
+    if (acc.count == 0) {
+        acc.min = in.min;
+        acc.max = in.max;
+    } else {
+        acc.min = std::min(acc.min, in.min);
+        acc.max = std::max(acc.max, in.max);
+    }
+    acc.sum += in.sum;
+    acc.count += in.count;
+    acc.last = in.last;
+}
+
+void RollupStore::add(const DWORD pid, const std::chrono::steady_clock::time_point now,
+                      const double cpuUsage, const SIZE_T ramUsage) {
+    const auto it = slot_by_pid_.find(pid);
+    if (it == slot_by_pid_.end()) {
+        return;
+    }
+
+    const int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    const double values[RolledMetrics] = {cpuUsage, static_cast<double>(ramUsage)};
+
+    for (size_t m = 0; m < RolledMetrics; ++m) {
+        const Accumulator sample{values[m], values[m], values[m], values[m], 1, windowOf(seconds, Tiers[0].width)};
+        fold(it->second, m, 0, sample);
+    }
+}
+
+// Feeds `in` into tier's accumulator; if `in` belongs to a later window, the
+// current one is closed first and cascades into tier + 1.
+void RollupStore::fold(const uint32_t slot, const size_t metric, const size_t tier, const Accumulator &in) {
+    TierState &state = slots_[slot].tiers[metric][tier];
+    Accumulator &acc = state.acc;
+    const uint32_t window = tier == 0 ? in.window : windowOf(
+        static_cast<int64_t>(in.window) * Tiers[tier - 1].width.count(), Tiers[tier].width);
+
+    if (acc.count != 0 && window != acc.window) {
+        const Accumulator closed = acc;
+        Bucket &bucket = ring(slot, metric, tier)[state.head];
+        bucket = Bucket{
+            static_cast<float>(closed.min),
+            static_cast<float>(closed.max),
+            static_cast<float>(closed.sum / closed.count),
+            static_cast<float>(closed.last),
+            closed.window
+        };
+        if (++state.head == Tiers[tier].retention) {
+            state.head = 0;
+        }
+        if (state.count < Tiers[tier].retention) {
+            ++state.count;
+        }
+        acc = Accumulator{};
+
+        if (tier + 1 < TierCount) {
+            fold(slot, metric, tier + 1, closed);
+        }
+    }
+
+    accumulate(acc, in);
+    acc.window = window;
+}
+
+int RollupStore::tierFor(const std::chrono::seconds resolution) {
+    int chosen = -1;
+    for (size_t t = 0; t < TierCount; ++t) {
+        if (Tiers[t].width <= resolution) {
+            chosen = static_cast<int>(t);
+        }
+    }
+    return chosen;
+}
+
+std::vector<RollupStore::Bucket> RollupStore::query(const DWORD pid, const MetricHistory::Metric metric,
+                                                    const std::chrono::seconds resolution) const {
+    std::vector<Bucket> out;
+    const int tier = tierFor(resolution);
+    const auto it = slot_by_pid_.find(pid);
+    if (tier < 0 || it == slot_by_pid_.end() || metric == MetricHistory::Metric::Io) {
+        return out;
+    }
+
+    const size_t m = metricIndex(metric);
+    const TierState &state = slots_[it->second].tiers[m][tier];
+    const Bucket *data = ring(it->second, m, tier);
+    const uint32_t retention = Tiers[tier].retention;
+
+    out.reserve(state.count);
+    for (uint32_t i = 0, pos = (state.head + retention - state.count) % retention; i < state.count; ++i) {
+        out.push_back(data[pos]);
+        if (++pos == retention) {
+            pos = 0;
+        }
+    }
+    return out;
+}
+
+size_t RollupStore::memoryFootprint() const {
+    return arena_.committedBytes() + slots_.size() * sizeof(Slot) + free_slots_.capacity() * sizeof(uint32_t);
+}
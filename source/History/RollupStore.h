@@ -0,0 +1,126 @@
+#ifndef RollupStore_h
+#define RollupStore_h
+
+#include <windows.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "MetricHistory.h"
+#include "Memory/ReservedArray.h"
+
+// Multi-resolution rollups of per-process CPU and memory for long retention.
+//
+// Raw per-tick samples live in MetricHistory (1 s resolution, ~10 min). This
+// store keeps three coarser tiers: 10 s, 1 min and 10 min windows, each bucket
+// holding min/max/mean/last. A tier only does work when its window closes: the
+// closed accumulator is written to the tier's ring and folded into the next
+// tier's accumulator, so raw data is never rescanned.
+//
+// Like MetricHistory, all rings live in one arena sized from a memory budget,
+// committed as slots are first used, and slots are recycled through a free
+// list. Not synchronized.
+class RollupStore {
+public:
+    struct Bucket {
+        float min = 0.0f;
+        float max = 0.0f;
+        float mean = 0.0f;
+        float last = 0.0f;
+        uint32_t window = 0;  // window index: start time / tier width, in seconds
+    };
+
+    struct TierSpec {
+        std::chrono::seconds width;
+        uint32_t retention;  // buckets kept
+    };
+
+    static constexpr size_t TierCount = 3;
+    static constexpr std::array<TierSpec, TierCount> Tiers{{
+        {std::chrono::seconds(10), 360},    // 1 h
+        {std::chrono::minutes(1), 720},     // 12 h
+        {std::chrono::minutes(10), 1008},   // 7 days
+    }};
+
+    // The default budget holds this many processes. It is only reserved
+    // address space until slots are used, so it can cover a busy build
+    // server rather than a typical desktop.
+    static constexpr size_t DefaultProcessCapacity = 8192;
+
+    explicit RollupStore(size_t memoryBudgetBytes = budgetFor(DefaultProcessCapacity));
+
+    // Budget that holds `processes` rollup slots.
+    static constexpr size_t budgetFor(const size_t processes) { return processes * bytesPerSlot(); }
+
+    RollupStore(const RollupStore&) = delete;
+    RollupStore& operator=(const RollupStore&) = delete;
+
+    // False once the budget is used up; the first refusal is logged, and
+    // refusedTracks() counts them.
+    bool track(DWORD pid);
+    void release(DWORD pid);
+
+    // Feed one raw sample. O(1) unless a window closes, in which case the cost is
+    // bounded by the number of tiers.
+    void add(DWORD pid, std::chrono::steady_clock::time_point now, double cpuUsage, SIZE_T ramUsage);
+
+    // Closed buckets of the coarsest tier whose width is <= resolution, oldest
+    // first. Returns an empty vector if resolution is finer than the first tier,
+    // the caller then reads MetricHistory instead. Only Cpu and Ram are rolled up.
+    std::vector<Bucket> query(DWORD pid, MetricHistory::Metric metric, std::chrono::seconds resolution) const;
+
+    // Index of the tier query() would use for resolution, or -1 for raw samples.
+    static int tierFor(std::chrono::seconds resolution);
+
+    [[nodiscard]] size_t slotCapacity() const { return slots_.size(); }
+    [[nodiscard]] uint64_t refusedTracks() const { return refused_tracks_; }
+    // Committed bytes, not the budget.
+    [[nodiscard]] size_t memoryFootprint() const;
+
+private:
+    static constexpr size_t RolledMetrics = 2;  // Cpu, Ram
+
+    struct Accumulator {
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        double last = 0.0;
+        uint32_t count = 0;
+        uint32_t window = 0;
+    };
+
+    struct TierState {
+        Accumulator acc;
+        uint32_t head = 0;
+        uint32_t count = 0;
+    };
+
+    struct Slot {
+        DWORD pid = 0;
+        std::array<std::array<TierState, TierCount>, RolledMetrics> tiers{};
+    };
+
+    static constexpr size_t bucketsPerMetric() {
+        size_t n = 0;
+        for (const auto &t: Tiers) n += t.retention;
+        return n;
+    }
+
+    static constexpr size_t bytesPerSlot() {
+        return RolledMetrics * bucketsPerMetric() * sizeof(Bucket) + sizeof(Slot);
+    }
+
+    Bucket *ring(uint32_t slot, size_t metric, size_t tier) const;
+    void fold(uint32_t slot, size_t metric, size_t tier, const Accumulator &closed);
+    static void accumulate(Accumulator &acc, const Accumulator &in);
+
+    ReservedArray<Bucket> arena_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<DWORD, uint32_t> slot_by_pid_;
+    uint64_t refused_tracks_ = 0;
+};
+
+#endif
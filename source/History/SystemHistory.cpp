@@ -0,0 +1,54 @@
+#include "SystemHistory.h"
+
+#include <algorithm>
+
+SystemHistory::SystemHistory(const size_t samples)
+    : samples_(std::max<size_t>(samples, 1)), totals_(SeriesCount * samples_) {}
+
+void SystemHistory::append(const SystemSample &sample) {
+    if (sample.cores.size() != cores_) {
+        // Processor set changed (or first sample): per-core history restarts,
+        // the totals carry on.
+        cores_ = sample.cores.size();
+        core_busy_.assign(cores_ * samples_, 0.0);
+        core_count_ = 0;
+    }
+
+    const double values[SeriesCount] = {
+        sample.total.busy(), sample.total.user, sample.total.system,
+        sample.contextSwitchesPerSec, sample.interruptsPerSec
+    };
+    for (size_t series = 0; series < SeriesCount; ++series) {
+        totals_[series * samples_ + head_] = values[series];
+    }
+    for (size_t core = 0; core < cores_; ++core) {
+        core_busy_[core * samples_ + head_] = sample.cores[core].busy();
+    }
+
+    if (++head_ == samples_) {
+        head_ = 0;
+    }
+    count_ = std::min(count_ + 1, samples_);
+    core_count_ = std::min(core_count_ + 1, samples_);
+}
+
+std::vector<double> SystemHistory::getSeries(const Series series) const {
+    return copyRing(totals_.data() + static_cast<size_t>(series) * samples_, count_);
+}
+
+std::vector<double> SystemHistory::getCoreSeries(const size_t core) const {
+    if (core >= cores_) {
+        return {};
+    }
+    return copyRing(core_busy_.data() + core * samples_, core_count_);
+}
+
+// The n most recent samples of one ring, oldest first.
+std::vector<double> SystemHistory::copyRing(const double *data, const size_t n) const {
+    std::vector<double> out(n);
+    const size_t pos = (head_ + samples_ - n) % samples_;
+    const size_t firstRun = std::min(n, samples_ - pos);
+    std::copy_n(data + pos, firstRun, out.data());
+    std::copy_n(data, n - firstRun, out.data() + firstRun);
+    return out;
+}
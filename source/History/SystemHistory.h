@@ -0,0 +1,43 @@
+#ifndef SystemHistory_h
+#define SystemHistory_h
+
+#include <cstdint>
+#include <vector>
+
+#include "MetricHistory.h"
+#include "Collection/SystemSampler.h"
+
+// Fixed-length history of the machine-wide samples, the system counterpart of
+// MetricHistory. Totals keep one ring per series; per-core busy % keeps one
+// ring per core, sized on the first append. All rings share head/count.
+//
+// Not synchronized; ProcessMonitor guards it like MetricHistory.
+class SystemHistory {
+public:
+    enum class Series : uint8_t { Busy = 0, User = 1, System = 2, ContextSwitches = 3, Interrupts = 4 };
+    static constexpr size_t SeriesCount = 5;
+
+    explicit SystemHistory(size_t samples = MetricHistory::DefaultSamplesPerMetric);
+
+    void append(const SystemSample &sample);
+
+    // Stored samples, oldest first.
+    std::vector<double> getSeries(Series series) const;
+    // Busy % of one core; empty for a core never seen.
+    std::vector<double> getCoreSeries(size_t core) const;
+
+    [[nodiscard]] size_t coreCount() const { return cores_; }
+
+private:
+    std::vector<double> copyRing(const double *data, size_t n) const;
+
+    size_t samples_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t core_count_ = 0;  // samples since the processor set last changed
+    size_t cores_ = 0;
+    std::vector<double> totals_;     // SeriesCount rings of samples_
+    std::vector<double> core_busy_;  // cores_ rings of samples_
+};
+
+#endif
@@ -112,9 +112,7 @@ void ListViewManager::Resize(const int parentWidth, const int parentHeight) cons
     ListView_SetColumnWidth(hwnd_list_view_, 5, pathWidth);
 }
 
-void ListViewManager::applyListViewUpdates(ProcessUpdateData* updateData) {
-    if (!updateData) return;
-
+void ListViewManager::applyListViewUpdates(const ProcessUpdateData &updateData) {
     // Improve performance by temporarily disabling redraw
     SendMessageW(hwnd_list_view_, WM_SETREDRAW, FALSE, 0);
 
@@ -134,7 +132,7 @@ void ListViewManager::applyListViewUpdates(ProcessUpdateData* updateData) {
 
 
     // 1. Remove items for processes that have exited
-    for (DWORD removedPid: updateData->removed_pids) {
+    for (DWORD removedPid: updateData.removed_pids) {
         for (int i = 0; i < itemCount; ++i) {
             if (pidsInList[i] == removedPid) {
                 ListView_DeleteItem(hwnd_list_view_, i);
@@ -145,108 +143,104 @@ void ListViewManager::applyListViewUpdates(ProcessUpdateData* updateData) {
         }
     }
 
-    // 2. Update existing items
-    for (const auto &updatedInfo: updateData->updated) {
+    // 2. Update existing items: only the columns whose value changed
+    for (const auto &delta: updateData.updated) {
         bool found = false;
         for (int i = 0; i < itemCount; ++i) {
-            if (pidsInList[i] == updatedInfo.pid) {
-                LVITEMW item = {0};
-                item.iItem = i;
-                item.mask = LVIF_TEXT | LVIF_IMAGE;
-
-                int iconIdx = getOrAddIconIndex(updatedInfo.path);
-                item.iImage = (iconIdx != -1) ? iconIdx : I_IMAGENONE;
-
-                // Update Name (SubItem 0)
-                item.iSubItem = 0;
-                item.pszText = const_cast<wchar_t *>(updatedInfo.name.c_str());
-                ListView_SetItem(hwnd_list_view_, &item);
-
-                // Update other subitems using ListView_SetItemText for efficiency
+            if (pidsInList[i] == delta.pid) {
                 wchar_t buffer[64]; // Buffer for formatted strings
 
-                // SubItem 1: PID (Usually doesn't change, but update for consistency)
-                swprintf_s(buffer, L"%lu", updatedInfo.pid);
-                ListView_SetItemText(hwnd_list_view_, i, 1, buffer);
-
                 // SubItem 2: CPU Usage
-                swprintf_s(buffer, L"%.1f %%", updatedInfo.cpuUsage); // Format CPU
-                ListView_SetItemText(hwnd_list_view_, i, 2, buffer);
+                if (delta.changed & ProcessDelta::Cpu) {
+                    swprintf_s(buffer, L"%.1f %%", delta.cpuUsage); // Format CPU
+                    ListView_SetItemText(hwnd_list_view_, i, 2, buffer);
+                }
 
                 // SubItem 3: RAM Usage (convert bytes to KB or MB)
-                swprintf_s(buffer, L"%zu KB", updatedInfo.ramUsage / 1024);
-                ListView_SetItemText(hwnd_list_view_, i, 3, buffer);
+                if (delta.changed & ProcessDelta::Ram) {
+                    swprintf_s(buffer, L"%zu KB", delta.ramUsage / 1024);
+                    ListView_SetItemText(hwnd_list_view_, i, 3, buffer);
+                }
 
                 // SubItem 4: I/O Rate (convert B/s to KB/s or MB/s)
-                swprintf_s(buffer, L"%.1f KB/s", updatedInfo.ioRate / 1024.0);
-                ListView_SetItemText(hwnd_list_view_, i, 4, buffer);
-
-                // SubItem 5: Path (maybe truncate)
-                std::wstring displayPath = updatedInfo.path;
-                if (constexpr size_t maxPathLen = 40; displayPath.length() > maxPathLen) {
-                    displayPath = L"..." + displayPath.substr(displayPath.length() - maxPathLen);
+                if (delta.changed & ProcessDelta::Io) {
+                    swprintf_s(buffer, L"%.1f KB/s", delta.ioRate / 1024.0);
+                    ListView_SetItemText(hwnd_list_view_, i, 4, buffer);
                 }
-                ListView_SetItemText(hwnd_list_view_, i, 5, const_cast<wchar_t*>(displayPath.c_str()));
 
                 found = true;
                 break; // Move to next updated PID
             }
         }
         if (!found) {
-            std::cerr << "UI Update: PID " << updatedInfo.pid << " marked for update but not found in list.\n";
+            std::cerr << "UI Update: PID " << delta.pid << " marked for update but not found in list.\n";
         }
     }
 
     // 3. Add new items
-    for (const auto &addedInfo: updateData->added) {
-        LVITEMW item = {0};
-        item.mask = LVIF_TEXT | LVIF_PARAM | LVIF_IMAGE; // Include LVIF_IMAGE
-        // Insert at the end for simplicity, or implement sorting
-        item.iItem = ListView_GetItemCount(hwnd_list_view_);
-        item.lParam = static_cast<LPARAM>(addedInfo.pid); // Store PID directly!
-        item.pszText = const_cast<wchar_t *>(addedInfo.name.c_str());
+    for (const auto &addedInfo: updateData.added) {
+        insertItem(addedInfo);
+    }
+
+    // Re-enable redraw
+    SendMessageW(hwnd_list_view_, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hwnd_list_view_, nullptr, TRUE);
+}
 
-        // Get/Add Icon
-        int iconIdx = getOrAddIconIndex(addedInfo.path);
-        item.iImage = (iconIdx != -1) ? iconIdx : I_IMAGENONE;
+void ListViewManager::reload(const std::vector<ProcessInfo> &processes) {
+    SendMessageW(hwnd_list_view_, WM_SETREDRAW, FALSE, 0);
+    ListView_DeleteAllItems(hwnd_list_view_);
+    for (const ProcessInfo &info: processes) {
+        insertItem(info);
+    }
+    SendMessageW(hwnd_list_view_, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hwnd_list_view_, nullptr, TRUE);
+}
 
-        int newItemIndex = ListView_InsertItem(hwnd_list_view_, &item);
-        if (newItemIndex != -1) {
-            wchar_t buffer[64];
+void ListViewManager::insertItem(const ProcessInfo &addedInfo) {
+    LVITEMW item = {0};
+    item.mask = LVIF_TEXT | LVIF_PARAM | LVIF_IMAGE; // Include LVIF_IMAGE
+    // Insert at the end for simplicity, or implement sorting
+    item.iItem = ListView_GetItemCount(hwnd_list_view_);
+    item.lParam = static_cast<LPARAM>(addedInfo.pid); // Store PID directly!
+    item.pszText = const_cast<wchar_t *>(addedInfo.name.c_str());
 
-            // Set subitems for the newly added item
-            swprintf_s(buffer, L"%lu", addedInfo.pid);
-            ListView_SetItemText(hwnd_list_view_, newItemIndex, 1, buffer);
+    // Get/Add Icon
+    int iconIdx = getOrAddIconIndex(addedInfo.path);
+    item.iImage = (iconIdx != -1) ? iconIdx : I_IMAGENONE;
 
-            swprintf_s(buffer, L"%.1f %%", addedInfo.cpuUsage);
-            ListView_SetItemText(hwnd_list_view_, newItemIndex, 2, buffer);
+    int newItemIndex = ListView_InsertItem(hwnd_list_view_, &item);
+    if (newItemIndex != -1) {
+        wchar_t buffer[64];
 
-            swprintf_s(buffer, L"%llu KB", addedInfo.ramUsage / 1024);
-            ListView_SetItemText(hwnd_list_view_, newItemIndex, 3, buffer);
+        // Set subitems for the newly added item
+        swprintf_s(buffer, L"%lu", addedInfo.pid);
+        ListView_SetItemText(hwnd_list_view_, newItemIndex, 1, buffer);
 
-            swprintf_s(buffer, L"%.1f KB/s", addedInfo.ioRate / 1024.0);
-            ListView_SetItemText(hwnd_list_view_, newItemIndex, 4, buffer);
+        swprintf_s(buffer, L"%.1f %%", addedInfo.cpuUsage);
+        ListView_SetItemText(hwnd_list_view_, newItemIndex, 2, buffer);
 
-            ListView_SetItemText(hwnd_list_view_, newItemIndex, 5, const_cast<wchar_t*>(addedInfo.path.c_str()));
-        } else {
-            std::cerr << "UI Update: Failed to insert item for PID " << addedInfo.pid << std::endl;
-        }
-    }
+        swprintf_s(buffer, L"%llu KB", addedInfo.ramUsage / 1024);
+        ListView_SetItemText(hwnd_list_view_, newItemIndex, 3, buffer);
 
-    // Re-enable redraw
-    SendMessageW(hwnd_list_view_, WM_SETREDRAW, TRUE, 0);
-    InvalidateRect(hwnd_list_view_, nullptr, TRUE);
-    delete updateData;
+        swprintf_s(buffer, L"%.1f KB/s", addedInfo.ioRate / 1024.0);
+        ListView_SetItemText(hwnd_list_view_, newItemIndex, 4, buffer);
+
+        ListView_SetItemText(hwnd_list_view_, newItemIndex, 5, const_cast<wchar_t*>(addedInfo.path.c_str()));
+    } else {
+        std::cerr << "UI Update: Failed to insert item for PID " << addedInfo.pid << std::endl;
+    }
 }
 
-int ListViewManager::getOrAddIconIndex(const std::wstring& path) {
-     if (path.empty() || !image_list_) {
+int ListViewManager::getOrAddIconIndex(const std::wstring_view pathView) {
+     if (pathView.empty() || !image_list_) {
          return -1;
      }
 
-     if (const auto cacheIt = icon_cache_.find(path); cacheIt != icon_cache_.end()) {
+     if (const auto cacheIt = icon_cache_.find(pathView); cacheIt != icon_cache_.end()) {
         return cacheIt->second; // Found in cache
     }
+    const std::wstring path(pathView); // Shell APIs need a terminated string
 
     // Not in cache, try to extract icon
     HICON hIcon = nullptr;
@@ -1,6 +1,9 @@
 #ifndef ListViewManager_h
 #define ListViewManager_h
 #include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <windows.h>
 #include <commctrl.h>
 
@@ -18,15 +21,20 @@ public:
 
     void Resize(int parentWidth, int parentHeight) const;
 
-    void applyListViewUpdates(ProcessUpdateData *updateData);
+    void applyListViewUpdates(const ProcessUpdateData &updateData);
 
-    int getOrAddIconIndex(const std::wstring &path);
+    // Replace every row with `processes`.
+    void reload(const std::vector<ProcessInfo> &processes);
+
+    int getOrAddIconIndex(std::wstring_view path);
 
 private:
+    void insertItem(const ProcessInfo &info);
+
     HWND hwnd_parent_;
     HWND hwnd_list_view_;
     HIMAGELIST image_list_ = nullptr;
-    std::map<std::wstring, int> icon_cache_;
+    std::map<std::wstring, int, std::less<>> icon_cache_;
 };
 
 #endif
\ No newline at end of file
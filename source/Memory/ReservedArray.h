@@ -0,0 +1,80 @@
+#ifndef ReservedArray_h
+#define ReservedArray_h
+
+#include <windows.h>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+// A fixed-capacity array that only costs memory for the part in use.
+//
+// The whole capacity is reserved as address space up front, so elements
+// never move, but pages are committed only as commit() reaches them, in
+// steps of CommitStep bytes. Fresh pages read as zero, so T must be a type
+// for which all-zero bytes are a valid value. Not thread-safe.
+template<typename T>
+class ReservedArray {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+public:
+    static constexpr size_t CommitStep = 1 << 20;
+
+    ReservedArray() = default;
+
+    explicit ReservedArray(const size_t capacity) : capacity_(capacity) {
+        if (capacity_ != 0) {
+            data_ = static_cast<T *>(VirtualAlloc(nullptr, capacity_ * sizeof(T), MEM_RESERVE, PAGE_NOACCESS));
+            if (!data_) {
+                capacity_ = 0;
+            }
+        }
+    }
+
+    ~ReservedArray() {
+        if (data_) {
+            VirtualFree(data_, 0, MEM_RELEASE);
+        }
+    }
+
+    ReservedArray(ReservedArray &&other) noexcept { *this = std::move(other); }
+
+    ReservedArray &operator=(ReservedArray &&other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(committed_bytes_, other.committed_bytes_);
+        return *this;
+    }
+
+    ReservedArray(const ReservedArray &) = delete;
+    ReservedArray &operator=(const ReservedArray &) = delete;
+
+    // Makes the first `count` elements usable. False if the capacity is
+    // smaller or the system is out of commit.
+    bool commit(const size_t count) {
+        if (count > capacity_) {
+            return false;
+        }
+        const size_t wanted = count * sizeof(T);
+        if (wanted <= committed_bytes_) {
+            return true;
+        }
+        const size_t target = std::min((wanted + CommitStep - 1) / CommitStep * CommitStep, capacity_ * sizeof(T));
+        auto *start = reinterpret_cast<std::byte *>(data_) + committed_bytes_;
+        if (!VirtualAlloc(start, target - committed_bytes_, MEM_COMMIT, PAGE_READWRITE)) {
+            return false;
+        }
+        committed_bytes_ = target;
+        return true;
+    }
+
+    [[nodiscard]] T *data() const { return data_; }
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+    [[nodiscard]] size_t committedBytes() const { return committed_bytes_; }
+
+private:
+    T *data_ = nullptr;
+    size_t capacity_ = 0;
+    size_t committed_bytes_ = 0;  // a multiple of CommitStep, or the whole capacity
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "TickArena.h"
+
+void *TickArena::OverflowResource::do_allocate(const size_t bytes, const size_t alignment) {
+    borrowed += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void TickArena::OverflowResource::do_deallocate(void *p, const size_t bytes, const size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+TickArena::TickArena(const size_t initialBytes)
+    : buffer_(std::make_unique_for_overwrite<std::byte[]>(initialBytes)),
+      size_(initialBytes) {
+    arena_.emplace(buffer_.get(), size_, &overflow_);
+}
+
+void TickArena::reset() {
+    arena_->release();
+    if (overflow_.borrowed == 0) {
+        return;
+    }
+
+    // Grow with some headroom so a slowly growing table does not regrow every tick.
+    size_ = (size_ + overflow_.borrowed) / 4 * 5;
+    overflow_.borrowed = 0;
+    arena_.reset();
+    buffer_ = std::make_unique_for_overwrite<std::byte[]>(size_);
+    arena_.emplace(buffer_.get(), size_, &overflow_);
+}
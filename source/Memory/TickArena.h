@@ -0,0 +1,47 @@
+#ifndef TickArena_h
+#define TickArena_h
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Memory for data that only lives for one tick.
+//
+// Allocations bump a pointer through one buffer; reset() rewinds it instead of
+// freeing anything. A tick that outgrows the buffer takes the overflow from the
+// heap, and the following reset() grows the buffer to cover it, so a steady
+// workload settles at zero heap calls per tick. Not thread-safe.
+class TickArena {
+public:
+    explicit TickArena(size_t initialBytes = 256 * 1024);
+
+    TickArena(const TickArena &) = delete;
+    TickArena &operator=(const TickArena &) = delete;
+
+    [[nodiscard]] std::pmr::memory_resource *resource() { return &*arena_; }
+
+    // Everything allocated since the last reset() must be dead by now.
+    void reset();
+
+    [[nodiscard]] size_t capacity() const { return size_; }
+
+private:
+    // Heap fallback that remembers how much the arena had to borrow.
+    class OverflowResource final : public std::pmr::memory_resource {
+    public:
+        size_t borrowed = 0;
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+    };
+
+    std::unique_ptr<std::byte[]> buffer_;
+    size_t size_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+};
+
+#endif
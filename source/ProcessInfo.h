@@ -2,13 +2,23 @@
 #define ProcessInfo_h
 
 #include <chrono>
+#include <cstdint>
 #include <Windows.h>
+#include <memory_resource>
 #include <string>
 
+// Strings are std::pmr so a collector can build its per-tick table inside an
+// arena. Plain copies always land on the default heap, so a ProcessInfo copied
+// out of a tick's table never refers to arena memory; moving one out does.
 struct ProcessInfo {
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
     DWORD pid = 0;
-    std::wstring name;
-    std::wstring path;
+    DWORD parentPid = 0;  // as reported at creation; may name an exited (or reused) PID
+    uint64_t createTime = 0;  // FILETIME; 0 when the source does not know it
+    std::pmr::wstring name;
+    std::pmr::wstring path;
+    std::pmr::wstring commandLine;
     double cpuUsage = 0.0;
     SIZE_T ramUsage = 0;
     double ioRate = 0.0;
@@ -18,13 +28,57 @@ struct ProcessInfo {
     ProcessInfo() = default;
 
     explicit ProcessInfo(const DWORD id) : pid(id), lastUpdateTime(std::chrono::steady_clock::now()){}
+
+    ProcessInfo(const ProcessInfo &) = default;
+    ProcessInfo(ProcessInfo &&) = default;
+    ProcessInfo &operator=(const ProcessInfo &) = default;
+    ProcessInfo &operator=(ProcessInfo &&) = default;
+
+    // Allocator-extended forms, used by pmr containers.
+    explicit ProcessInfo(const allocator_type &alloc) : name(alloc), path(alloc), commandLine(alloc) {}
+
+    ProcessInfo(const DWORD id, const allocator_type &alloc)
+        : pid(id), name(alloc), path(alloc), commandLine(alloc), lastUpdateTime(std::chrono::steady_clock::now()) {}
+
+    ProcessInfo(const ProcessInfo &other, const allocator_type &alloc)
+        : pid(other.pid), parentPid(other.parentPid), createTime(other.createTime),
+          name(other.name, alloc), path(other.path, alloc), commandLine(other.commandLine, alloc),
+          cpuUsage(other.cpuUsage), ramUsage(other.ramUsage), ioRate(other.ioRate),
+          iconIndex(other.iconIndex), lastUpdateTime(other.lastUpdateTime) {}
+
+    ProcessInfo(ProcessInfo &&other, const allocator_type &alloc)
+        : pid(other.pid), parentPid(other.parentPid), createTime(other.createTime),
+          name(std::move(other.name), alloc), path(std::move(other.path), alloc),
+          commandLine(std::move(other.commandLine), alloc),
+          cpuUsage(other.cpuUsage), ramUsage(other.ramUsage), ioRate(other.ioRate),
+          iconIndex(other.iconIndex), lastUpdateTime(other.lastUpdateTime) {}
+};
+
+// An existing process whose metrics moved past their change threshold. Only
+// the values whose bit is set in `changed` are meaningful; names and paths
+// never change for a PID (a reused PID is reported as removed + added).
+struct ProcessDelta {
+    enum Field : uint8_t {
+        Cpu = 1u << 0,
+        Ram = 1u << 1,
+        Io = 1u << 2,
+    };
+
+    DWORD pid = 0;
+    uint8_t changed = 0;
+    double cpuUsage = 0.0;
+    SIZE_T ramUsage = 0;
+    double ioRate = 0.0;
 };
 
 #include <vector>
 struct ProcessUpdateData {
     std::vector<ProcessInfo> added;
     std::vector<DWORD> removed_pids;
-    std::vector<ProcessInfo> updated;
+    std::vector<ProcessDelta> updated;
+    // Started and exited between ticks; never part of the table, so they are
+    // not in `added` or `removed_pids`.
+    std::vector<ProcessInfo> transient;
 };
 
 #endif
\ No newline at end of file
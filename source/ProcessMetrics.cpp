@@ -3,6 +3,7 @@
 #include <chrono>
 #include <iostream>
 #include <ranges>
+#include <vector>
 
 using namespace std::chrono;
 
@@ -117,20 +118,28 @@ std::optional<double> ProcessMetrics::GetCpuUsage(DWORD pid)
     if (!GetProcessTimes(s.hProcess,&c,&e,&k,&u))
         return std::nullopt;
 
-    uint64_t cpu  = FileTimeToUint(k)+FileTimeToUint(u);
-    uint64_t wall = FileTimeToUint(nowFt);
+    return CpuPercent(s.cpu, k, u, nowFt);
+}
+
+std::optional<double> ProcessMetrics::CpuPercent(CpuSample& prev, const FILETIME& kernel,
+                                                 const FILETIME& user, const FILETIME& now)
+{
+    return CpuPercent(prev, FileTimeToUint(kernel)+FileTimeToUint(user), FileTimeToUint(now));
+}
 
-    if (s.wallTime == 0) {              // first call → prime snapshot
-        s.wallTime = wall;
-        s.cpuTime  = cpu;
+std::optional<double> ProcessMetrics::CpuPercent(CpuSample& prev, uint64_t cpu, uint64_t wall)
+{
+    if (prev.wallTime == 0) {           // first call → prime snapshot
+        prev.wallTime = wall;
+        prev.cpuTime  = cpu;
         return std::nullopt;
     }
 
-    uint64_t cpuDelta  = cpu  - s.cpuTime;
-    uint64_t wallDelta = wall - s.wallTime;
+    uint64_t cpuDelta  = cpu  - prev.cpuTime;
+    uint64_t wallDelta = wall - prev.wallTime;
 
-    s.cpuTime  = cpu;
-    s.wallTime = wall;
+    prev.cpuTime  = cpu;
+    prev.wallTime = wall;
 
     if (wallDelta == 0) return std::nullopt;
     return (cpuDelta / static_cast<double>(wallDelta)) * 100.0 / NumProcessors();
@@ -148,6 +157,39 @@ std::optional<size_t> ProcessMetrics::GetMemoryUsage(DWORD pid)
     return static_cast<size_t>(pmc.WorkingSetSize);
 }
 
+std::optional<std::wstring> ProcessMetrics::GetProcessCommandLine(DWORD pid)
+{
+    // ProcessCommandLineInformation (Windows 8.1+): a UNICODE_STRING followed by its buffer.
+    constexpr ULONG ProcessCommandLineInformation = 60;
+    struct CommandLineString { USHORT Length; USHORT MaximumLength; PWSTR Buffer; };
+    using NtQueryInformationProcessPtr = LONG(WINAPI*)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+
+    static const auto query = []{
+        HMODULE hMod = ::GetModuleHandleW(L"ntdll.dll");
+        return hMod ? reinterpret_cast<NtQueryInformationProcessPtr>(
+                          ::GetProcAddress(hMod, "NtQueryInformationProcess"))
+                    : nullptr;
+    }();
+    if (!query) return std::nullopt;
+
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return std::nullopt;
+
+    ULONG needed = 0;
+    std::vector<std::byte> buffer(sizeof(CommandLineString) + 512);
+    LONG status = query(h, ProcessCommandLineInformation, buffer.data(), static_cast<ULONG>(buffer.size()), &needed);
+    if (status < 0 && needed > buffer.size()) {
+        buffer.resize(needed);
+        status = query(h, ProcessCommandLineInformation, buffer.data(), static_cast<ULONG>(buffer.size()), &needed);
+    }
+    CloseHandle(h);
+    if (status < 0) return std::nullopt;
+
+    const auto* str = reinterpret_cast<const CommandLineString*>(buffer.data());
+    if (!str->Buffer) return std::wstring();
+    return std::wstring(str->Buffer, str->Length / sizeof(wchar_t));
+}
+
 std::optional<size_t> ProcessMetrics::GetDiskReadBytesPerSec(DWORD pid)
 {
     std::scoped_lock lk(mtx_);
@@ -3,6 +3,7 @@
 
 #include <windows.h>
 #include <optional>
+#include <string>
 #include <unordered_map>
 #include <mutex>
 
@@ -26,16 +27,33 @@ public:
     // ---- per‑process queries -----------------------------------------------
     std::optional<double> GetCpuUsage(DWORD pid);          // %
     static std::optional<size_t> GetMemoryUsage(DWORD pid);// bytes
+    static std::optional<std::wstring> GetProcessCommandLine(DWORD pid);
     std::optional<size_t> GetDiskReadBytesPerSec(DWORD pid);
     std::optional<size_t> GetDiskWriteBytesPerSec(DWORD pid);
     std::optional<size_t> GetDiskIOBytesPerSec(DWORD pid);
 
+    // ---- shared rate machinery ----------------------------------------------
+    /// Previous kernel+user sample of one process or thread.
+    struct CpuSample
+    {
+        uint64_t wallTime = 0;          // last sample, 100‑ns
+        uint64_t cpuTime  = 0;          // kernel+user, 100‑ns
+    };
+
+    /// % of the whole machine since `prev` (updated in place); nullopt on the
+    /// first (priming) sample.
+    static std::optional<double> CpuPercent(CpuSample& prev, const FILETIME& kernel,
+                                            const FILETIME& user, const FILETIME& now);
+    /// Same, from kernel+user and wall time already in 100‑ns units.
+    static std::optional<double> CpuPercent(CpuSample& prev, uint64_t cpuTime, uint64_t wallTime);
+    /// Logical processors the percentages are normalised by.
+    static uint32_t NumProcessors();
+
 private:
     struct Snapshot
     {
         HANDLE   hProcess  = nullptr;   // owned (must CloseHandle)
-        uint64_t wallTime  = 0;         // last sample, 100‑ns
-        uint64_t cpuTime   = 0;         // kernel+user, 100‑ns
+        CpuSample cpu;
         uint64_t readBytes = 0;         // cumulative
         uint64_t writeBytes= 0;         // cumulative
         FILETIME lastIoWall{};          // helper for B/s maths
@@ -43,7 +61,6 @@ private:
 
     // helpers ----------------------------------------------------------------
     static uint64_t FileTimeToUint(const FILETIME& ft);
-    static uint32_t NumProcessors();
 
     static size_t          IoRate(uint64_t cur, uint64_t& prevBytes, FILETIME& prevWall);
     Snapshot&       Ensure(DWORD pid);
@@ -1,30 +1,44 @@
 #include "ProcessMonitor.h"
-#include <tlhelp32.h>
-#include <shlwapi.h>
 #include <chrono>
 #include <iostream>
 
-#include "HandleWrapper.h"
 #include "ProcessInfo.h"
 #include "TasksIDDef.h"
+#include "Collection/LiveProcessSource.h"
 #include "Concurrency/TaskManager.h"
+#include "Recording/SnapshotRecorder.h"
 
 using namespace std::chrono_literals;
 
-ProcessMonitor::ProcessMonitor(TaskManager &taskManager, const HWND hMainWindow, const HWND hListView)
+ProcessMonitor::ProcessMonitor(TaskManager &taskManager, const HWND hMainWindow, const HWND hListView,
+                               std::unique_ptr<ProcessSource> source, const std::chrono::milliseconds interval)
     : task_manager_(taskManager),
       hwnd_main_window_(hMainWindow),
-      hwnd_list_view_(hListView) {
-    if (!IsWindow(hwnd_main_window_) || !IsWindow(hwnd_list_view_)) {
+      hwnd_list_view_(hListView),
+      source_(source ? std::move(source) : std::make_unique<LiveProcessSource>()) {
+    if ((hwnd_main_window_ && !IsWindow(hwnd_main_window_)) || (hwnd_list_view_ && !IsWindow(hwnd_list_view_))) {
         std::cerr << "Invalid window or list view handle" << std::endl;
     }
 
+    MEMORYSTATUSEX memory{sizeof(memory)};
+    if (GlobalMemoryStatusEx(&memory)) {
+        LeakDetector::Config leakConfig;
+        leakConfig.budgetBytes = memory.ullTotalPhys;
+        leaks_.setConfig(leakConfig);
+    }
+
+    source_->setLifecycleNotify([this] { onLifecycleNotify(); });
+
+    if (interval <= 0ms) {
+        return;
+    }
+
     try {
         monitoring_task_id_ = task_manager_.addTask(
             ProcessMonitorScheduledUpdateTaskID,
             "Process Monitor Update", // Task name
             [this](const std::stop_token &st) { this->scheduledUpdateProcesses(st); },
-            1000ms
+            interval
         );
     } catch (...) {
         std::cerr << "Something went wrong when creating new task" << std::endl;
@@ -34,10 +48,28 @@ ProcessMonitor::ProcessMonitor(TaskManager &taskManager, const HWND hMainWindow,
 
 ProcessMonitor::~ProcessMonitor() {
     stopMonitoring();
+    // Blocks until no notification is still running against this monitor.
+    source_->setLifecycleNotify(nullptr);
+    // And until a tick the pool had already started is done.
+    const std::lock_guard tickLock(tick_mutex_);
+    bus_->close();
 }
 
 void ProcessMonitor::stopMonitoring() {
     stop_source_.request_stop();
+    if (monitoring_task_id_ != static_cast<TaskId>(-1)) {
+        task_manager_.removeTask(monitoring_task_id_);
+        monitoring_task_id_ = -1;
+    }
+}
+
+void ProcessMonitor::pollOnce() {
+    scheduledUpdateProcesses(stop_source_.get_token());
+}
+
+void ProcessMonitor::setUpdateCallback(UpdateCallback callback) {
+    std::unique_lock lock(processes_mutex_);
+    update_callback_ = callback ? std::make_shared<const UpdateCallback>(std::move(callback)) : nullptr;
 }
 
 const ProcessInfo *ProcessMonitor::getProcessInfo(const DWORD pid) const {
@@ -45,152 +77,480 @@ const ProcessInfo *ProcessMonitor::getProcessInfo(const DWORD pid) const {
     return (it != processes_.end()) ? &it->second : nullptr;
 }
 
-void ProcessMonitor::scheduledUpdateProcesses(const std::stop_token &st) {
-    HandleWrapper hSnapshot(CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0));
-    if (!hSnapshot.isValid()) {
+std::vector<double> ProcessMonitor::getHistory(const DWORD pid, const MetricHistory::Metric metric) const {
+    std::shared_lock lock(processes_mutex_);
+    return history_.getSeries(pid, metric);
+}
+
+std::vector<RollupStore::Bucket> ProcessMonitor::getRollup(const DWORD pid, const MetricHistory::Metric metric,
+                                                           const std::chrono::seconds resolution) const {
+    std::shared_lock lock(processes_mutex_);
+    if (RollupStore::tierFor(resolution) >= 0) {
+        return rollups_.query(pid, metric, resolution);
+    }
+
+    std::vector<RollupStore::Bucket> buckets;
+    for (const double value: history_.getSeries(pid, metric)) {
+        const auto v = static_cast<float>(value);
+        buckets.push_back(RollupStore::Bucket{v, v, v, v, 0});
+    }
+    return buckets;
+}
+
+std::vector<TopKTracker::Entry> ProcessMonitor::getTopK(const MetricHistory::Metric metric, const size_t k) const {
+    std::shared_lock lock(processes_mutex_);
+    return top_k_.topK(metric, k);
+}
+
+std::optional<ProcessTree::Totals> ProcessMonitor::getSubtree(const DWORD pid) const {
+    std::shared_lock lock(processes_mutex_);
+    return tree_.subtree(pid);
+}
+
+std::vector<ProcessTree::Subtree> ProcessMonitor::getChildren(const DWORD pid) const {
+    std::shared_lock lock(processes_mutex_);
+    return pid == 0 ? tree_.roots() : tree_.children(pid);
+}
+
+std::vector<LeakDetector::Estimate> ProcessMonitor::getLeakSuspects() const {
+    std::shared_lock lock(processes_mutex_);
+    return leaks_.suspects();
+}
+
+std::optional<LeakDetector::Estimate> ProcessMonitor::getLeakEstimate(const DWORD pid) const {
+    std::shared_lock lock(processes_mutex_);
+    return leaks_.estimate(pid);
+}
+
+void ProcessMonitor::setLeakDetectorConfig(const LeakDetector::Config &config) {
+    std::unique_lock lock(processes_mutex_);
+    leaks_.setConfig(config);
+}
+
+void ProcessMonitor::expandThreads(const DWORD pid) {
+    if (ThreadSampler *sampler = source_->threadSampler()) {
+        sampler->expand(pid);
+    }
+}
+
+void ProcessMonitor::collapseThreads(const DWORD pid) {
+    if (ThreadSampler *sampler = source_->threadSampler()) {
+        sampler->collapse(pid);
+    }
+}
+
+std::vector<ThreadInfo> ProcessMonitor::getThreads(const DWORD pid) const {
+    if (ThreadSampler *sampler = source_->threadSampler()) {
+        return sampler->getThreads(pid);
+    }
+    return {};
+}
+
+std::optional<MemoryBreakdown> ProcessMonitor::getMemoryBreakdown(const DWORD pid) {
+    if (MemoryProbe *probe = source_->memoryProbe()) {
+        return probe->get(pid);
+    }
+    return std::nullopt;
+}
+
+std::optional<SystemSample> ProcessMonitor::getSystemSample() const {
+    std::shared_lock lock(processes_mutex_);
+    if (system_sample_.time == std::chrono::steady_clock::time_point{}) {
+        return std::nullopt;
+    }
+    return system_sample_;
+}
+
+std::vector<double> ProcessMonitor::getSystemHistory(const SystemHistory::Series series) const {
+    std::shared_lock lock(processes_mutex_);
+    return system_history_.getSeries(series);
+}
+
+std::vector<double> ProcessMonitor::getCoreHistory(const size_t core) const {
+    std::shared_lock lock(processes_mutex_);
+    return system_history_.getCoreSeries(core);
+}
+
+void ProcessMonitor::setMemoryBreakdownTopN(const size_t n) {
+    memory_top_n_.store(n);
+}
+
+std::optional<QueryEngine::QueryId> ProcessMonitor::addStandingQuery(const std::wstring_view text,
+                                                                     QueryEngine::Callback callback,
+                                                                     std::string *error) {
+    auto query = Query::compile(text, error);
+    if (!query) {
+        return std::nullopt;
+    }
+    std::unique_lock lock(processes_mutex_);
+    return queries_.subscribe(std::move(*query), std::move(callback));
+}
+
+void ProcessMonitor::removeStandingQuery(const QueryEngine::QueryId id) {
+    std::unique_lock lock(processes_mutex_);
+    queries_.unsubscribe(id);
+}
+
+std::vector<DWORD> ProcessMonitor::getQueryMatches(const QueryEngine::QueryId id) const {
+    std::shared_lock lock(processes_mutex_);
+    return queries_.matches(id);
+}
+
+std::optional<std::vector<DWORD>> ProcessMonitor::runQuery(const std::wstring_view text, std::string *error) const {
+    auto query = Query::compile(text, error);
+    if (!query) {
+        return std::nullopt;
+    }
+    std::shared_lock lock(processes_mutex_);
+    return queries_.run(*query);
+}
+
+std::optional<AlertEngine::RuleId> ProcessMonitor::addAlertRule(const std::wstring_view text, std::string *error) {
+    auto rule = AlertRule::compile(text, error);
+    if (!rule) {
+        return std::nullopt;
+    }
+    std::unique_lock lock(processes_mutex_);
+    return alerts_.addRule(std::move(*rule), processes_, std::chrono::steady_clock::now());
+}
+
+void ProcessMonitor::removeAlertRule(const AlertEngine::RuleId id) {
+    std::unique_lock lock(processes_mutex_);
+    alerts_.removeRule(id);
+}
+
+uint32_t ProcessMonitor::addAlertSink(AlertSink sink) {
+    std::unique_lock lock(processes_mutex_);
+    auto sinks = alert_sinks_ ? std::make_shared<AlertSinks>(*alert_sinks_) : std::make_shared<AlertSinks>();
+    const uint32_t id = next_sink_id_++;
+    sinks->emplace_back(id, std::move(sink));
+    alert_sinks_ = std::move(sinks);
+    return id;
+}
+
+void ProcessMonitor::removeAlertSink(const uint32_t id) {
+    std::unique_lock lock(processes_mutex_);
+    if (!alert_sinks_) {
         return;
     }
+    auto sinks = std::make_shared<AlertSinks>(*alert_sinks_);
+    std::erase_if(*sinks, [id](const auto &entry) { return entry.first == id; });
+    alert_sinks_ = sinks->empty() ? nullptr : std::move(sinks);
+}
+
+std::vector<DWORD> ProcessMonitor::search(const std::wstring_view text, const uint32_t fields, const size_t limit) const {
+    std::shared_lock lock(processes_mutex_);
+    return search_.search(text, fields, limit);
+}
+
+void ProcessMonitor::setChangeThresholds(const ChangeThresholds &thresholds) {
+    std::unique_lock lock(processes_mutex_);
+    thresholds_ = thresholds;
+}
+
+void ProcessMonitor::setRecorder(std::shared_ptr<SnapshotRecorder> recorder) {
+    std::unique_lock lock(processes_mutex_);
+    if (recorder) {
+        recorder->seed(processes_);
+    }
+    recorder_ = std::move(recorder);
+}
 
-    PROCESSENTRY32W pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32W);
+// A creation time tells a reused PID apart even when the new process runs the
+// same image with the same command line and parent.
+bool ProcessMonitor::sameIdentity(const ProcessInfo &a, const ProcessInfo &b) {
+    return a.parentPid == b.parentPid && a.name == b.name && a.path == b.path && a.commandLine == b.commandLine &&
+           (a.createTime == 0 || b.createTime == 0 || a.createTime == b.createTime);
+}
+
+// A value returning to exactly zero is always published, so idle processes do
+// not stay frozen just above zero.
+bool ProcessMonitor::crossed(const double current, const double published, const double threshold) {
+    return current != published && (std::abs(current - published) > threshold || current == 0.0);
+}
+
+void ProcessMonitor::trackProcess(const ProcessInfo &info) {
+    processes_.emplace(info.pid, info);
+    published_[info.pid] = PublishedMetrics{info.cpuUsage, info.ramUsage, info.ioRate};
+    history_.track(info.pid);
+    rollups_.track(info.pid);
+    top_k_.add(info);
+    tree_.add(info);
+    search_.add(info);
+}
 
-    if (!Process32FirstW(hSnapshot, &pe32)) {
+void ProcessMonitor::releaseProcess(const DWORD pid) {
+    published_.erase(pid);
+    source_->onProcessRemoved(pid);
+    history_.release(pid);
+    rollups_.release(pid);
+    top_k_.remove(pid);
+    tree_.remove(pid);
+    leaks_.remove(pid);
+    search_.remove(pid);
+}
+
+void ProcessMonitor::scheduledUpdateProcesses(const std::stop_token &st) {
+    if (stop_source_.stop_requested()) {
         return;
     }
+    updateProcesses(st);
+    // Lifecycle events that came in while the tick held the lock.
+    if (lifecycle_pending_.load()) {
+        onLifecycleNotify();
+    }
+    refreshMemoryBreakdowns();
+}
 
-    std::unordered_map<DWORD, ProcessInfo> currentSystemProcesses;
-    const auto now = std::chrono::steady_clock::now();
+// After publishing, so the walks never delay an update. Most calls are cache hits.
+void ProcessMonitor::refreshMemoryBreakdowns() {
+    MemoryProbe *probe = source_->memoryProbe();
+    const size_t n = memory_top_n_.load();
+    if (!probe || n == 0) {
+        return;
+    }
 
-    do {
-        if (st.stop_requested()) {
+    std::vector<TopKTracker::Entry> largest;
+    {
+        std::shared_lock lock(processes_mutex_);
+        largest = top_k_.topK(MetricHistory::Metric::Ram, n);
+    }
+    for (const TopKTracker::Entry &entry: largest) {
+        probe->get(entry.pid);
+    }
+}
+
+// Runs on whichever thread the source reports from. Only one thread drains at a
+// time; the others leave the flag set for it (or for the tick holding the lock).
+void ProcessMonitor::onLifecycleNotify() {
+    lifecycle_pending_.store(true);
+    while (lifecycle_pending_.load() && !stop_source_.stop_requested()) {
+        std::unique_lock tickLock(tick_mutex_, std::try_to_lock);
+        if (!tickLock.owns_lock()) {
             return;
         }
-        DWORD pid = pe32.th32ProcessID;
-        if (pid == 0) {
-            continue;
-        }
+        lifecycle_pending_.store(false);
+        publishLifecycle();
+    }
+}
 
-        ProcessInfo currentInfo;
-        currentInfo.pid = pid;
-        currentInfo.name = pe32.szExeFile;
+// Publishes starts and exits between ticks, so consumers see an exit when it
+// happens rather than at the next tick. Metrics for started processes follow
+// with the next tick.
+void ProcessMonitor::publishLifecycle() {
+    source_->drainLifecycle(lifecycle_changes_);
+    if (lifecycle_changes_.started.empty() && lifecycle_changes_.exited.empty() &&
+        lifecycle_changes_.transient.empty()) {
+        return;
+    }
 
-        HandleWrapper hProcess(OpenProcess(
-                PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ,
-                FALSE,
-                pid
-            )
-        );
+    UpdateBatch updateData = batch_pool_->acquire();
+    std::unique_lock lock(processes_mutex_);
 
-        if (hProcess.isValid()) {
-            wchar_t path[MAX_PATH];
-            DWORD size = MAX_PATH;
-            if (QueryFullProcessImageNameW(hProcess, 0, path, &size)) {
-                currentInfo.path = path;
-            }
-            CloseHandle(hProcess);
+    for (const DWORD pid: lifecycle_changes_.exited) {
+        if (processes_.erase(pid)) {
+            updateData->removed_pids.push_back(pid);
+            releaseProcess(pid);
         }
+    }
+    for (const ProcessInfo &info: lifecycle_changes_.started) {
+        if (!processes_.contains(info.pid)) {
+            trackProcess(info);
+            updateData->added.push_back(info);
+        }
+    }
+    std::swap(updateData->transient, lifecycle_changes_.transient);
+    lifecycle_changes_.started.clear();
+    lifecycle_changes_.exited.clear();
+
+    tree_.endTick();
+    search_.endTick();
+    const std::vector<QueryEngine::Change> queryChanges = queries_.applyTick(*updateData);
+    alert_events_.clear();
+    alerts_.applyTick(*updateData, std::chrono::steady_clock::now(), alert_events_);
+    std::shared_ptr<SnapshotRecorder> recorder;
+    if (recorder_ && (!updateData->added.empty() || !updateData->removed_pids.empty())) {
+        recorder = recorder_;
+        recorder->capture(processes_);
+    }
+    std::shared_ptr<const UpdateBus::Snapshot> snapshot = snapshotIfWanted();
+    const std::shared_ptr<const UpdateCallback> callback = update_callback_;
+    const std::shared_ptr<const AlertSinks> alertSinks = alert_sinks_;
+    lock.unlock();
+
+    if (recorder) {
+        recorder->commit(*updateData);
+    }
 
-        currentInfo.cpuUsage = 0.0;
-        currentInfo.ioRate = 0.0;
-        currentInfo.ramUsage = 3;
-        currentInfo.iconIndex = -1;
+    publish(std::move(updateData), std::move(snapshot), callback, queryChanges, alertSinks);
+}
 
-        currentSystemProcesses[pid] = std::move(currentInfo);
-    } while (Process32NextW(hSnapshot, &pe32));
+void ProcessMonitor::updateProcesses(const std::stop_token &st) {
+    // Ticks can overlap when one runs longer than the interval; skip instead of piling up.
+    const std::unique_lock tickLock(tick_mutex_, std::try_to_lock);
+    if (!tickLock.owns_lock()) {
+        return;
+    }
 
-    auto updateData = std::make_unique<ProcessUpdateData>();
-    std::vector<DWORD> currentPids;
+    // Everything transient below lives in the tick arena; the previous tick's
+    // table is dead by now, so rewinding it is safe.
+    tick_arena_.reset();
+    CollectedProcesses currentSystemProcesses(tick_arena_.resource());
+    {
+        std::shared_lock lock(processes_mutex_);
+        currentSystemProcesses.reserve(processes_.size() + processes_.size() / 8 + 16);
+    }
+    if (!source_->collect(currentSystemProcesses, st) || st.stop_requested()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    UpdateBatch updateData = batch_pool_->acquire();
 
     std::unique_lock lock(processes_mutex_);
 
+    if (SystemSampler *sampler = source_->systemSampler()) {
+        // A failed read leaves the previous sample in place; record each one once.
+        const auto previous = system_sample_.time;
+        if (sampler->latest(system_sample_) && system_sample_.time != previous) {
+            system_history_.append(system_sample_);
+        }
+    }
+
     for (auto &[pid, currentInfo]: currentSystemProcesses) {
-        currentPids.push_back(pid);
-        p_metrics_.RefreshAllData();
+        auto it = processes_.find(pid);
+        if (it != processes_.end() && !sameIdentity(it->second, currentInfo)) {
+            // The PID was reused: report a removal plus an addition, so names
+            // and paths only ever travel with added records.
+            updateData->removed_pids.push_back(pid);
+            processes_.erase(it);
+            releaseProcess(pid);
+            it = processes_.end();
+        }
 
         // ADDED
-        if (auto it = processes_.find(pid); it == processes_.end()) {
-            currentInfo.cpuUsage = 0.0;
-            currentInfo.ioRate = 0.0;
-            currentInfo.ramUsage = 1;
-            processes_.emplace(pid, currentInfo);
-            p_metrics_.AddProcess(pid);
+        if (it == processes_.end()) {
+            trackProcess(currentInfo);
+            // The first sample; a process seen for only one tick has just this.
+            history_.append(pid, currentInfo.cpuUsage, currentInfo.ramUsage, currentInfo.ioRate);
+            rollups_.add(pid, now, currentInfo.cpuUsage, currentInfo.ramUsage);
+            leaks_.add(pid, now, currentInfo.ramUsage);
             updateData->added.push_back(currentInfo);
-        } else {
-            ProcessInfo &previousInfo = it->second;
-
-            if (
-                auto timeDelta = std::chrono::duration<double>((now - previousInfo.lastUpdateTime).count());
-                timeDelta.count() > 0
-            ) {
-                if (
-                    const auto cpuUsage = p_metrics_.GetCpuUsage(pid);
-                    cpuUsage.has_value()
-                ) {
-                    currentInfo.cpuUsage = cpuUsage.value();
-                }
-                if (
-                    const auto ramUsage = p_metrics_.GetMemoryUsage(pid);
-                    ramUsage.has_value()
-                ) {
-                    currentInfo.ramUsage = ramUsage.value();
-                }
-                if (
-                    const auto diskUsage = p_metrics_.GetDiskIOBytesPerSec(pid);
-                    diskUsage.has_value()
-                ) {
-                    currentInfo.ioRate = diskUsage.value();
-                }
-            } else {
-                currentInfo.cpuUsage = previousInfo.cpuUsage;
-                currentInfo.ramUsage = previousInfo.ramUsage;
-                currentInfo.ioRate = previousInfo.ioRate;
-            }
+            continue;
+        }
 
-            const bool changed = previousInfo.name != currentInfo.name ||
-                                 previousInfo.path != currentInfo.path ||
-                                 previousInfo.ramUsage != currentInfo.ramUsage ||
-                                 std::abs(previousInfo.cpuUsage - currentInfo.cpuUsage) > 0.1 ||
-                                 // Threshold for CPU change
-                                 std::abs(previousInfo.ioRate - currentInfo.ioRate) > 1024;
-            // Threshold for I/O change (e.g., 1KB/s)
+        // UPDATED: publish each metric that moved past its threshold since it
+        // was last published.
+        ProcessInfo &info = it->second;
+        PublishedMetrics &published = published_[pid];
+        ProcessDelta delta{pid};
+        if (crossed(currentInfo.cpuUsage, published.cpuUsage, thresholds_.cpu)) {
+            delta.changed |= ProcessDelta::Cpu;
+            delta.cpuUsage = published.cpuUsage = currentInfo.cpuUsage;
+        }
+        if (crossed(static_cast<double>(currentInfo.ramUsage), static_cast<double>(published.ramUsage),
+                    thresholds_.ramBytes)) {
+            delta.changed |= ProcessDelta::Ram;
+            delta.ramUsage = published.ramUsage = currentInfo.ramUsage;
+        }
+        if (crossed(currentInfo.ioRate, published.ioRate, thresholds_.ioBytesPerSec)) {
+            delta.changed |= ProcessDelta::Io;
+            delta.ioRate = published.ioRate = currentInfo.ioRate;
+        }
 
-            previousInfo = currentInfo;
+        history_.append(pid, currentInfo.cpuUsage, currentInfo.ramUsage, currentInfo.ioRate);
+        rollups_.add(pid, now, currentInfo.cpuUsage, currentInfo.ramUsage);
+        leaks_.add(pid, now, currentInfo.ramUsage);
+        info.cpuUsage = currentInfo.cpuUsage;
+        info.ramUsage = currentInfo.ramUsage;
+        info.ioRate = currentInfo.ioRate;
+        info.lastUpdateTime = currentInfo.lastUpdateTime;
 
-            if (changed) {
-                updateData->updated.push_back(currentInfo);
-            }
+        if (delta.changed) {
+            top_k_.update(delta);
+            tree_.update(delta);
+            updateData->updated.push_back(delta);
         }
     }
     // DELETED
     for (auto it = processes_.begin(); it != processes_.end();) {
-        DWORD pid = it->first;
-        bool found = false;
-        for (DWORD currentPid: currentPids) {
-            if (pid == currentPid) {
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
+        if (const DWORD pid = it->first; !currentSystemProcesses.contains(pid)) {
             // Process Removed(closed, killed or else)
             updateData->removed_pids.push_back(pid);
             it = processes_.erase(it); // Remove from our internal map
-            p_metrics_.RemoveProcess(pid);
+            releaseProcess(pid);
         } else {
             ++it; // Only increment if not erased
         }
     }
+    tree_.endTick();
+    search_.endTick();
+    const std::vector<QueryEngine::Change> queryChanges = queries_.applyTick(*updateData);
+    alert_events_.clear();
+    alerts_.applyTick(*updateData, now, alert_events_);
+    // Only the column copy happens under the lock; the recorder encodes and
+    // writes once readers are let back in.
+    const std::shared_ptr<SnapshotRecorder> recorder = recorder_;
+    if (recorder) {
+        recorder->capture(processes_);
+    }
+    std::shared_ptr<const UpdateBus::Snapshot> snapshot = snapshotIfWanted();
+    const std::shared_ptr<const UpdateCallback> callback = update_callback_;
+    const std::shared_ptr<const AlertSinks> alertSinks = alert_sinks_;
     lock.unlock();
 
-    if (!updateData->added.empty() || !updateData->removed_pids.empty() || !updateData->updated.empty()) {
-        if (
-            ProcessUpdateData *rawDataPtr = updateData.release();
-            !PostMessageW(hwnd_main_window_, WM_APP + 104, 0, reinterpret_cast<LPARAM>(rawDataPtr))
-        ) {
-            std::cerr << "ProcessMonitor: Failed to post WM_PROCESS_UPDATE message. Error: " << GetLastError() <<
-                    std::endl;
-            delete rawDataPtr; // Manually delete if PostMessage failed
+    if (recorder) {
+        recorder->commit(*updateData);
+    }
+
+    publish(std::move(updateData), std::move(snapshot), callback, queryChanges, alertSinks);
+}
+
+// Called with processes_mutex_ held, so the copy matches the tick's diff.
+std::shared_ptr<const UpdateBus::Snapshot> ProcessMonitor::snapshotIfWanted() const {
+    if (!bus_->snapshotWanted()) {
+        return nullptr;
+    }
+    auto snapshot = std::make_shared<UpdateBus::Snapshot>();
+    snapshot->reserve(processes_.size());
+    for (const auto &[pid, info]: processes_) {
+        snapshot->push_back(info);
+    }
+    return snapshot;
+}
+
+void ProcessMonitor::publish(UpdateBatch updateData, std::shared_ptr<const UpdateBus::Snapshot> snapshot,
+                             const std::shared_ptr<const UpdateCallback> &callback,
+                             const std::vector<QueryEngine::Change> &queryChanges,
+                             const std::shared_ptr<const AlertSinks> &alertSinks) {
+    for (const auto &change: queryChanges) {
+        change.callback(change.entered, change.left);
+    }
+    // Durations can complete on a tick that reports nothing, so this comes
+    // before the empty-batch check.
+    if (alertSinks) {
+        for (const AlertEvent &event: alert_events_) {
+            for (const auto &[id, sink]: *alertSinks) {
+                sink(event);
+            }
         }
     }
+
+    const bool empty = updateData->added.empty() && updateData->removed_pids.empty() &&
+                       updateData->updated.empty() && updateData->transient.empty();
+    if (empty && !snapshot) {
+        return;
+    }
+    if (callback && !empty) {
+        (*callback)(*updateData);
+    }
+    // The batch returns to the pool once the ring and every reader let go of it.
+    bus_->publish(std::move(updateData), std::move(snapshot));
+
+    // Carries nothing; the window reads its subscription, so a busy UI thread
+    // skips ahead instead of working through a backlog of stale batches.
+    if (hwnd_main_window_ && !PostMessageW(hwnd_main_window_, WM_APP + 104, 0, 0)) {
+        std::cerr << "ProcessMonitor: Failed to post WM_PROCESS_UPDATE message. Error: " << GetLastError() <<
+                std::endl;
+    }
 }
@@ -1,21 +1,62 @@
 #ifndef PROCESS_MONITOR_H
 #define PROCESS_MONITOR_H
 
+#include <atomic>
+#include <mutex>
 #include <shared_mutex>
 #include <windows.h>
 #include <unordered_map>
 #include <thread>
+#include <functional>
+#include <memory>
 #include <stop_token>
+#include <vector>
 
-#include "ProcessMetrics.h"
+#include "ProcessInfo.h"
+#include "UpdateBatchPool.h"
+#include "UpdateBus.h"
+#include "Alerts/AlertEngine.h"
+#include "Analysis/LeakDetector.h"
+#include "Analysis/ProcessTree.h"
+#include "Analysis/TopKTracker.h"
+#include "Collection/MemoryProbe.h"
+#include "Collection/ProcessSource.h"
+#include "Collection/SystemSampler.h"
+#include "Collection/ThreadSampler.h"
+#include "History/MetricHistory.h"
+#include "History/RollupStore.h"
+#include "History/SystemHistory.h"
+#include "Memory/TickArena.h"
+#include "Query/QueryEngine.h"
+#include "Search/TrigramIndex.h"
 #include "Concurrency/TaskDefinition.h"
 
 class TaskManager;
-struct ProcessInfo;
+class SnapshotRecorder;
 
 class ProcessMonitor {
 public:
-    ProcessMonitor(TaskManager& taskManager, HWND hMainWindow, HWND hListView);
+    // Runs on the tick thread for every non-empty diff, in order; the diff is
+    // only valid for the duration of the call.
+    using UpdateCallback = std::function<void(const ProcessUpdateData &)>;
+    using AlertSink = std::function<void(const AlertEvent &)>;
+
+    // How far a metric must move from its last published value before it is
+    // reported again. Comparing against the published value rather than the
+    // previous sample gives hysteresis: jitter inside the band is never sent,
+    // while slow drift still is once it adds up.
+    struct ChangeThresholds {
+        double cpu = 0.1;             // percentage points
+        double ramBytes = 0.0;        // any change
+        double ioBytesPerSec = 1024.0;
+    };
+
+    // A null source means the live system. With interval == 0 no task is
+    // scheduled and the owner drives the monitor through pollOnce(). Null
+    // window handles run headless: updates only reach the update callback.
+    ProcessMonitor(TaskManager& taskManager, HWND hMainWindow, HWND hListView,
+                   std::unique_ptr<ProcessSource> source = nullptr,
+                   std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
     ~ProcessMonitor();
 
     // Disable copy/move
@@ -24,9 +65,93 @@ public:
     ProcessMonitor(ProcessMonitor&&) = delete;
     ProcessMonitor& operator=(ProcessMonitor&&) = delete;
 
+    // Removes the scheduled task and ends lifecycle draining. A tick already
+    // running finishes; the destructor waits for it.
     void stopMonitoring();
+
+    // Run one collect/diff/publish cycle on the calling thread.
+    void pollOnce();
+
+    // Also hand every diff to `callback` on the tick thread.
+    void setUpdateCallback(UpdateCallback callback);
+
+    // Every tick, for any number of readers on their own threads (see
+    // UpdateBus). The main window, if any, is sent WM_APP + 104 after each
+    // publish and drains its own subscription.
+    [[nodiscard]] UpdateBus::Subscription subscribe() const { return bus_->subscribe(); }
+
     const ProcessInfo* getProcessInfo(DWORD pid) const;
 
+    // Recent samples of one metric for pid, oldest first (empty if untracked).
+    std::vector<double> getHistory(DWORD pid, MetricHistory::Metric metric) const;
+
+    // History at the coarsest resolution that is still <= `resolution`. Below the
+    // first rollup tier the raw samples are returned as one-sample buckets.
+    std::vector<RollupStore::Bucket> getRollup(DWORD pid, MetricHistory::Metric metric,
+                                               std::chrono::seconds resolution) const;
+
+    // The k processes with the highest value of metric, highest first. O(k).
+    std::vector<TopKTracker::Entry> getTopK(MetricHistory::Metric metric, size_t k) const;
+
+    // CPU, RAM, I/O and process count summed over pid and its descendants.
+    std::optional<ProcessTree::Totals> getSubtree(DWORD pid) const;
+    // Direct children of pid (0: the roots) with their subtree totals.
+    std::vector<ProcessTree::Subtree> getChildren(DWORD pid) const;
+
+    // Working-set trend per process, fed from every tick's sample (see
+    // LeakDetector). The budget defaults to the machine's physical memory.
+    std::vector<LeakDetector::Estimate> getLeakSuspects() const;
+    std::optional<LeakDetector::Estimate> getLeakEstimate(DWORD pid) const;
+    void setLeakDetectorConfig(const LeakDetector::Config &config);
+
+    // Sample per-thread CPU and scheduler state for pid from the next tick on.
+    // Calls nest; every expandThreads needs a matching collapseThreads. No-op
+    // for replay sources.
+    void expandThreads(DWORD pid);
+    void collapseThreads(DWORD pid);
+    std::vector<ThreadInfo> getThreads(DWORD pid) const;
+
+    // USS/PSS breakdown for pid, read on demand and cached (see MemoryProbe).
+    // nullopt for replay sources and processes that cannot be opened.
+    std::optional<MemoryBreakdown> getMemoryBreakdown(DWORD pid);
+    // Keep the breakdowns of the n largest processes by RAM warm, refreshing
+    // them after each tick within the probe's rate limits. 0 turns it off.
+    void setMemoryBreakdownTopN(size_t n);
+
+    // Machine-wide CPU times and scheduler rates from the latest tick; nullopt
+    // for replay sources and until the second live tick.
+    std::optional<SystemSample> getSystemSample() const;
+    // Recent machine-wide samples of one series / one core's busy %, oldest first.
+    std::vector<double> getSystemHistory(SystemHistory::Series series) const;
+    std::vector<double> getCoreHistory(size_t core) const;
+
+    // Compile `text` (see Query) and keep its result set current; `callback`
+    // runs on the monitor thread with the PIDs that entered/left it each tick.
+    std::optional<QueryEngine::QueryId> addStandingQuery(std::wstring_view text, QueryEngine::Callback callback,
+                                                         std::string *error = nullptr);
+    void removeStandingQuery(QueryEngine::QueryId id);
+    std::vector<DWORD> getQueryMatches(QueryEngine::QueryId id) const;
+    // One-off full scan.
+    std::optional<std::vector<DWORD>> runQuery(std::wstring_view text, std::string *error = nullptr) const;
+
+    // Compile `text` (see AlertRule) and evaluate it from the next tick on.
+    // Events go to every registered sink on the monitor thread, once per tick,
+    // before the tick's batch is delivered.
+    std::optional<AlertEngine::RuleId> addAlertRule(std::wstring_view text, std::string *error = nullptr);
+    void removeAlertRule(AlertEngine::RuleId id);
+    uint32_t addAlertSink(AlertSink sink);
+    void removeAlertSink(uint32_t id);
+
+    // PIDs whose name, path or command line (per `fields`) contain `text`,
+    // ignoring case. Served from a trigram index; see TrigramIndex.
+    std::vector<DWORD> search(std::wstring_view text, uint32_t fields = TrigramIndex::FieldAll,
+                              size_t limit = SIZE_MAX) const;
+
+    void setChangeThresholds(const ChangeThresholds &thresholds);
+
+    // Record every tick's table to `recorder` (nullptr stops recording).
+    void setRecorder(std::shared_ptr<SnapshotRecorder> recorder);
+
 private:
     mutable std::shared_mutex processes_mutex_;
     std::unordered_map<DWORD, ProcessInfo> processes_;
@@ -37,9 +162,57 @@ private:
     HWND hwnd_main_window_;
     HWND hwnd_list_view_;
     TaskId monitoring_task_id_ = -1;
-    ProcessMetrics p_metrics_;
+    std::unique_ptr<ProcessSource> source_;
+    std::shared_ptr<const UpdateCallback> update_callback_;  // copied per tick without allocating
+    std::mutex tick_mutex_;
+    std::atomic<bool> lifecycle_pending_ = false;
+    std::atomic<size_t> memory_top_n_ = 0;
+    ProcessSource::LifecycleChanges lifecycle_changes_;  // reused under tick_mutex_
+    TickArena tick_arena_;
+    std::shared_ptr<UpdateBatchPool> batch_pool_ = std::make_shared<UpdateBatchPool>();
+    std::shared_ptr<UpdateBus> bus_ = std::make_shared<UpdateBus>();
+    // None of the stores and indexes from here to alerts_ is synchronized
+    // itself: they are changed only under a unique lock on processes_mutex_
+    // and read under a shared one.
+    MetricHistory history_;
+    RollupStore rollups_;
+    SystemSample system_sample_;
+    SystemHistory system_history_;
+    TopKTracker top_k_;
+    ProcessTree tree_;
+    LeakDetector leaks_;
+    QueryEngine queries_;
+    TrigramIndex search_;
+    std::shared_ptr<SnapshotRecorder> recorder_;
+
+    using AlertSinks = std::vector<std::pair<uint32_t, AlertSink>>;
+    AlertEngine alerts_;
+    std::shared_ptr<const AlertSinks> alert_sinks_;  // copy-on-write, like update_callback_
+    uint32_t next_sink_id_ = 1;
+    std::vector<AlertEvent> alert_events_;  // reused under tick_mutex_
+
+    struct PublishedMetrics {
+        double cpuUsage;
+        SIZE_T ramUsage;
+        double ioRate;
+    };
+    ChangeThresholds thresholds_;
+    std::unordered_map<DWORD, PublishedMetrics> published_;
 
+    static bool sameIdentity(const ProcessInfo &a, const ProcessInfo &b);
+    static bool crossed(double current, double published, double threshold);
+    void trackProcess(const ProcessInfo &info);
+    void releaseProcess(DWORD pid);
     void scheduledUpdateProcesses(const std::stop_token &st);
+    void updateProcesses(const std::stop_token &st);
+    void onLifecycleNotify();
+    void publishLifecycle();
+    void refreshMemoryBreakdowns();
+    std::shared_ptr<const UpdateBus::Snapshot> snapshotIfWanted() const;
+    void publish(UpdateBatch updateData, std::shared_ptr<const UpdateBus::Snapshot> snapshot,
+                 const std::shared_ptr<const UpdateCallback> &callback,
+                 const std::vector<QueryEngine::Change> &queryChanges,
+                 const std::shared_ptr<const AlertSinks> &alertSinks);
 };
 
 #endif // PROCESS_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "ProcessTable.h"
+
+void ProcessTable::upsert(const ProcessInfo &info) {
+    auto [it, inserted] = row_by_pid_.try_emplace(info.pid, static_cast<uint32_t>(pids_.size()));
+    if (inserted) {
+        pids_.push_back(info.pid);
+        for (auto &column: numeric_) {
+            column.emplace_back();
+        }
+        for (auto &column: strings_) {
+            column.emplace_back();
+        }
+    }
+
+    const uint32_t row = it->second;
+    numeric_[static_cast<size_t>(Column::Pid)][row] = info.pid;
+    numeric_[static_cast<size_t>(Column::ParentPid)][row] = info.parentPid;
+    numeric_[static_cast<size_t>(Column::Cpu)][row] = info.cpuUsage;
+    numeric_[static_cast<size_t>(Column::Ram)][row] = static_cast<double>(info.ramUsage);
+    numeric_[static_cast<size_t>(Column::Io)][row] = info.ioRate;
+    // Intern before releasing, so a string the row keeps is not dropped in between.
+    const uint32_t name = interner_.intern(info.name);
+    const uint32_t path = interner_.intern(info.path);
+    if (!inserted) {
+        interner_.release(strings_[0][row]);
+        interner_.release(strings_[1][row]);
+    }
+    strings_[0][row] = name;
+    strings_[1][row] = path;
+}
+
+void ProcessTable::update(const ProcessDelta &delta) {
+    const auto it = row_by_pid_.find(delta.pid);
+    if (it == row_by_pid_.end()) {
+        return;
+    }
+    const uint32_t row = it->second;
+    if (delta.changed & ProcessDelta::Cpu) {
+        numeric_[static_cast<size_t>(Column::Cpu)][row] = delta.cpuUsage;
+    }
+    if (delta.changed & ProcessDelta::Ram) {
+        numeric_[static_cast<size_t>(Column::Ram)][row] = static_cast<double>(delta.ramUsage);
+    }
+    if (delta.changed & ProcessDelta::Io) {
+        numeric_[static_cast<size_t>(Column::Io)][row] = delta.ioRate;
+    }
+}
+
+void ProcessTable::remove(const DWORD pid) {
+    const auto it = row_by_pid_.find(pid);
+    if (it == row_by_pid_.end()) {
+        return;
+    }
+    const uint32_t row = it->second;
+    const size_t last = pids_.size() - 1;
+    row_by_pid_.erase(it);
+    for (const auto &column: strings_) {
+        interner_.release(column[row]);
+    }
+
+    if (row != last) {
+        pids_[row] = pids_[last];
+        for (auto &column: numeric_) {
+            column[row] = column[last];
+        }
+        for (auto &column: strings_) {
+            column[row] = column[last];
+        }
+        row_by_pid_[pids_[row]] = row;
+    }
+    pids_.pop_back();
+    for (auto &column: numeric_) {
+        column.pop_back();
+    }
+    for (auto &column: strings_) {
+        column.pop_back();
+    }
+}
+
+void ProcessTable::apply(const ProcessUpdateData &diff) {
+    for (const DWORD pid: diff.removed_pids) {
+        remove(pid);
+    }
+    for (const auto &info: diff.added) {
+        upsert(info);
+    }
+    for (const auto &delta: diff.updated) {
+        update(delta);
+    }
+}
+
+std::optional<uint32_t> ProcessTable::rowOf(const DWORD pid) const {
+    if (const auto it = row_by_pid_.find(pid); it != row_by_pid_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,52 @@
+#ifndef ProcessTable_h
+#define ProcessTable_h
+
+#include <windows.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+#include "StringInterner.h"
+
+// Column-oriented copy of the process table for query evaluation.
+//
+// Numeric columns are contiguous doubles so a predicate is one tight loop per
+// column; names and paths are stored as interned IDs. Rows are unordered:
+// removal moves the last row into the hole.
+class ProcessTable {
+public:
+    enum class Column : uint8_t { Pid, ParentPid, Cpu, Ram, Io, Name, Path };
+    static constexpr size_t NumericColumns = 5;  // Pid .. Io
+    static constexpr size_t StringColumns = 2;   // Name, Path
+
+    static constexpr bool isNumeric(const Column c) { return static_cast<size_t>(c) < NumericColumns; }
+
+    void upsert(const ProcessInfo &info);
+    void update(const ProcessDelta &delta);
+    void remove(DWORD pid);
+    void apply(const ProcessUpdateData &diff);
+
+    [[nodiscard]] size_t rows() const { return pids_.size(); }
+    [[nodiscard]] std::optional<uint32_t> rowOf(DWORD pid) const;
+    [[nodiscard]] DWORD pidAt(const size_t row) const { return pids_[row]; }
+
+    [[nodiscard]] const std::vector<double> &numeric(const Column c) const {
+        return numeric_[static_cast<size_t>(c)];
+    }
+    [[nodiscard]] const std::vector<uint32_t> &strings(const Column c) const {
+        return strings_[static_cast<size_t>(c) - NumericColumns];
+    }
+    [[nodiscard]] const StringInterner &interner() const { return interner_; }
+
+private:
+    std::vector<DWORD> pids_;
+    std::array<std::vector<double>, NumericColumns> numeric_;
+    std::array<std::vector<uint32_t>, StringColumns> strings_;
+    std::unordered_map<DWORD, uint32_t> row_by_pid_;
+    StringInterner interner_;
+};
+
+#endif
@@ -0,0 +1,376 @@
+#include "Query.h"
+
+#include <cwchar>
+#include <cwctype>
+#include <functional>
+
+namespace {
+    struct AllRows {
+        size_t operator()(const size_t j) const { return j; }
+    };
+
+    struct SomeRows {
+        const uint32_t *rows;
+        size_t operator()(const size_t j) const { return rows[j]; }
+    };
+
+    std::string narrow(const std::wstring_view text) {
+        std::string out;
+        for (const wchar_t c: text) {
+            out.push_back(c < 0x80 ? static_cast<char>(c) : '?');
+        }
+        return out;
+    }
+}
+
+// Recursive descent straight into the postfix plan.
+//
+//   or    := and ( ("or" | "||") and )*
+//   and   := unary ( ("and" | "&&") unary )*
+//   unary := ("not" | "!") unary | "(" or ")" | field op value
+class Query::Parser {
+public:
+    Parser(const std::wstring_view text, std::vector<Op> &plan) : text_(text), plan_(plan) {}
+
+    bool parse(std::string *error) {
+        if (parseOr()) {
+            skipSpace();
+            if (pos_ == text_.size()) {
+                return true;
+            }
+            fail("unexpected input");
+        }
+        if (error) {
+            *error = error_;
+        }
+        return false;
+    }
+
+private:
+    std::wstring_view text_;
+    std::vector<Op> &plan_;
+    size_t pos_ = 0;
+    std::string error_;
+
+    bool fail(const char *what) {
+        if (error_.empty()) {
+            error_ = std::string("query: ") + what + " at offset " + std::to_string(pos_);
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() && std::iswspace(text_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    static bool isWordChar(const wchar_t c) {
+        return std::iswalnum(c) || c == L'_';
+    }
+
+    bool accept(const std::wstring_view symbol) {
+        skipSpace();
+        if (text_.substr(pos_, symbol.size()) != symbol) {
+            return false;
+        }
+        pos_ += symbol.size();
+        return true;
+    }
+
+    bool acceptKeyword(const std::wstring_view keyword) {
+        skipSpace();
+        if (text_.size() - pos_ < keyword.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < keyword.size(); ++i) {
+            if (static_cast<wchar_t>(std::towlower(text_[pos_ + i])) != keyword[i]) {
+                return false;
+            }
+        }
+        if (const size_t end = pos_ + keyword.size(); end < text_.size() && isWordChar(text_[end])) {
+            return false;
+        }
+        pos_ += keyword.size();
+        return true;
+    }
+
+    bool parseOr() {
+        if (!parseAnd()) {
+            return false;
+        }
+        while (acceptKeyword(L"or") || accept(L"||")) {
+            if (!parseAnd()) {
+                return false;
+            }
+            plan_.push_back(Op{Op::Kind::Or});
+        }
+        return true;
+    }
+
+    bool parseAnd() {
+        if (!parseUnary()) {
+            return false;
+        }
+        while (acceptKeyword(L"and") || accept(L"&&")) {
+            if (!parseUnary()) {
+                return false;
+            }
+            plan_.push_back(Op{Op::Kind::And});
+        }
+        return true;
+    }
+
+    bool parseUnary() {
+        skipSpace();
+        const bool bang = pos_ < text_.size() && text_[pos_] == L'!' &&
+                          (pos_ + 1 == text_.size() || text_[pos_ + 1] != L'=');
+        if (bang || acceptKeyword(L"not")) {
+            pos_ += bang ? 1 : 0;
+            if (!parseUnary()) {
+                return false;
+            }
+            plan_.push_back(Op{Op::Kind::Not});
+            return true;
+        }
+        if (accept(L"(")) {
+            if (!parseOr()) {
+                return false;
+            }
+            return accept(L")") || fail("expected ')'");
+        }
+        return parsePredicate();
+    }
+
+    bool parseField(ProcessTable::Column &column) {
+        skipSpace();
+        const size_t start = pos_;
+        while (pos_ < text_.size() && isWordChar(text_[pos_])) {
+            ++pos_;
+        }
+        const std::wstring field = StringInterner::fold(text_.substr(start, pos_ - start));
+        using enum ProcessTable::Column;
+        if (field == L"pid") column = Pid;
+        else if (field == L"ppid") column = ParentPid;
+        else if (field == L"cpu") column = Cpu;
+        else if (field == L"ram" || field == L"mem") column = Ram;
+        else if (field == L"io") column = Io;
+        else if (field == L"name") column = Name;
+        else if (field == L"path") column = Path;
+        else {
+            pos_ = start;
+            return fail("expected field");
+        }
+        return true;
+    }
+
+    bool parseValue(std::wstring &value) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == L'"') {
+            const size_t end = text_.find(L'"', pos_ + 1);
+            if (end == std::wstring_view::npos) {
+                return fail("unterminated string");
+            }
+            value = text_.substr(pos_ + 1, end - pos_ - 1);
+            pos_ = end + 1;
+            return true;
+        }
+        const size_t start = pos_;
+        while (pos_ < text_.size() && !std::iswspace(text_[pos_]) && text_[pos_] != L')') {
+            ++pos_;
+        }
+        if (pos_ == start) {
+            return fail("expected value");
+        }
+        value = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+    bool parseNumber(const std::wstring &value, double &number) {
+        wchar_t *end = nullptr;
+        number = std::wcstod(value.c_str(), &end);
+        if (end == value.c_str()) {
+            return fail("expected number");
+        }
+        const std::wstring suffix = StringInterner::fold(end);
+        if (suffix.empty() || suffix == L"%") {
+            return true;
+        }
+        if (suffix == L"k" || suffix == L"kb") number *= 1024.0;
+        else if (suffix == L"m" || suffix == L"mb") number *= 1024.0 * 1024.0;
+        else if (suffix == L"g" || suffix == L"gb") number *= 1024.0 * 1024.0 * 1024.0;
+        else {
+            return fail(("unknown unit '" + narrow(suffix) + "'").c_str());
+        }
+        return true;
+    }
+
+    bool parsePredicate() {
+        Op op{Op::Kind::Numeric};
+        if (!parseField(op.column)) {
+            return false;
+        }
+
+        const bool numeric = ProcessTable::isNumeric(op.column);
+        if (numeric) {
+            // Longest operators first.
+            if (accept(L"<=")) op.compare = Compare::LessEqual;
+            else if (accept(L">=")) op.compare = Compare::GreaterEqual;
+            else if (accept(L"!=")) op.compare = Compare::NotEqual;
+            else if (accept(L"==") || accept(L"=")) op.compare = Compare::Equal;
+            else if (accept(L"<")) op.compare = Compare::Less;
+            else if (accept(L">")) op.compare = Compare::Greater;
+            else return fail("expected comparison");
+        } else {
+            op.kind = Op::Kind::String;
+            if (accept(L"!=")) op.match = Match::NotEqual;
+            else if (accept(L"^=")) op.match = Match::Prefix;
+            else if (accept(L"$=")) op.match = Match::Suffix;
+            else if (accept(L"~")) op.match = Match::Contains;
+            else if (accept(L"==") || accept(L"=")) op.match = Match::Equal;
+            else return fail("expected string operator");
+        }
+
+        std::wstring value;
+        if (!parseValue(value)) {
+            return false;
+        }
+        if (numeric) {
+            if (!parseNumber(value, op.number)) {
+                return false;
+            }
+        } else {
+            op.needle = StringInterner::fold(value);
+        }
+        plan_.push_back(std::move(op));
+        return true;
+    }
+};
+
+std::optional<Query> Query::compile(const std::wstring_view text, std::string *error) {
+    Query query;
+    query.text_ = text;
+    if (!Parser(query.text_, query.plan_).parse(error)) {
+        return std::nullopt;
+    }
+    return query;
+}
+
+template<typename Select>
+void Query::scanNumeric(const Op &op, const std::vector<double> &column, Select select, uint8_t *out,
+                        const size_t n) {
+    const double v = op.number;
+    // Raw pointer: a uint8_t store may alias the vector's own members, which
+    // would force a reload of data() every iteration and block vectorization.
+    const double *values = column.data();
+    // One branch-free loop per operator; with AllRows these vectorize.
+    const auto scan = [&](auto compare) {
+        for (size_t j = 0; j < n; ++j) {
+            out[j] = compare(values[select(j)], v);
+        }
+    };
+    switch (op.compare) {
+        case Compare::Less: scan(std::less<>{}); break;
+        case Compare::LessEqual: scan(std::less_equal<>{}); break;
+        case Compare::Greater: scan(std::greater<>{}); break;
+        case Compare::GreaterEqual: scan(std::greater_equal<>{}); break;
+        case Compare::Equal: scan(std::equal_to<>{}); break;
+        case Compare::NotEqual: scan(std::not_equal_to<>{}); break;
+    }
+}
+
+template<typename Select>
+void Query::scanString(Op &op, const ProcessTable &table, Select select, uint8_t *out, const size_t n) {
+    const uint32_t *ids = table.strings(op.column).data();
+    const StringInterner &interner = table.interner();
+
+    if (op.match == Match::Equal || op.match == Match::NotEqual) {
+        const uint8_t negate = op.match == Match::NotEqual;
+        const auto id = interner.find(op.needle);
+        if (!id) {
+            std::fill_n(out, n, negate);
+            return;
+        }
+        const uint32_t wanted = *id;
+        for (size_t j = 0; j < n; ++j) {
+            out[j] = static_cast<uint8_t>(ids[select(j)] == wanted) ^ negate;
+        }
+        return;
+    }
+
+    // A string is tested at most once per query, until its ID is handed to another.
+    if (op.matches.size() < interner.size()) {
+        op.matches.resize(interner.size());
+    }
+    for (size_t j = 0; j < n; ++j) {
+        const uint32_t id = ids[select(j)];
+        Cached &cached = op.matches[id];
+        if (cached.generation != interner.generation(id)) {
+            const std::wstring_view s = interner.str(id);
+            switch (op.match) {
+                case Match::Prefix: cached.match = s.starts_with(op.needle); break;
+                case Match::Suffix: cached.match = s.ends_with(op.needle); break;
+                default: cached.match = s.find(op.needle) != std::wstring_view::npos; break;
+            }
+            cached.generation = interner.generation(id);
+        }
+        out[j] = cached.match;
+    }
+}
+
+template<typename Select>
+void Query::run(const ProcessTable &table, Select select, const size_t n, std::vector<uint8_t> &mask) {
+    size_t depth = 0;
+    for (Op &op: plan_) {
+        switch (op.kind) {
+            case Op::Kind::Numeric:
+            case Op::Kind::String: {
+                if (stack_.size() <= depth) {
+                    stack_.emplace_back();
+                }
+                std::vector<uint8_t> &out = stack_[depth++];
+                out.resize(n);
+                if (op.kind == Op::Kind::Numeric) {
+                    scanNumeric(op, table.numeric(op.column), select, out.data(), n);
+                } else {
+                    scanString(op, table, select, out.data(), n);
+                }
+                break;
+            }
+            case Op::Kind::And: {
+                --depth;
+                uint8_t *a = stack_[depth - 1].data();
+                const uint8_t *b = stack_[depth].data();
+                for (size_t j = 0; j < n; ++j) {
+                    a[j] &= b[j];
+                }
+                break;
+            }
+            case Op::Kind::Or: {
+                --depth;
+                uint8_t *a = stack_[depth - 1].data();
+                const uint8_t *b = stack_[depth].data();
+                for (size_t j = 0; j < n; ++j) {
+                    a[j] |= b[j];
+                }
+                break;
+            }
+            case Op::Kind::Not: {
+                uint8_t *a = stack_[depth - 1].data();
+                for (size_t j = 0; j < n; ++j) {
+                    a[j] ^= 1;
+                }
+                break;
+            }
+        }
+    }
+    mask.swap(stack_[0]);
+}
+
+void Query::evaluate(const ProcessTable &table, std::vector<uint8_t> &mask) {
+    run(table, AllRows{}, table.rows(), mask);
+}
+
+void Query::evaluate(const ProcessTable &table, const std::span<const uint32_t> rows, std::vector<uint8_t> &mask) {
+    run(table, SomeRows{rows.data()}, rows.size(), mask);
+}
@@ -0,0 +1,74 @@
+#ifndef Query_h
+#define Query_h
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ProcessTable.h"
+
+// A filter over the process table, compiled from text such as
+//
+//   cpu > 5% and not name = "svchost.exe"
+//   (ram >= 1.5GB or io > 10MB) and path ^= "C:\Program Files\"
+//
+// Fields: pid, ppid, cpu, ram (alias mem), io, name, path.
+// Numeric operators: < <= > >= = != ; numbers may carry %, K/KB, M/MB, G/GB.
+// String operators (case-insensitive): = != ^= (prefix) $= (suffix) ~ (contains);
+// values are quoted or bare words. Combinators: and/&&, or/||, not/!, ( ).
+//
+// The plan is a postfix list of column predicates and mask combinators. Numeric
+// predicates are branch-free scans over one column; string predicates compare
+// interned IDs, and non-equality matches are computed once per distinct string
+// and cached by ID. A compiled query is bound to no particular table, but its
+// cache assumes one interner: do not evaluate the same Query against two tables.
+// Evaluating fills that cache and the query's scratch masks, so it is not const
+// and one Query must not be evaluated on two threads at once.
+class Query {
+public:
+    static std::optional<Query> compile(std::wstring_view text, std::string *error = nullptr);
+
+    // mask[row] = 1 if the row matches, for every row of the table.
+    void evaluate(const ProcessTable &table, std::vector<uint8_t> &mask);
+    // mask[i] = 1 if rows[i] matches.
+    void evaluate(const ProcessTable &table, std::span<const uint32_t> rows, std::vector<uint8_t> &mask);
+
+    [[nodiscard]] const std::wstring &text() const { return text_; }
+
+private:
+    enum class Compare : uint8_t { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+    enum class Match : uint8_t { Equal, NotEqual, Prefix, Suffix, Contains };
+
+    struct Cached {
+        uint32_t generation = 0;  // the interner's generation of the ID; 0: not computed
+        uint8_t match = 0;
+    };
+
+    struct Op {
+        enum class Kind : uint8_t { Numeric, String, And, Or, Not } kind;
+        ProcessTable::Column column = ProcessTable::Column::Pid;
+        Compare compare = Compare::Equal;
+        Match match = Match::Equal;
+        double number = 0.0;
+        std::wstring needle;           // folded
+        std::vector<Cached> matches;   // per interned ID
+    };
+
+    class Parser;
+
+    template<typename Select>
+    void run(const ProcessTable &table, Select select, size_t n, std::vector<uint8_t> &mask);
+    template<typename Select>
+    static void scanNumeric(const Op &op, const std::vector<double> &column, Select select, uint8_t *out, size_t n);
+    template<typename Select>
+    static void scanString(Op &op, const ProcessTable &table, Select select, uint8_t *out, size_t n);
+
+    std::wstring text_;
+    std::vector<Op> plan_;
+    std::vector<std::vector<uint8_t>> stack_;  // scratch masks, reused across evaluations
+};
+
+#endif
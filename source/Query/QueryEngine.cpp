@@ -0,0 +1,88 @@
+#include "QueryEngine.h"
+
+#include <ranges>
+
+QueryEngine::QueryId QueryEngine::subscribe(Query q, Callback callback) {
+    const QueryId id = next_id_++;
+    Standing &standing = standing_.emplace(id, Standing{std::move(q), std::move(callback), {}}).first->second;
+
+    standing.query.evaluate(table_, mask_);
+    for (size_t row = 0; row < mask_.size(); ++row) {
+        if (mask_[row]) {
+            standing.matching.insert(table_.pidAt(row));
+        }
+    }
+    return id;
+}
+
+void QueryEngine::unsubscribe(const QueryId id) {
+    standing_.erase(id);
+}
+
+std::vector<DWORD> QueryEngine::matches(const QueryId id) const {
+    const auto it = standing_.find(id);
+    if (it == standing_.end()) {
+        return {};
+    }
+    return {it->second.matching.begin(), it->second.matching.end()};
+}
+
+std::vector<DWORD> QueryEngine::run(Query &q) const {
+    std::vector<uint8_t> mask;
+    q.evaluate(table_, mask);
+    std::vector<DWORD> out;
+    for (size_t row = 0; row < mask.size(); ++row) {
+        if (mask[row]) {
+            out.push_back(table_.pidAt(row));
+        }
+    }
+    return out;
+}
+
+std::vector<QueryEngine::Change> QueryEngine::applyTick(const ProcessUpdateData &diff) {
+    table_.apply(diff);
+
+    std::vector<Change> changes;
+    if (standing_.empty()) {
+        return changes;
+    }
+
+    rows_.clear();
+    for (const auto &info: diff.added) {
+        if (const auto row = table_.rowOf(info.pid)) {
+            rows_.push_back(*row);
+        }
+    }
+    for (const auto &delta: diff.updated) {
+        if (const auto row = table_.rowOf(delta.pid)) {
+            rows_.push_back(*row);
+        }
+    }
+
+    for (auto &standing: standing_ | std::views::values) {
+        Change change;
+        for (const DWORD pid: diff.removed_pids) {
+            if (standing.matching.erase(pid)) {
+                change.left.push_back(pid);
+            }
+        }
+
+        standing.query.evaluate(table_, rows_, mask_);
+        for (size_t i = 0; i < rows_.size(); ++i) {
+            const DWORD pid = table_.pidAt(rows_[i]);
+            if (mask_[i]) {
+                if (standing.matching.insert(pid).second) {
+                    change.entered.push_back(pid);
+                }
+            } else if (standing.matching.erase(pid)) {
+                change.left.push_back(pid);
+            }
+        }
+
+        if (standing.callback && (!change.entered.empty() || !change.left.empty())) {
+            change.callback = standing.callback;
+            changes.push_back(std::move(change));
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,59 @@
+#ifndef QueryEngine_h
+#define QueryEngine_h
+
+#include <windows.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "Query.h"
+
+// Owns the columnar table and the standing queries evaluated against it.
+//
+// applyTick() folds the tick's diff into the table, then re-evaluates each
+// standing query only over the added and updated rows; removed PIDs simply
+// leave every result set. Ad-hoc queries scan the whole table.
+class QueryEngine {
+public:
+    using QueryId = uint32_t;
+    // PIDs that started and stopped matching during one tick.
+    using Callback = std::function<void(const std::vector<DWORD> &entered, const std::vector<DWORD> &left)>;
+
+    struct Change {
+        Callback callback;
+        std::vector<DWORD> entered;
+        std::vector<DWORD> left;
+    };
+
+    // Evaluates q once over the current table; later ticks are incremental.
+    QueryId subscribe(Query q, Callback callback);
+    void unsubscribe(QueryId id);
+    [[nodiscard]] std::vector<DWORD> matches(QueryId id) const;
+
+    // Also fills q's caches (see Query).
+    [[nodiscard]] std::vector<DWORD> run(Query &q) const;
+
+    // Returns the notifications to deliver; callers invoke them outside their lock.
+    std::vector<Change> applyTick(const ProcessUpdateData &diff);
+
+    [[nodiscard]] const ProcessTable &table() const { return table_; }
+
+private:
+    struct Standing {
+        Query query;
+        Callback callback;
+        std::unordered_set<DWORD> matching;
+    };
+
+    ProcessTable table_;
+    std::map<QueryId, Standing> standing_;
+    QueryId next_id_ = 1;
+    std::vector<uint32_t> rows_;
+    std::vector<uint8_t> mask_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "StringInterner.h"
+
+#include <cwctype>
+
+std::wstring StringInterner::fold(const std::wstring_view text) {
+    std::wstring folded(text);
+    for (wchar_t &c: folded) {
+        c = static_cast<wchar_t>(std::towlower(c));
+    }
+    return folded;
+}
+
+uint32_t StringInterner::intern(const std::wstring_view text) {
+    std::wstring folded = fold(text);
+    if (const auto it = ids_.find(folded); it != ids_.end()) {
+        ++entries_[it->second].refs;
+        return it->second;
+    }
+    uint32_t id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(entries_.size());
+        entries_.emplace_back();
+    }
+    Entry &entry = entries_[id];
+    entry.text = std::move(folded);
+    entry.refs = 1;
+    ++entry.generation;
+    ids_.emplace(entry.text, id);
+    return id;
+}
+
+void StringInterner::release(const uint32_t id) {
+    Entry &entry = entries_[id];
+    if (--entry.refs != 0) {
+        return;
+    }
+    ids_.erase(entry.text);
+    entry.text = std::wstring();
+    free_.push_back(id);
+}
+
+std::optional<uint32_t> StringInterner::find(const std::wstring_view text) const {
+    if (const auto it = ids_.find(fold(text)); it != ids_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,49 @@
+#ifndef StringInterner_h
+#define StringInterner_h
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps strings to dense 32-bit IDs. Strings are folded to lower case first, so
+// equal IDs mean "equal ignoring case", which is how Windows compares names and
+// paths.
+//
+// Reference counted: every intern() takes a reference and release() drops one.
+// A string nobody refers to any more is forgotten and its ID handed to the next
+// new string, so months of churn through temporary paths do not accumulate.
+// generation(id) changes whenever an ID is handed out again, which is what
+// callers caching per-ID results check against.
+class StringInterner {
+public:
+    uint32_t intern(std::wstring_view text);
+    void release(uint32_t id);
+    // Only strings that are still referenced.
+    [[nodiscard]] std::optional<uint32_t> find(std::wstring_view text) const;
+
+    // The folded string for id.
+    [[nodiscard]] const std::wstring &str(const uint32_t id) const { return entries_[id].text; }
+    [[nodiscard]] uint32_t generation(const uint32_t id) const { return entries_[id].generation; }
+    // IDs handed out so far, live or free: the size of a per-ID table.
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+    [[nodiscard]] size_t live() const { return ids_.size(); }
+
+    static std::wstring fold(std::wstring_view text);
+
+private:
+    struct Entry {
+        std::wstring text;
+        uint32_t refs = 0;
+        uint32_t generation = 0;  // 1 for an ID's first string
+    };
+
+    std::deque<Entry> entries_;  // deque: elements never move, views stay valid
+    std::unordered_map<std::wstring_view, uint32_t> ids_;
+    std::vector<uint32_t> free_;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef RecordingFormat_h
+#define RecordingFormat_h
+
+#include <cstdint>
+#include <string>
+#include <format>
+
+// On-disk layout of a process table recording.
+//
+// A recording is a series of segment files "<base>.<index>.plrec". Every segment
+// is preallocated to a fixed size and mapped; it starts with a SegmentHeader
+// followed by back-to-back tick blocks:
+//
+//   TickBlockHeader
+//   uint32_t pid[rowCount]           (padded to 8 bytes)
+//   double   cpu[rowCount]
+//   uint64_t ram[rowCount]
+//   double   io[rowCount]
+//     -- or, with TickCompressed: uint64_t n + n bytes of SeriesCodec output
+//        (pid delta, cpu XOR, ram delta, io XOR; rows sorted by pid), padded --
+//   uint32_t removed[removedCount]   (padded to 8 bytes)
+//   AddedRecord + name + path + command line  x addedCount
+//                                    (UTF-16, padded to 8 bytes each)
+//
+// The writer publishes a block by storing SegmentHeader::committedBytes with
+// release semantics after the block is complete, so readers in other processes
+// can follow a segment while it is being appended. The first block of every
+// segment is a keyframe listing all live processes as added.
+namespace recording {
+    constexpr uint64_t SegmentMagic = 0x0031304345524C50ull;  // "PLREC01"
+    constexpr uint32_t TickMagic = 0x4b434954;                // "TICK"
+    constexpr uint32_t FormatVersion = 3;  // 2: AddedRecord::parentPid, 3: command line
+
+    enum SegmentFlags : uint32_t {
+        SegmentSealed = 1u << 0,  // writer moved on to the next segment
+    };
+
+    enum TickFlags : uint32_t {
+        TickKeyframe = 1u << 0,
+        TickCompressed = 1u << 1,
+    };
+
+    struct SegmentHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t headerBytes;
+        uint64_t capacityBytes;   // size of the mapped file
+        uint64_t committedBytes;  // bytes of complete blocks, including this header
+        uint64_t segmentIndex;
+        uint64_t firstSequence;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    struct TickBlockHeader {
+        uint32_t magic;
+        uint32_t blockBytes;
+        uint64_t sequence;
+        int64_t timestamp;  // FILETIME, 100 ns since 1601
+        uint32_t rowCount;
+        uint32_t addedCount;
+        uint32_t removedCount;
+        uint32_t flags;
+    };
+
+    struct AddedRecord {
+        uint32_t pid;
+        uint32_t parentPid;
+        uint16_t nameLength;  // UTF-16 code units
+        uint16_t pathLength;
+        uint16_t commandLineLength;
+        uint16_t reserved;
+    };
+
+    constexpr size_t align8(const size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+    inline std::wstring segmentPath(const std::wstring &base, const uint64_t index) {
+        return std::format(L"{}.{:06}.plrec", base, index);
+    }
+}
+
+#endif
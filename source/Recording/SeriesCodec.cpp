@@ -0,0 +1,363 @@
+#include "SeriesCodec.h"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<uint8_t> &out) : out_(out) {}
+
+        void put(uint64_t bits, const unsigned count) {
+            if (count == 0) return;
+            if (count < 64) bits &= (1ull << count) - 1;
+
+            const unsigned space = 64 - fill_;
+            if (count <= space) {
+                acc_ = count == 64 ? bits : (acc_ << count) | bits;
+                fill_ += count;
+            } else {
+                const unsigned rest = count - space;
+                acc_ = (acc_ << space) | (bits >> rest);
+                fill_ = 64;
+                flushWord();
+                acc_ = bits & ((1ull << rest) - 1);
+                fill_ = rest;
+            }
+            if (fill_ == 64) {
+                flushWord();
+            }
+        }
+
+        void putBit(const bool bit) { put(bit ? 1 : 0, 1); }
+
+        // Elias gamma code, n >= 1.
+        void putGamma(const uint64_t n) {
+            const unsigned width = 64 - std::countl_zero(n);
+            put(0, width - 1);
+            put(n, width);
+        }
+
+        void finish() {
+            while (fill_ >= 8) {
+                out_.push_back(static_cast<uint8_t>(acc_ >> (fill_ - 8)));
+                fill_ -= 8;
+            }
+            if (fill_ > 0) {
+                out_.push_back(static_cast<uint8_t>(acc_ << (8 - fill_)));
+                fill_ = 0;
+            }
+            acc_ = 0;
+        }
+
+    private:
+        void flushWord() {
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                out_.push_back(static_cast<uint8_t>(acc_ >> shift));
+            }
+            acc_ = 0;
+            fill_ = 0;
+        }
+
+        std::vector<uint8_t> &out_;
+        uint64_t acc_ = 0;
+        unsigned fill_ = 0;
+    };
+
+    class BitReader {
+    public:
+        explicit BitReader(const std::span<const uint8_t> in) : in_(in) {}
+
+        bool get(unsigned count, uint64_t &value) {
+            if (pos_ + count > in_.size() * 8) {
+                return false;
+            }
+            value = 0;
+            while (count > 0) {
+                const size_t byte = pos_ >> 3;
+                const unsigned offset = pos_ & 7;
+                const unsigned take = std::min(count, 8 - offset);
+                const uint64_t bits = (in_[byte] >> (8 - offset - take)) & ((1u << take) - 1);
+                value = (value << take) | bits;
+                pos_ += take;
+                count -= take;
+            }
+            return true;
+        }
+
+        bool getBit(bool &bit) {
+            uint64_t v;
+            if (!get(1, v)) return false;
+            bit = v != 0;
+            return true;
+        }
+
+        bool getGamma(uint64_t &n) {
+            unsigned zeros = 0;
+            bool bit = false;
+            while (getBit(bit) && !bit) {
+                if (++zeros > 63) return false;
+            }
+            if (!bit) return false;
+            uint64_t rest = 0;
+            if (zeros > 0 && !get(zeros, rest)) return false;
+            n = (1ull << zeros) | rest;
+            return true;
+        }
+
+        [[nodiscard]] size_t bytesConsumed() const { return (pos_ + 7) / 8; }
+
+    private:
+        std::span<const uint8_t> in_;
+        size_t pos_ = 0;
+    };
+
+    uint64_t zigzag(const int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    int64_t unzigzag(const uint64_t v) {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    // Wrapping arithmetic, so full-range unsigned counters round-trip.
+    int64_t sub(const int64_t a, const int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    }
+
+    int64_t add(const int64_t a, const int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+
+    template<typename T>
+    void encodeIntegersAs(const std::span<const T> values, const codec::IntegerOrder order, std::vector<uint8_t> &out) {
+        int64_t prev = 0;
+        int64_t prevDelta = 0;
+        uint64_t zeroRun = 0;
+
+        auto flushRun = [&] {
+            if (zeroRun > 0) {
+                codec::putVarint(0, out);
+                codec::putVarint(zeroRun, out);
+                zeroRun = 0;
+            }
+        };
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            const auto value = static_cast<int64_t>(values[i]);
+            int64_t token;
+            if (i == 0) {
+                token = value;
+            } else if (order == codec::IntegerOrder::Delta || i == 1) {
+                token = sub(value, prev);
+            } else {
+                token = sub(sub(value, prev), prevDelta);
+            }
+            if (i > 0) {
+                prevDelta = sub(value, prev);
+            }
+            prev = value;
+
+            if (token == 0 && i > 0) {
+                ++zeroRun;
+                continue;
+            }
+            flushRun();
+            codec::putVarint(zigzag(token), out);
+        }
+        flushRun();
+    }
+
+    template<typename T>
+    size_t decodeIntegersAs(const std::span<const uint8_t> in, const size_t count,
+                            const codec::IntegerOrder order, T *out) {
+        size_t offset = 0;
+        int64_t prev = 0;
+        int64_t prevDelta = 0;
+        size_t i = 0;
+
+        auto emit = [&](const int64_t token) {
+            int64_t value;
+            if (i == 0) {
+                value = token;
+            } else if (order == codec::IntegerOrder::Delta || i == 1) {
+                value = add(prev, token);
+            } else {
+                value = add(add(prev, prevDelta), token);
+            }
+            if (i > 0) {
+                prevDelta = sub(value, prev);
+            }
+            prev = value;
+            out[i++] = static_cast<T>(value);
+        };
+
+        while (i < count) {
+            uint64_t raw;
+            const size_t used = codec::getVarint(in.subspan(offset), raw);
+            if (used == 0) {
+                return 0;
+            }
+            offset += used;
+            // Only the first value can be a literal zero; afterwards zero introduces a run.
+            if (raw == 0 && i > 0) {
+                uint64_t run;
+                const size_t runBytes = codec::getVarint(in.subspan(offset), run);
+                if (runBytes == 0 || run == 0 || run > count - i) {
+                    return 0;
+                }
+                offset += runBytes;
+                for (uint64_t r = 0; r < run; ++r) {
+                    emit(0);
+                }
+            } else {
+                emit(unzigzag(raw));
+            }
+        }
+        return offset;
+    }
+}
+
+namespace codec {
+    void putVarint(uint64_t value, std::vector<uint8_t> &out) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    size_t getVarint(const std::span<const uint8_t> in, uint64_t &value) {
+        value = 0;
+        for (size_t i = 0; i < in.size() && i < 10; ++i) {
+            value |= static_cast<uint64_t>(in[i] & 0x7f) << (7 * i);
+            if (!(in[i] & 0x80)) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    void encodeDoubles(const std::span<const double> values, std::vector<uint8_t> &out) {
+        if (values.empty()) {
+            return;
+        }
+        BitWriter writer(out);
+        uint64_t prev = std::bit_cast<uint64_t>(values[0]);
+        writer.put(prev, 64);
+
+        unsigned prevLeading = 65;  // no window yet
+        unsigned prevTrailing = 0;
+        uint64_t run = 0;
+
+        for (size_t i = 1; i < values.size(); ++i) {
+            const uint64_t cur = std::bit_cast<uint64_t>(values[i]);
+            const uint64_t x = cur ^ prev;
+            prev = cur;
+
+            if (x == 0) {
+                ++run;
+                continue;
+            }
+            if (run > 0) {
+                writer.put(0b00, 2);
+                writer.putGamma(run);
+                run = 0;
+            }
+
+            // Leading zeros are stored in 5 bits.
+            const unsigned leading = std::min(static_cast<unsigned>(std::countl_zero(x)), 31u);
+            const unsigned trailing = std::countr_zero(x);
+
+            if (prevLeading <= 64 && leading >= prevLeading && trailing >= prevTrailing) {
+                writer.put(0b01, 2);
+                writer.put(x >> prevTrailing, 64 - prevLeading - prevTrailing);
+            } else {
+                const unsigned meaningful = 64 - leading - trailing;
+                writer.putBit(true);
+                writer.put(leading, 5);
+                writer.put(meaningful - 1, 6);
+                writer.put(x >> trailing, meaningful);
+                prevLeading = leading;
+                prevTrailing = trailing;
+            }
+        }
+        if (run > 0) {
+            writer.put(0b00, 2);
+            writer.putGamma(run);
+        }
+        writer.finish();
+    }
+
+    size_t decodeDoubles(const std::span<const uint8_t> in, const size_t count, double *out) {
+        if (count == 0) {
+            return 0;
+        }
+        BitReader reader(in);
+        uint64_t prev;
+        if (!reader.get(64, prev)) {
+            return 0;
+        }
+        out[0] = std::bit_cast<double>(prev);
+
+        unsigned prevLeading = 0;
+        unsigned prevTrailing = 0;
+
+        for (size_t i = 1; i < count;) {
+            bool first;
+            if (!reader.getBit(first)) return 0;
+
+            uint64_t x;
+            if (!first) {
+                bool second;
+                if (!reader.getBit(second)) return 0;
+                if (!second) {
+                    uint64_t run;
+                    if (!reader.getGamma(run) || run > count - i) return 0;
+                    for (uint64_t r = 0; r < run; ++r) {
+                        out[i++] = std::bit_cast<double>(prev);
+                    }
+                    continue;
+                }
+                uint64_t bits;
+                if (!reader.get(64 - prevLeading - prevTrailing, bits)) return 0;
+                x = bits << prevTrailing;
+            } else {
+                uint64_t leading, meaningful, bits;
+                if (!reader.get(5, leading) || !reader.get(6, meaningful)) return 0;
+                ++meaningful;
+                if (leading + meaningful > 64 || !reader.get(static_cast<unsigned>(meaningful), bits)) return 0;
+                prevLeading = static_cast<unsigned>(leading);
+                prevTrailing = static_cast<unsigned>(64 - leading - meaningful);
+                x = bits << prevTrailing;
+            }
+            prev ^= x;
+            out[i++] = std::bit_cast<double>(prev);
+        }
+        return reader.bytesConsumed();
+    }
+
+    void encodeIntegers(const std::span<const int64_t> values, const IntegerOrder order, std::vector<uint8_t> &out) {
+        encodeIntegersAs(values, order, out);
+    }
+
+    void encodeIntegers(const std::span<const uint64_t> values, const IntegerOrder order, std::vector<uint8_t> &out) {
+        encodeIntegersAs(values, order, out);
+    }
+
+    void encodeIntegers(const std::span<const uint32_t> values, const IntegerOrder order, std::vector<uint8_t> &out) {
+        encodeIntegersAs(values, order, out);
+    }
+
+    size_t decodeIntegers(const std::span<const uint8_t> in, const size_t count, const IntegerOrder order, int64_t *out) {
+        return decodeIntegersAs(in, count, order, out);
+    }
+
+    size_t decodeIntegers(const std::span<const uint8_t> in, const size_t count, const IntegerOrder order, uint64_t *out) {
+        return decodeIntegersAs(in, count, order, out);
+    }
+
+    size_t decodeIntegers(const std::span<const uint8_t> in, const size_t count, const IntegerOrder order, uint32_t *out) {
+        return decodeIntegersAs(in, count, order, out);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SeriesCodec_h
+#define SeriesCodec_h
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Compact encodings for stored metric series.
+//
+// Doubles (CPU %, I/O B/s) use a Gorilla-style XOR-of-previous bit stream:
+//   '00' + gamma(n)                      value repeated n more times (idle runs)
+//   '01' + bits                          XOR fits the previous leading/trailing window
+//   '1'  + 5b leading + 6b (len-1) + bits  new window
+// Integers (timestamps, counters, byte gauges) are zigzag LEB128 varints of the
+// first or second difference. After the first value a zero token is followed by
+// a run length of zero differences, so flat series cost a few bytes in total.
+//
+// Every encoder appends to `out` and is byte aligned at the end; decoders take the
+// element count and return the number of bytes consumed (0 on malformed input).
+namespace codec {
+    enum class IntegerOrder : uint8_t {
+        Delta = 1,          // gauges, sorted ids
+        DeltaOfDelta = 2,   // timestamps, monotonic counters
+    };
+
+    void encodeDoubles(std::span<const double> values, std::vector<uint8_t> &out);
+    size_t decodeDoubles(std::span<const uint8_t> in, size_t count, double *out);
+
+    void encodeIntegers(std::span<const int64_t> values, IntegerOrder order, std::vector<uint8_t> &out);
+    size_t decodeIntegers(std::span<const uint8_t> in, size_t count, IntegerOrder order, int64_t *out);
+
+    // Convenience overloads for the unsigned columns used by the recorder.
+    void encodeIntegers(std::span<const uint64_t> values, IntegerOrder order, std::vector<uint8_t> &out);
+    void encodeIntegers(std::span<const uint32_t> values, IntegerOrder order, std::vector<uint8_t> &out);
+    size_t decodeIntegers(std::span<const uint8_t> in, size_t count, IntegerOrder order, uint64_t *out);
+    size_t decodeIntegers(std::span<const uint8_t> in, size_t count, IntegerOrder order, uint32_t *out);
+
+    void putVarint(uint64_t value, std::vector<uint8_t> &out);
+    // Returns bytes read, 0 on truncated input.
+    size_t getVarint(std::span<const uint8_t> in, uint64_t &value);
+}
+
+#endif
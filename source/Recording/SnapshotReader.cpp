@@ -0,0 +1,232 @@
+#include "SnapshotReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+#include "SeriesCodec.h"
+
+using namespace recording;
+
+namespace {
+    constexpr uint64_t MaxCompressedRows = 1u << 24;
+}
+
+SnapshotReader::SnapshotReader(std::wstring basePath, const uint64_t firstSegment)
+    : base_path_(std::move(basePath)), first_segment_(firstSegment), segment_index_(firstSegment) {
+    openSegment(first_segment_);
+}
+
+SnapshotReader::~SnapshotReader() {
+    closeSegment();
+}
+
+// Opens into locals first so a failed attempt (e.g. the writer has not created the
+// next segment yet) leaves the current segment usable.
+bool SnapshotReader::openSegment(const uint64_t index) {
+    const std::wstring path = segmentPath(base_path_, index);
+    HandleWrapper file(CreateFileW(path.c_str(), GENERIC_READ,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!file.isValid()) {
+        return false;
+    }
+
+    HandleWrapper mapping(CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!mapping.isValid()) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || static_cast<uint64_t>(size.QuadPart) < sizeof(SegmentHeader)) {
+        return false;
+    }
+    const auto *view = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!view) {
+        return false;
+    }
+
+    // The writer stores the magic last, so a valid magic means the header is complete.
+    const auto *header = reinterpret_cast<const SegmentHeader *>(view);
+    if (std::atomic_ref(const_cast<uint64_t &>(header->magic)).load(std::memory_order_acquire) != SegmentMagic ||
+        header->version != FormatVersion || header->headerBytes < sizeof(SegmentHeader) ||
+        header->headerBytes > static_cast<uint64_t>(size.QuadPart)) {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    closeSegment();
+    file_ = std::move(file);
+    mapping_ = std::move(mapping);
+    view_ = view;
+    header_ = header;
+    mapped_bytes_ = static_cast<uint64_t>(size.QuadPart);
+    segment_index_ = index;
+    read_offset_ = header_->headerBytes;
+    return true;
+}
+
+void SnapshotReader::closeSegment() {
+    if (view_) {
+        UnmapViewOfFile(view_);
+    }
+    view_ = nullptr;
+    header_ = nullptr;
+    mapping_ = HandleWrapper();
+    file_ = HandleWrapper();
+}
+
+bool SnapshotReader::rewind() {
+    corrupt_ = false;
+    if (!openSegment(first_segment_)) {
+        closeSegment();
+        segment_index_ = first_segment_;
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotReader::decodeColumns(std::span<const uint8_t> in, const size_t rows, Tick &tick) {
+    pids_.resize(rows);
+    cpu_.resize(rows);
+    ram_.resize(rows);
+    io_.resize(rows);
+    if (rows == 0) {
+        tick.pids = {};
+        tick.cpu = {};
+        tick.ram = {};
+        tick.io = {};
+        return true;
+    }
+
+    size_t used = codec::decodeIntegers(in, rows, codec::IntegerOrder::Delta, pids_.data());
+    if (used == 0) return false;
+    in = in.subspan(used);
+    used = codec::decodeDoubles(in, rows, cpu_.data());
+    if (used == 0) return false;
+    in = in.subspan(used);
+    used = codec::decodeIntegers(in, rows, codec::IntegerOrder::Delta, ram_.data());
+    if (used == 0) return false;
+    in = in.subspan(used);
+    if (codec::decodeDoubles(in, rows, io_.data()) == 0) return false;
+
+    tick.pids = pids_;
+    tick.cpu = cpu_;
+    tick.ram = ram_;
+    tick.io = io_;
+    return true;
+}
+
+// Whether the added records of a block fit in `bytes`; forEachAdded walks
+// them without checking.
+bool SnapshotReader::addedRecordsFit(const std::byte *cursor, const uint32_t count, uint64_t bytes) {
+    for (uint32_t i = 0; i < count; ++i) {
+        AddedRecord record;
+        if (bytes < sizeof(record)) {
+            return false;
+        }
+        std::memcpy(&record, cursor, sizeof(record));
+        const uint64_t recordBytes = align8(sizeof(record) + (uint64_t{record.nameLength} + record.pathLength +
+                                                              record.commandLineLength) * sizeof(wchar_t));
+        if (recordBytes > bytes) {
+            return false;
+        }
+        cursor += recordBytes;
+        bytes -= recordBytes;
+    }
+    return true;
+}
+
+bool SnapshotReader::next(Tick &tick) {
+    if (!view_ && !corrupt_ && !openSegment(segment_index_)) {
+        return false;  // not created yet; the next call tries again
+    }
+    while (view_) {
+        // The writer only ever increases committedBytes; read it (and the seal flag) with acquire.
+        const uint32_t flags = std::atomic_ref(const_cast<uint32_t &>(header_->flags)).load(std::memory_order_acquire);
+        const uint64_t committed = std::min(std::atomic_ref(const_cast<uint64_t &>(header_->committedBytes))
+                                                .load(std::memory_order_acquire), mapped_bytes_);
+
+        if (read_offset_ + sizeof(TickBlockHeader) <= committed) {
+            const std::byte *block = view_ + read_offset_;
+            const auto *hdr = reinterpret_cast<const TickBlockHeader *>(block);
+            // Every column is checked against blockBytes before it is exposed,
+            // so a corrupt or truncated segment ends the recording instead of
+            // being read out of bounds.
+            const auto corrupt = [&](const char *what) {
+                std::cerr << "SnapshotReader: corrupt tick block (" << what << ") at offset " << read_offset_
+                          << " of segment " << segment_index_ << std::endl;
+                closeSegment();
+                corrupt_ = true;
+                return false;
+            };
+            if (hdr->magic != TickMagic || hdr->blockBytes < sizeof(TickBlockHeader) ||
+                hdr->blockBytes % 8 != 0 || read_offset_ + hdr->blockBytes > committed) {
+                return corrupt("header");
+            }
+
+            const uint64_t rows = hdr->rowCount;
+            const std::byte *cursor = block + sizeof(TickBlockHeader);
+            uint64_t remaining = hdr->blockBytes - sizeof(TickBlockHeader);
+            const auto take = [&](const uint64_t bytes) {
+                if (bytes > remaining) {
+                    return false;
+                }
+                remaining -= bytes;
+                return true;
+            };
+
+            tick.sequence = hdr->sequence;
+            tick.timestamp = hdr->timestamp;
+            tick.keyframe = (hdr->flags & TickKeyframe) != 0;
+            if (hdr->flags & TickCompressed) {
+                uint64_t encodedBytes;
+                if (!take(sizeof(encodedBytes))) {
+                    return corrupt("column size");
+                }
+                std::memcpy(&encodedBytes, cursor, sizeof(encodedBytes));
+                cursor += sizeof(encodedBytes);
+                // Runs of repeated values compress without bound, so the row
+                // count is capped rather than checked against encodedBytes.
+                if (rows > MaxCompressedRows || encodedBytes > remaining || !take(align8(encodedBytes)) ||
+                    !decodeColumns({reinterpret_cast<const uint8_t *>(cursor), encodedBytes}, rows, tick)) {
+                    return corrupt("compressed columns");
+                }
+                cursor += align8(encodedBytes);
+            } else {
+                if (!take(align8(rows * sizeof(uint32_t)) + rows * (sizeof(double) + sizeof(uint64_t) +
+                                                                    sizeof(double)))) {
+                    return corrupt("columns");
+                }
+                tick.pids = {reinterpret_cast<const uint32_t *>(cursor), rows};
+                cursor += align8(rows * sizeof(uint32_t));
+                tick.cpu = {reinterpret_cast<const double *>(cursor), rows};
+                cursor += rows * sizeof(double);
+                tick.ram = {reinterpret_cast<const uint64_t *>(cursor), rows};
+                cursor += rows * sizeof(uint64_t);
+                tick.io = {reinterpret_cast<const double *>(cursor), rows};
+                cursor += rows * sizeof(double);
+            }
+            if (!take(align8(uint64_t{hdr->removedCount} * sizeof(uint32_t)))) {
+                return corrupt("removed PIDs");
+            }
+            tick.removed = {reinterpret_cast<const uint32_t *>(cursor), hdr->removedCount};
+            cursor += align8(hdr->removedCount * sizeof(uint32_t));
+            if (!addedRecordsFit(cursor, hdr->addedCount, remaining)) {
+                return corrupt("added records");
+            }
+            tick.addedCount = hdr->addedCount;
+            tick.addedBegin = cursor;
+
+            read_offset_ += hdr->blockBytes;
+            return true;
+        }
+
+        // Caught up. Either the writer is still appending, or it moved to the next segment.
+        if (!(flags & SegmentSealed) || !openSegment(segment_index_ + 1)) {
+            return false;
+        }
+    }
+    return false;
+}
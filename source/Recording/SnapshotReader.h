@@ -0,0 +1,108 @@
+#ifndef SnapshotReader_h
+#define SnapshotReader_h
+
+#include <windows.h>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HandleWrapper.h"
+#include "RecordingFormat.h"
+
+// Sequential reader for recordings written by SnapshotRecorder.
+//
+// Segments are mapped read-only and blocks are exposed in place. The reader
+// follows SegmentHeader::committedBytes, so it can follow a recording that is
+// still being appended by another process: next() returns false when it has
+// caught up (or the first segment does not exist yet) and can simply be called
+// again later. Nothing else in the file is trusted: every block is checked
+// against its own blockBytes before any of it is exposed, and a corrupt one
+// ends the recording until rewind(). Compressed ticks are decoded into buffers
+// owned by the reader; the spans then point there instead.
+class SnapshotReader {
+public:
+    struct Added {
+        uint32_t pid;
+        uint32_t parentPid;
+        std::wstring_view name;
+        std::wstring_view path;
+        std::wstring_view commandLine;
+    };
+
+    // Views into the mapped segment; valid until the next call to next().
+    struct Tick {
+        uint64_t sequence = 0;
+        int64_t timestamp = 0;  // FILETIME units
+        bool keyframe = false;
+        std::span<const uint32_t> pids;
+        std::span<const double> cpu;
+        std::span<const uint64_t> ram;
+        std::span<const double> io;
+        std::span<const uint32_t> removed;
+        uint32_t addedCount = 0;
+        const std::byte *addedBegin = nullptr;
+
+        // Calls fn(const Added&) for every added record of the tick.
+        template<typename Fn>
+        void forEachAdded(Fn &&fn) const {
+            const std::byte *cursor = addedBegin;
+            for (uint32_t i = 0; i < addedCount; ++i) {
+                recording::AddedRecord record;
+                std::memcpy(&record, cursor, sizeof(record));
+                const auto *text = reinterpret_cast<const wchar_t *>(cursor + sizeof(record));
+                fn(Added{
+                    record.pid,
+                    record.parentPid,
+                    std::wstring_view(text, record.nameLength),
+                    std::wstring_view(text + record.nameLength, record.pathLength),
+                    std::wstring_view(text + record.nameLength + record.pathLength, record.commandLineLength)
+                });
+                cursor += recording::align8(sizeof(record) + (record.nameLength + record.pathLength +
+                                                              record.commandLineLength) * sizeof(wchar_t));
+            }
+        }
+    };
+
+    explicit SnapshotReader(std::wstring basePath, uint64_t firstSegment = 0);
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    // Advances to the next committed tick. Moves to the following segment once
+    // the current one is sealed and fully read.
+    bool next(Tick &tick);
+
+    // Start over from the first segment.
+    bool rewind();
+
+    [[nodiscard]] bool isOpen() const { return view_ != nullptr; }
+
+private:
+    bool openSegment(uint64_t index);
+    void closeSegment();
+    bool decodeColumns(std::span<const uint8_t> in, size_t rows, Tick &tick);
+    static bool addedRecordsFit(const std::byte *cursor, uint32_t count, uint64_t bytes);
+
+    std::wstring base_path_;
+    uint64_t first_segment_;
+    uint64_t segment_index_;  // open, or to open on the next call
+    bool corrupt_ = false;
+
+    HandleWrapper file_;
+    HandleWrapper mapping_;
+    const std::byte *view_ = nullptr;
+    const recording::SegmentHeader *header_ = nullptr;
+    uint64_t mapped_bytes_ = 0;
+    uint64_t read_offset_ = 0;
+
+    std::vector<uint32_t> pids_;
+    std::vector<double> cpu_;
+    std::vector<uint64_t> ram_;
+    std::vector<double> io_;
+};
+
+#endif
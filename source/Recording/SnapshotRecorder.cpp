@@ -0,0 +1,285 @@
+#include "SnapshotRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <ranges>
+
+#include "ProcessInfo.h"
+#include "SeriesCodec.h"
+
+using namespace recording;
+
+SnapshotRecorder::SnapshotRecorder(std::wstring basePath, const uint64_t segmentBytes, const uint32_t maxSegments,
+                                   const bool compress)
+    : base_path_(std::move(basePath)),
+      segment_bytes_(segmentBytes < (1ull << 20) ? (1ull << 20) : segmentBytes),
+      max_segments_(maxSegments),
+      compress_(compress) {
+    openSegment(0);
+}
+
+SnapshotRecorder::~SnapshotRecorder() {
+    closeSegment(false);
+}
+
+template<typename Info>
+size_t SnapshotRecorder::addedBytes(const Info &info) {
+    const size_t chars = std::min<size_t>(info.name.size(), UINT16_MAX)
+                         + std::min<size_t>(info.path.size(), UINT16_MAX)
+                         + std::min<size_t>(info.commandLine.size(), UINT16_MAX);
+    return align8(sizeof(AddedRecord) + chars * sizeof(wchar_t));
+}
+
+bool SnapshotRecorder::openSegment(const uint64_t minimumBytes) {
+    const uint64_t capacity = std::max<uint64_t>(segment_bytes_, align8(sizeof(SegmentHeader)) + minimumBytes);
+    const std::wstring path = segmentPath(base_path_, segment_index_);
+
+    file_ = HandleWrapper(CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                      FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!file_.isValid()) {
+        std::cerr << "SnapshotRecorder: failed to create segment. Error: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    // Mapping a size larger than the file extends it, so the segment is allocated up front.
+    mapping_ = HandleWrapper(CreateFileMappingW(file_, nullptr, PAGE_READWRITE,
+                                                static_cast<DWORD>(capacity >> 32),
+                                                static_cast<DWORD>(capacity), nullptr));
+    if (!mapping_.isValid()) {
+        std::cerr << "SnapshotRecorder: failed to map segment. Error: " << GetLastError() << std::endl;
+        file_ = HandleWrapper();
+        return false;
+    }
+
+    view_ = static_cast<std::byte *>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0));
+    if (!view_) {
+        std::cerr << "SnapshotRecorder: failed to map view. Error: " << GetLastError() << std::endl;
+        mapping_ = HandleWrapper();
+        file_ = HandleWrapper();
+        return false;
+    }
+
+    constexpr auto headerBytes = static_cast<uint32_t>(align8(sizeof(SegmentHeader)));
+    header_ = reinterpret_cast<SegmentHeader *>(view_);
+    *header_ = SegmentHeader{0, FormatVersion, headerBytes, capacity, headerBytes, segment_index_, sequence_, 0, 0};
+    write_offset_ = headerBytes;
+    // Readers treat the magic as "header complete".
+    std::atomic_ref(header_->magic).store(SegmentMagic, std::memory_order_release);
+    segment_has_keyframe_ = false;
+
+    if (max_segments_ > 0 && segment_index_ >= max_segments_) {
+        DeleteFileW(segmentPath(base_path_, segment_index_ - max_segments_).c_str());
+    }
+    return true;
+}
+
+void SnapshotRecorder::closeSegment(const bool seal) {
+    if (!view_) {
+        return;
+    }
+    if (seal) {
+        std::atomic_ref(header_->flags).fetch_or(SegmentSealed, std::memory_order_release);
+    }
+
+    const uint64_t committed = write_offset_;
+    UnmapViewOfFile(view_);
+    view_ = nullptr;
+    header_ = nullptr;
+    mapping_ = HandleWrapper();
+
+    // Give back the unused tail. Fails harmlessly while a reader still maps the file.
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(committed);
+    if (SetFilePointerEx(file_, end, nullptr, FILE_BEGIN)) {
+        SetEndOfFile(file_);
+    }
+    file_ = HandleWrapper();
+    ++segment_index_;
+}
+
+void SnapshotRecorder::remember(const ProcessInfo &info) {
+    const auto [it, inserted] = identities_.try_emplace(info.pid);
+    Identity &identity = it->second;
+    if (!inserted) {
+        keyframe_added_bytes_ -= addedBytes(identity);
+    }
+    identity = Identity{static_cast<uint32_t>(info.parentPid),
+                        std::wstring(info.name), std::wstring(info.path), std::wstring(info.commandLine)};
+    keyframe_added_bytes_ += addedBytes(identity);
+}
+
+void SnapshotRecorder::forget(const DWORD pid) {
+    if (const auto it = identities_.find(pid); it != identities_.end()) {
+        keyframe_added_bytes_ -= addedBytes(it->second);
+        identities_.erase(it);
+    }
+}
+
+void SnapshotRecorder::seed(const std::unordered_map<DWORD, ProcessInfo> &table) {
+    for (const auto &info: table | std::views::values) {
+        remember(info);
+    }
+}
+
+void SnapshotRecorder::capture(const std::unordered_map<DWORD, ProcessInfo> &table) {
+    rows_.clear();
+    rows_.reserve(table.size());
+    for (const auto &[pid, info]: table) {
+        rows_.push_back(Row{static_cast<uint32_t>(pid), info.cpuUsage, info.ramUsage, info.ioRate});
+    }
+}
+
+bool SnapshotRecorder::commit(const ProcessUpdateData &diff) {
+    // Removals first: a reused PID is reported as removed and added in one diff.
+    for (const DWORD pid: diff.removed_pids) {
+        forget(pid);
+    }
+    for (const ProcessInfo &info: diff.added) {
+        remember(info);
+    }
+    if (!view_) {
+        return false;
+    }
+
+    const size_t rows = rows_.size();
+    if (compress_) {
+        encodeColumns();
+    }
+    const size_t columnBytes = compress_
+                                   ? sizeof(uint64_t) + align8(encoded_.size())
+                                   : align8(rows * sizeof(uint32_t))
+                                     + rows * (sizeof(double) + sizeof(uint64_t) + sizeof(double));
+    const size_t fixedBytes = sizeof(TickBlockHeader)
+                              + columnBytes
+                              + align8(diff.removed_pids.size() * sizeof(uint32_t));
+
+    size_t diffBytes = 0;
+    for (const auto &info: diff.added) {
+        diffBytes += addedBytes(info);
+    }
+
+    bool keyframe = !segment_has_keyframe_;
+    size_t blockBytes = fixedBytes + (keyframe ? keyframe_added_bytes_ : diffBytes);
+
+    if (write_offset_ + blockBytes > header_->capacityBytes) {
+        closeSegment(true);
+        if (!openSegment(fixedBytes + keyframe_added_bytes_)) {
+            return false;
+        }
+        keyframe = true;
+        blockBytes = fixedBytes + keyframe_added_bytes_;
+    }
+
+    std::byte *block = view_ + write_offset_;
+    FILETIME nowFt;
+    GetSystemTimeAsFileTime(&nowFt);
+    ULARGE_INTEGER now{nowFt.dwLowDateTime, nowFt.dwHighDateTime};
+
+    uint32_t flags = keyframe ? TickKeyframe : 0u;
+    if (compress_) {
+        flags |= TickCompressed;
+    }
+
+    auto *tick = reinterpret_cast<TickBlockHeader *>(block);
+    *tick = TickBlockHeader{
+        TickMagic,
+        static_cast<uint32_t>(blockBytes),
+        sequence_,
+        static_cast<int64_t>(now.QuadPart),
+        static_cast<uint32_t>(rows),
+        static_cast<uint32_t>(keyframe ? identities_.size() : diff.added.size()),
+        static_cast<uint32_t>(diff.removed_pids.size()),
+        flags
+    };
+
+    std::byte *cursor = block + sizeof(TickBlockHeader);
+    if (compress_) {
+        const uint64_t encodedBytes = encoded_.size();
+        std::memcpy(cursor, &encodedBytes, sizeof(encodedBytes));
+        std::memcpy(cursor + sizeof(encodedBytes), encoded_.data(), encoded_.size());
+        cursor += columnBytes;
+    } else {
+        auto *pids = reinterpret_cast<uint32_t *>(cursor);
+        cursor += align8(rows * sizeof(uint32_t));
+        auto *cpu = reinterpret_cast<double *>(cursor);
+        cursor += rows * sizeof(double);
+        auto *ram = reinterpret_cast<uint64_t *>(cursor);
+        cursor += rows * sizeof(uint64_t);
+        auto *io = reinterpret_cast<double *>(cursor);
+        cursor += rows * sizeof(double);
+
+        for (size_t row = 0; row < rows; ++row) {
+            pids[row] = rows_[row].pid;
+            cpu[row] = rows_[row].cpu;
+            ram[row] = rows_[row].ram;
+            io[row] = rows_[row].io;
+        }
+    }
+
+    auto *removed = reinterpret_cast<uint32_t *>(cursor);
+    for (size_t i = 0; i < diff.removed_pids.size(); ++i) {
+        removed[i] = diff.removed_pids[i];
+    }
+    cursor += align8(diff.removed_pids.size() * sizeof(uint32_t));
+
+    auto writeAdded = [&cursor](const DWORD pid, const auto &info) {
+        const AddedRecord record{
+            static_cast<uint32_t>(pid),
+            static_cast<uint32_t>(info.parentPid),
+            static_cast<uint16_t>(std::min<size_t>(info.name.size(), UINT16_MAX)),
+            static_cast<uint16_t>(std::min<size_t>(info.path.size(), UINT16_MAX)),
+            static_cast<uint16_t>(std::min<size_t>(info.commandLine.size(), UINT16_MAX)),
+            0
+        };
+        std::memcpy(cursor, &record, sizeof(record));
+        std::byte *text = cursor + sizeof(record);
+        std::memcpy(text, info.name.data(), record.nameLength * sizeof(wchar_t));
+        text += record.nameLength * sizeof(wchar_t);
+        std::memcpy(text, info.path.data(), record.pathLength * sizeof(wchar_t));
+        text += record.pathLength * sizeof(wchar_t);
+        std::memcpy(text, info.commandLine.data(), record.commandLineLength * sizeof(wchar_t));
+        cursor += addedBytes(info);
+    };
+    if (keyframe) {
+        for (const auto &[pid, identity]: identities_) {
+            writeAdded(pid, identity);
+        }
+    } else {
+        for (const auto &info: diff.added) {
+            writeAdded(info.pid, info);
+        }
+    }
+
+    write_offset_ += blockBytes;
+    bytes_recorded_ += blockBytes;
+    ++sequence_;
+    segment_has_keyframe_ = true;
+    std::atomic_ref(header_->committedBytes).store(write_offset_, std::memory_order_release);
+    return true;
+}
+
+// Rows sorted by PID so the id column is a run of small deltas; idle CPU and I/O
+// columns collapse into repeat runs.
+void SnapshotRecorder::encodeColumns() {
+    std::ranges::sort(rows_, {}, &Row::pid);
+
+    column_pids_.clear();
+    column_cpu_.clear();
+    column_ram_.clear();
+    column_io_.clear();
+    for (const Row &row: rows_) {
+        column_pids_.push_back(row.pid);
+        column_cpu_.push_back(row.cpu);
+        column_ram_.push_back(row.ram);
+        column_io_.push_back(row.io);
+    }
+
+    encoded_.clear();
+    codec::encodeIntegers(std::span<const uint32_t>(column_pids_), codec::IntegerOrder::Delta, encoded_);
+    codec::encodeDoubles(column_cpu_, encoded_);
+    codec::encodeIntegers(std::span<const uint64_t>(column_ram_), codec::IntegerOrder::Delta, encoded_);
+    codec::encodeDoubles(column_io_, encoded_);
+}
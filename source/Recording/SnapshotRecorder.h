@@ -0,0 +1,116 @@
+#ifndef SnapshotRecorder_h
+#define SnapshotRecorder_h
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "HandleWrapper.h"
+#include "RecordingFormat.h"
+
+struct ProcessInfo;
+struct ProcessUpdateData;
+
+// Append-only flight recorder for the process table.
+//
+// Each tick is encoded straight into a memory-mapped, preallocated segment file
+// (no intermediate buffer, no per-record writes). When a segment is full the
+// recorder seals it and opens the next one; with maxSegments > 0 the oldest
+// segment is deleted so disk usage stays bounded. With compress set, the numeric
+// columns go through SeriesCodec first (one extra copy into the mapping).
+//
+// A tick is taken in two steps so the writing happens outside the table's
+// lock: capture() copies the numeric columns while the caller holds it, and
+// commit() encodes and appends them with the tick's diff afterwards. Names,
+// paths and command lines for keyframes come from the recorder's own copy,
+// kept up to date from the diffs, so a keyframe never needs the table.
+// Not synchronized; one thread at a time.
+class SnapshotRecorder {
+public:
+    static constexpr uint64_t DefaultSegmentBytes = 64ull << 20;
+
+    explicit SnapshotRecorder(std::wstring basePath,
+                              uint64_t segmentBytes = DefaultSegmentBytes,
+                              uint32_t maxSegments = 0,
+                              bool compress = false);
+    ~SnapshotRecorder();
+
+    SnapshotRecorder(const SnapshotRecorder&) = delete;
+    SnapshotRecorder& operator=(const SnapshotRecorder&) = delete;
+
+    [[nodiscard]] bool isOpen() const { return view_ != nullptr; }
+
+    // The processes already in the table when recording starts; the first
+    // keyframe lists them. Not needed if the first diff adds every process.
+    void seed(const std::unordered_map<DWORD, ProcessInfo> &table);
+
+    // Copies the numeric columns of the table after a tick. Cheap: meant to be
+    // called under the table's lock.
+    void capture(const std::unordered_map<DWORD, ProcessInfo> &table);
+    // Appends the captured columns plus the diff that produced them.
+    bool commit(const ProcessUpdateData &diff);
+
+    // Both at once, for callers that own the table.
+    bool recordTick(const std::unordered_map<DWORD, ProcessInfo> &table, const ProcessUpdateData &diff) {
+        capture(table);
+        return commit(diff);
+    }
+
+    [[nodiscard]] uint64_t ticksRecorded() const { return sequence_; }
+    [[nodiscard]] uint64_t bytesRecorded() const { return bytes_recorded_; }
+
+private:
+    bool openSegment(uint64_t minimumBytes);
+    void closeSegment(bool seal);
+    struct Row {
+        uint32_t pid;
+        double cpu;
+        uint64_t ram;
+        double io;
+    };
+
+    struct Identity {
+        uint32_t parentPid = 0;
+        std::wstring name;
+        std::wstring path;
+        std::wstring commandLine;
+    };
+
+    template<typename Info>
+    static size_t addedBytes(const Info &info);
+    void remember(const ProcessInfo &info);
+    void forget(DWORD pid);
+    void encodeColumns();
+
+    std::wstring base_path_;
+    uint64_t segment_bytes_;
+    uint32_t max_segments_;
+    bool compress_;
+
+    HandleWrapper file_;
+    HandleWrapper mapping_;
+    std::byte *view_ = nullptr;
+    recording::SegmentHeader *header_ = nullptr;
+    uint64_t write_offset_ = 0;
+    uint64_t segment_index_ = 0;
+    bool segment_has_keyframe_ = false;
+
+    uint64_t sequence_ = 0;
+    uint64_t bytes_recorded_ = 0;
+
+    std::unordered_map<DWORD, Identity> identities_;
+    size_t keyframe_added_bytes_ = 0;  // added records of a keyframe listing identities_
+
+    std::vector<Row> rows_;  // from capture()
+
+    // Scratch for compressed ticks, reused across ticks.
+    std::vector<uint32_t> column_pids_;
+    std::vector<double> column_cpu_;
+    std::vector<uint64_t> column_ram_;
+    std::vector<double> column_io_;
+    std::vector<uint8_t> encoded_;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "TrigramIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+
+#include "Query/StringInterner.h"
+
+// 16 bits per character, field in the top bits.
+uint64_t TrigramIndex::gramKey(const size_t field, const wchar_t *gram) {
+    return static_cast<uint64_t>(field) << 48
+           | static_cast<uint64_t>(static_cast<uint16_t>(gram[0])) << 32
+           | static_cast<uint64_t>(static_cast<uint16_t>(gram[1])) << 16
+           | static_cast<uint64_t>(static_cast<uint16_t>(gram[2]));
+}
+
+void TrigramIndex::gramsOf(const size_t field, const std::wstring_view text, std::vector<uint64_t> &out) {
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        out.push_back(gramKey(field, text.data() + i));
+    }
+}
+
+// The document's distinct grams, into scratch_grams_.
+void TrigramIndex::gramsOf(const Document &doc) {
+    scratch_grams_.clear();
+    for (size_t field = 0; field < FieldCount; ++field) {
+        gramsOf(field, doc.text[field], scratch_grams_);
+    }
+    std::ranges::sort(scratch_grams_);
+    const auto [first, last] = std::ranges::unique(scratch_grams_);
+    scratch_grams_.erase(first, last);
+}
+
+void TrigramIndex::add(const ProcessInfo &info) {
+    remove(info.pid);
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(documents_.size());
+        documents_.emplace_back();
+    }
+    Document &doc = documents_[slot];
+    doc.pid = info.pid;
+    doc.text = {StringInterner::fold(info.name), StringInterner::fold(info.path),
+                StringInterner::fold(info.commandLine)};
+    slot_by_pid_.emplace(info.pid, slot);
+
+    gramsOf(doc);
+    for (const uint64_t gram: scratch_grams_) {
+        pending_[gram].added.push_back(slot);
+    }
+}
+
+void TrigramIndex::remove(const DWORD pid) {
+    const auto it = slot_by_pid_.find(pid);
+    if (it == slot_by_pid_.end()) {
+        return;
+    }
+    const uint32_t slot = it->second;
+    slot_by_pid_.erase(it);
+    Document &doc = documents_[slot];
+
+    gramsOf(doc);
+    for (const uint64_t gram: scratch_grams_) {
+        pending_[gram].removed.push_back(slot);
+    }
+
+    // Cleared text never passes search()'s substring test, so the stale
+    // postings are harmless until endTick() drops them. The slot is not reused
+    // before then, so a tick never both removes and adds the same slot.
+    doc = Document{};
+    released_slots_.push_back(slot);
+}
+
+void TrigramIndex::endTick() {
+    for (auto &[gram, pending]: pending_) {
+        std::ranges::sort(pending.added);
+        std::ranges::sort(pending.removed);
+        auto list = postings_.find(gram);
+        if (list == postings_.end()) {
+            if (pending.added.empty()) {
+                continue;
+            }
+            list = postings_.emplace(gram, std::vector<uint32_t>()).first;
+        }
+
+        // (list + added) - removed in one merge. A slot added and removed in
+        // the same tick was never in the list, so removing it is a no-op.
+        scratch_list_.clear();
+        scratch_list_.reserve(list->second.size() + pending.added.size());
+        std::ranges::merge(list->second, pending.added, std::back_inserter(scratch_list_));
+        list->second.clear();
+        std::ranges::set_difference(scratch_list_, pending.removed, std::back_inserter(list->second));
+        if (list->second.empty()) {
+            postings_.erase(list);
+        }
+    }
+    pending_.clear();
+    free_slots_.insert(free_slots_.end(), released_slots_.begin(), released_slots_.end());
+    released_slots_.clear();
+}
+
+std::vector<DWORD> TrigramIndex::search(const std::wstring_view text, const uint32_t fields, const size_t limit) const {
+    std::vector<DWORD> out;
+    const std::wstring needle = StringInterner::fold(text);
+    if (needle.empty() || limit == 0) {
+        return out;
+    }
+
+    // Slots already reported, so a match in two fields is returned once.
+    std::vector<uint8_t> reported(documents_.size());
+
+    for (size_t field = 0; field < FieldCount && out.size() < limit; ++field) {
+        if (!(fields & (1u << field))) {
+            continue;
+        }
+
+        const auto report = [&](const uint32_t slot) {
+            const Document &doc = documents_[slot];
+            if (reported[slot] || doc.text[field].find(needle) == std::wstring::npos) {
+                return;
+            }
+            reported[slot] = 1;
+            out.push_back(doc.pid);
+        };
+
+        if (needle.size() < 3) {
+            for (const uint32_t slot: slot_by_pid_ | std::views::values) {
+                if (out.size() >= limit) {
+                    break;
+                }
+                report(slot);
+            }
+            continue;
+        }
+
+        std::vector<const std::vector<uint32_t> *> lists;
+        std::vector<uint64_t> grams;
+        gramsOf(field, needle, grams);
+        std::ranges::sort(grams);
+        const auto [first, last] = std::ranges::unique(grams);
+        grams.erase(first, last);
+
+        bool missing = false;
+        for (const uint64_t gram: grams) {
+            const auto it = postings_.find(gram);
+            if (it == postings_.end()) {
+                missing = true;
+                break;
+            }
+            lists.push_back(&it->second);
+        }
+        if (missing) {
+            continue;
+        }
+        std::ranges::sort(lists, {}, [](const auto *list) { return list->size(); });
+
+        // Walk the rarest gram's list and probe the next rarest ones by binary
+        // search, so the work follows the smallest list and stops at `limit`.
+        // Past a few probes, the substring test in report() is the cheaper filter.
+        const size_t probes = std::min<size_t>(lists.size(), 4);
+        for (const uint32_t slot: *lists.front()) {
+            if (out.size() >= limit) {
+                break;
+            }
+            bool candidate = true;
+            for (size_t i = 1; i < probes && candidate; ++i) {
+                candidate = std::ranges::binary_search(*lists[i], slot);
+            }
+            if (candidate) {
+                report(slot);
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,77 @@
+#ifndef TrigramIndex_h
+#define TrigramIndex_h
+
+#include <windows.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ProcessInfo.h"
+
+// Case-insensitive substring search over process names, paths and command lines.
+//
+// Every field is folded to lower case and split into overlapping 3-character
+// grams; each (field, gram) key has a sorted posting list of document slots. A
+// query of 3+ characters intersects the posting lists of its own grams,
+// smallest first, and then confirms each candidate with a real substring test,
+// so the cost follows the rarest gram rather than the table size. Shorter
+// queries carry too little to index and fall back to a scan of the folded text.
+//
+// Common grams ("exe", "win") have a posting for nearly every process, so
+// add() and remove() only queue their postings, and endTick() merges each
+// touched list once: a tick costs one pass per list however many processes
+// churned. Until then search() does not see the tick's new processes; removed
+// ones are never reported.
+class TrigramIndex {
+public:
+    enum Field : uint32_t {
+        FieldName = 1u << 0,
+        FieldPath = 1u << 1,
+        FieldCommandLine = 1u << 2,
+        FieldAll = FieldName | FieldPath | FieldCommandLine,
+    };
+
+    // Indexes info's text, replacing whatever was indexed for its PID.
+    void add(const ProcessInfo &info);
+    void remove(DWORD pid);
+    // Applies the postings queued since the last call.
+    void endTick();
+
+    // PIDs whose selected fields contain `text`, ignoring case; at most `limit`.
+    [[nodiscard]] std::vector<DWORD> search(std::wstring_view text, uint32_t fields = FieldAll,
+                                            size_t limit = SIZE_MAX) const;
+
+    [[nodiscard]] size_t size() const { return slot_by_pid_.size(); }
+
+private:
+    static constexpr size_t FieldCount = 3;
+
+    struct Document {
+        DWORD pid = 0;
+        std::array<std::wstring, FieldCount> text;  // folded
+    };
+
+    static uint64_t gramKey(size_t field, const wchar_t *gram);
+    static void gramsOf(size_t field, std::wstring_view text, std::vector<uint64_t> &out);
+
+    struct PendingPostings {
+        std::vector<uint32_t> added;
+        std::vector<uint32_t> removed;
+    };
+
+    void gramsOf(const Document &doc);
+
+    std::vector<Document> documents_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<uint32_t> released_slots_;  // still in posting lists until endTick()
+    std::unordered_map<DWORD, uint32_t> slot_by_pid_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> postings_;
+    std::unordered_map<uint64_t, PendingPostings> pending_;
+    std::vector<uint64_t> scratch_grams_;
+    std::vector<uint32_t> scratch_list_;
+};
+
+#endif
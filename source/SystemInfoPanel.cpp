@@ -35,6 +35,11 @@ bool SystemInfoPanel::Create(const int x, const int y, const int width, const in
                                 0, 0, 10, 10,
                                 hwnd_parent_, reinterpret_cast<HMENU>(IDC_STATIC_RAM_AVAIL_LABEL), nullptr, nullptr);
 
+    hwnd_cpu_usage_label_ = CreateWindowW(WC_STATICW, L"CPU Usage:",
+                                WS_CHILD | WS_VISIBLE | SS_LEFTNOWORDWRAP,
+                                0, 0, 10, 10,
+                                hwnd_parent_, reinterpret_cast<HMENU>(IDC_STATIC_CPU_USAGE_LABEL), nullptr, nullptr);
+
 
     // --- Create Value Fields (initially "N/A") ---
     hwnd_os_value_ = CreateWindowW(WC_STATICW, L"N/A",
@@ -57,8 +62,14 @@ bool SystemInfoPanel::Create(const int x, const int y, const int width, const in
                                      0, 0, 10, 10,
                                      hwnd_parent_, reinterpret_cast<HMENU>(IDC_STATIC_RAM_AVAIL_VALUE), nullptr, nullptr);
 
+    hwnd_cpu_usage_value_ = CreateWindowW(WC_STATICW, L"N/A",
+                                     WS_CHILD | WS_VISIBLE | SS_LEFTNOWORDWRAP,
+                                     0, 0, 10, 10,
+                                     hwnd_parent_, reinterpret_cast<HMENU>(IDC_STATIC_CPU_USAGE_VALUE), nullptr, nullptr);
+
     if (!hwnd_os_label_ || !hwnd_os_value_ || !hwnd_cpu_label_ || !hwnd_cpu_value_ ||
-        !hwnd_ram_total_label_ || !hwnd_ram_total_value_ || !hwnd_ram_avail_label_ || !hwnd_ram_avail_value_)
+        !hwnd_ram_total_label_ || !hwnd_ram_total_value_ || !hwnd_ram_avail_label_ || !hwnd_ram_avail_value_ ||
+        !hwnd_cpu_usage_label_ || !hwnd_cpu_usage_value_)
     {
         return false;
     }
@@ -95,10 +106,15 @@ void SystemInfoPanel::RepositionControls() const {
     // Available RAM
     if (hwnd_ram_avail_label_) MoveWindow(hwnd_ram_avail_label_, labelX, currentYPos, LABEL_WIDTH, CONTROL_HEIGHT, TRUE);
     if (hwnd_ram_avail_value_) MoveWindow(hwnd_ram_avail_value_, valueX, currentYPos, valueWidth, CONTROL_HEIGHT, TRUE);
+    currentYPos += CONTROL_HEIGHT + PADDING;
+
+    // CPU Usage
+    if (hwnd_cpu_usage_label_) MoveWindow(hwnd_cpu_usage_label_, labelX, currentYPos, LABEL_WIDTH, CONTROL_HEIGHT, TRUE);
+    if (hwnd_cpu_usage_value_) MoveWindow(hwnd_cpu_usage_value_, valueX, currentYPos, valueWidth, CONTROL_HEIGHT, TRUE);
 }
 
 void SystemInfoPanel::Resize(const int parentWidth, const int parentHeight) {
-    current_y_ = parentHeight - 160 - PADDING;
+    current_y_ = parentHeight - 190 - PADDING;
     current_width_ = parentWidth;
     current_height_ = parentHeight; // Store new dimensions
     RepositionControls(); // Recalculate layout
@@ -127,3 +143,9 @@ void SystemInfoPanel::SetAvailableRam(const std::wstring& text) const {
         SetWindowTextW(hwnd_ram_avail_value_, text.c_str());
     }
 }
+
+void SystemInfoPanel::SetCpuUsage(const std::wstring& text) const {
+    if (hwnd_cpu_usage_value_) {
+        SetWindowTextW(hwnd_cpu_usage_value_, text.c_str());
+    }
+}
@@ -12,6 +12,8 @@ constexpr int IDC_STATIC_RAM_TOTAL_LABEL = 105;
 constexpr int IDC_STATIC_RAM_TOTAL_VALUE = 106;
 constexpr int IDC_STATIC_RAM_AVAIL_LABEL = 107;
 constexpr int IDC_STATIC_RAM_AVAIL_VALUE = 108;
+constexpr int IDC_STATIC_CPU_USAGE_LABEL = 109;
+constexpr int IDC_STATIC_CPU_USAGE_VALUE = 110;
 
 class SystemInfoPanel {
 public:
@@ -31,6 +33,7 @@ public:
     void SetCpuInfo(const std::wstring& text) const;
     void SetTotalRam(const std::wstring& text) const;
     void SetAvailableRam(const std::wstring& text) const;
+    void SetCpuUsage(const std::wstring& text) const;
 
 private:
     HWND hwnd_parent_ = nullptr;
@@ -43,6 +46,8 @@ private:
     HWND hwnd_ram_total_value_ = nullptr;
     HWND hwnd_ram_avail_label_ = nullptr;
     HWND hwnd_ram_avail_value_ = nullptr;
+    HWND hwnd_cpu_usage_label_ = nullptr;
+    HWND hwnd_cpu_usage_value_ = nullptr;
 
     int current_x_ = 0;
     int current_y_ = 0;
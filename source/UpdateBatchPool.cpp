@@ -0,0 +1,47 @@
+#include "UpdateBatchPool.h"
+
+void UpdateBatchRecycler::operator()(ProcessUpdateData *batch) const {
+    if (pool) {
+        pool->recycle(batch);
+    } else {
+        delete batch;
+    }
+}
+
+UpdateBatch UpdateBatchPool::acquire() {
+    std::unique_ptr<ProcessUpdateData> batch;
+    {
+        std::scoped_lock lk(mtx_);
+        if (!free_.empty()) {
+            batch = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    if (!batch) {
+        batch = std::make_unique<ProcessUpdateData>();
+    }
+    return UpdateBatch(batch.release(), UpdateBatchRecycler{shared_from_this()});
+}
+
+void UpdateBatchPool::recycle(ProcessUpdateData *batch) {
+    if (!batch) {
+        return;
+    }
+    std::unique_ptr<ProcessUpdateData> owned(batch);
+    // Clearing here keeps the consumer's thread, not the collector, paying for
+    // freeing added records' strings.
+    owned->added.clear();
+    owned->removed_pids.clear();
+    owned->updated.clear();
+    owned->transient.clear();
+
+    std::scoped_lock lk(mtx_);
+    if (free_.size() < max_pooled_) {
+        free_.push_back(std::move(owned));
+    }
+}
+
+size_t UpdateBatchPool::pooled() const {
+    std::scoped_lock lk(mtx_);
+    return free_.size();
+}
@@ -0,0 +1,40 @@
+#ifndef UpdateBatchPool_h
+#define UpdateBatchPool_h
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ProcessInfo.h"
+
+class UpdateBatchPool;
+
+// Returns a batch to its pool instead of deleting it.
+struct UpdateBatchRecycler {
+    std::shared_ptr<UpdateBatchPool> pool;
+    void operator()(ProcessUpdateData *batch) const;
+};
+
+// A ProcessUpdateData on loan from a pool; dropping it hands it back.
+using UpdateBatch = std::unique_ptr<ProcessUpdateData, UpdateBatchRecycler>;
+
+// Recycles ProcessUpdateData between the producer and its consumers. Returned
+// batches are cleared but keep their vectors' capacity, so once the pool has
+// warmed up a tick publishes without allocating the batch or its arrays.
+class UpdateBatchPool : public std::enable_shared_from_this<UpdateBatchPool> {
+public:
+    explicit UpdateBatchPool(const size_t maxPooled = 8) : max_pooled_(maxPooled) { free_.reserve(max_pooled_); }
+
+    UpdateBatch acquire();
+
+    void recycle(ProcessUpdateData *batch);
+
+    [[nodiscard]] size_t pooled() const;
+
+private:
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<ProcessUpdateData>> free_;
+    size_t max_pooled_;
+};
+
+#endif
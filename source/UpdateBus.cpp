@@ -0,0 +1,138 @@
+#include "UpdateBus.h"
+
+#include <algorithm>
+
+UpdateBus::UpdateBus(const size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 2)),
+      slots_(std::make_unique<std::atomic<uint64_t>[]>(capacity_)) {}
+
+UpdateBus::~UpdateBus() {
+    // No subscription is left (each holds the bus), so nobody is mid-pickup.
+    for (size_t i = 0; i < capacity_; ++i) {
+        retire(slots_[i].exchange(0, std::memory_order_acq_rel));
+    }
+}
+
+void UpdateBus::drop(const Tick *tick, const int64_t count) {
+    if (tick && tick->refs_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+        delete tick;
+    }
+}
+
+void UpdateBus::retire(const uint64_t word) {
+    const Tick *tick = tickIn(word);
+    if (!tick) {
+        return;
+    }
+    // The ring's own reference goes; each reader still counted in the word
+    // gets one in its place, which it gives back once it sees the swap.
+    if (const auto pickups = static_cast<int64_t>(word / OneReader); pickups > 0) {
+        tick->refs_.fetch_add(pickups - 1, std::memory_order_release);
+    } else {
+        drop(tick);
+    }
+}
+
+UpdateBus::TickPtr UpdateBus::acquire(const uint64_t sequence) const {
+    std::atomic<uint64_t> &word = slot(sequence);
+    // Counted in the word, the Tick cannot be freed before it counts us itself.
+    const Tick *tick = tickIn(word.fetch_add(OneReader, std::memory_order_acquire));
+    if (tick) {
+        tick->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t current = word.load(std::memory_order_relaxed);
+    while (tickIn(current) == tick) {
+        if (word.compare_exchange_weak(current, current - OneReader, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+            return TickPtr(tick);
+        }
+    }
+    // Swapped out meanwhile: retire() turned our pickup into a reference.
+    if (tick) {
+        tick->refs_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return TickPtr(tick);
+}
+
+UpdateBus::Subscription UpdateBus::subscribe() {
+    snapshot_wanted_.store(true, std::memory_order_release);
+    return Subscription(shared_from_this());
+}
+
+void UpdateBus::publish(UpdateBatch diff, std::shared_ptr<const Snapshot> snapshot) {
+    if (snapshot) {
+        // Readers that ask from here on want a newer one.
+        snapshot_wanted_.store(false, std::memory_order_release);
+    }
+    const uint64_t sequence = head_.load(std::memory_order_relaxed) + 1;
+    auto *tick = new Tick;
+    tick->sequence = sequence;
+    tick->diff = std::move(diff);
+    tick->snapshot = std::move(snapshot);
+
+    // The tick this replaces is released here unless a reader still holds it.
+    retire(slot(sequence).exchange(reinterpret_cast<uintptr_t>(tick), std::memory_order_acq_rel));
+    head_.store(sequence, std::memory_order_release);
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_all();
+}
+
+void UpdateBus::close() {
+    closed_.store(true, std::memory_order_release);
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_all();
+}
+
+UpdateBus::TickPtr UpdateBus::Subscription::next() {
+    while (true) {
+        // Read before looking, so a publish in between is not slept through.
+        const uint32_t wake = bus_->wake_.load(std::memory_order_acquire);
+        if (TickPtr tick = tryNext()) {
+            return tick;
+        }
+        if (bus_->closed_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        bus_->wake_.wait(wake, std::memory_order_acquire);
+    }
+}
+
+UpdateBus::TickPtr UpdateBus::Subscription::tryNext() {
+    const uint64_t head = bus_->head_.load(std::memory_order_acquire);
+    if (next_ != 0) {
+        if (next_ > head) {
+            return nullptr;
+        }
+        if (head - next_ < bus_->capacity_) {
+            // The slot may have been reused since `head` was read; the
+            // sequence says whether it still holds the tick wanted.
+            if (TickPtr tick = bus_->acquire(next_); tick && tick->sequence == next_) {
+                ++next_;
+                resynced_ = false;
+                return tick;
+            }
+        }
+        lost_ = next_;
+        next_ = 0;
+    }
+
+    // Resume from the newest snapshot still in the ring; any will do, the
+    // diffs after it are in the ring too.
+    for (uint64_t sequence = head; sequence > 0 && head - sequence < bus_->capacity_; --sequence) {
+        const TickPtr tick = bus_->acquire(sequence);
+        if (!tick || tick->sequence != sequence) {
+            break;  // overwritten while scanning
+        }
+        if (tick->snapshot) {
+            if (lost_ != 0 && sequence >= lost_) {
+                skipped_ += sequence - lost_;
+            }
+            lost_ = 0;
+            next_ = sequence + 1;
+            resynced_ = true;
+            return tick;
+        }
+    }
+    bus_->snapshot_wanted_.store(true, std::memory_order_release);
+    return nullptr;
+}
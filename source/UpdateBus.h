@@ -0,0 +1,152 @@
+#ifndef UpdateBus_h
+#define UpdateBus_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ProcessInfo.h"
+#include "UpdateBatchPool.h"
+
+// Broadcasts the monitor's ticks to any number of readers, each at its own
+// pace.
+//
+// Every tick is published once as an immutable, reference-counted Tick into
+// a fixed ring of slots, and readers keep their own position. The ring is
+// lock-free on both sides. A slot is one 64-bit word holding the Tick's
+// pointer and, in its top bits, how many readers are picking it up right now
+// (split reference counting). A reader counts itself into the word, takes a
+// reference on the Tick, then counts itself back out. When the producer swaps
+// a Tick out, it moves any readers still counted in the word onto the Tick's
+// own count, so the Tick cannot be freed under them. The producer overwrites
+// the oldest slot regardless of who has read it, so a slow reader cannot
+// stall it: the reader notices the gap, asks for a snapshot, and resumes from
+// the next tick that carries one. A new reader starts the same way.
+//
+// Snapshots cost a copy of the whole table, so the producer only builds one
+// when a reader has asked (snapshotWanted()). A Tick stays alive while any
+// reader holds it; its diff then goes back to the monitor's batch pool.
+class UpdateBus : public std::enable_shared_from_this<UpdateBus> {
+public:
+    using Snapshot = std::vector<ProcessInfo>;
+    class TickPtr;
+
+    struct Tick {
+        uint64_t sequence = 0;                     // counted from 1
+        UpdateBatch diff;                          // may be empty on a tick published only for its snapshot
+        std::shared_ptr<const Snapshot> snapshot;  // the table after `diff`; set when a reader asked
+
+    private:
+        friend class UpdateBus;
+        friend class TickPtr;
+        mutable std::atomic<int64_t> refs_{1};  // the ring's reference plus every TickPtr
+    };
+
+    // A counted reference to a Tick, used like shared_ptr<const Tick>; the
+    // count lives in the Tick so the ring can hand one out without a lock.
+    class TickPtr {
+    public:
+        TickPtr() = default;
+        TickPtr(std::nullptr_t) {}
+        TickPtr(const TickPtr &other) : tick_(other.tick_) {
+            if (tick_) {
+                tick_->refs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        TickPtr(TickPtr &&other) noexcept : tick_(std::exchange(other.tick_, nullptr)) {}
+        TickPtr &operator=(TickPtr other) noexcept {
+            std::swap(tick_, other.tick_);
+            return *this;
+        }
+        ~TickPtr() { UpdateBus::drop(tick_); }
+
+        const Tick *get() const { return tick_; }
+        const Tick *operator->() const { return tick_; }
+        const Tick &operator*() const { return *tick_; }
+        explicit operator bool() const { return tick_ != nullptr; }
+
+    private:
+        friend class UpdateBus;
+        explicit TickPtr(const Tick *tick) : tick_(tick) {}  // adopts one reference
+
+        const Tick *tick_ = nullptr;
+    };
+
+    // One reader's position. Not thread-safe; give each reading thread its
+    // own. Holds the bus alive.
+    class Subscription {
+    public:
+        // The next tick for this reader; blocks until there is one. Null once
+        // the bus is closed and everything published has been read.
+        TickPtr next();
+        // Like next(), but null right away when there is nothing new.
+        TickPtr tryNext();
+
+        // The tick last returned follows a gap (or is the first): rebuild
+        // from its snapshot instead of applying its diff.
+        [[nodiscard]] bool resynced() const { return resynced_; }
+        // Ticks this reader missed; their effect is in the snapshots it
+        // resumed from.
+        [[nodiscard]] uint64_t skipped() const { return skipped_; }
+
+    private:
+        friend class UpdateBus;
+        explicit Subscription(std::shared_ptr<UpdateBus> bus) : bus_(std::move(bus)) {}
+
+        std::shared_ptr<UpdateBus> bus_;
+        uint64_t next_ = 0;   // sequence wanted next; 0 until a snapshot is in hand
+        uint64_t lost_ = 0;   // first sequence missed, while resyncing
+        bool resynced_ = false;
+        uint64_t skipped_ = 0;
+    };
+
+    // capacity bounds both how far a reader may lag and how many ticks (and
+    // their batches) the ring keeps alive.
+    explicit UpdateBus(size_t capacity = 16);
+    ~UpdateBus();
+
+    UpdateBus(const UpdateBus&) = delete;
+    UpdateBus& operator=(const UpdateBus&) = delete;
+
+    [[nodiscard]] Subscription subscribe();
+
+    // Producer side; one thread at a time.
+    [[nodiscard]] bool snapshotWanted() const { return snapshot_wanted_.load(std::memory_order_acquire); }
+    void publish(UpdateBatch diff, std::shared_ptr<const Snapshot> snapshot = nullptr);
+    // Wakes every blocked reader; next() returns null once drained.
+    void close();
+
+    [[nodiscard]] uint64_t published() const { return head_.load(std::memory_order_acquire); }
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+
+private:
+    // A slot word: the Tick's address in the low 48 bits (user-mode addresses
+    // fit on every 64-bit Windows), readers mid-pickup above.
+    static constexpr uint64_t OneReader = uint64_t{1} << 48;
+    static constexpr uint64_t AddressMask = OneReader - 1;
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    static const Tick *tickIn(const uint64_t word) {
+        return reinterpret_cast<const Tick *>(static_cast<uintptr_t>(word & AddressMask));
+    }
+    // Drops `count` references; the last one frees the Tick.
+    static void drop(const Tick *tick, int64_t count = 1);
+    // Settles a word swapped out of a slot: its pickups move onto the Tick.
+    static void retire(uint64_t word);
+
+    std::atomic<uint64_t> &slot(const uint64_t sequence) const { return slots_[sequence % capacity_]; }
+    // The Tick in sequence's slot, whatever sequence it now holds; null if empty.
+    TickPtr acquire(uint64_t sequence) const;
+
+    const size_t capacity_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    std::atomic<uint64_t> head_{0};     // sequence of the newest tick
+    std::atomic<uint32_t> wake_{0};     // bumped on every publish and on close, for blocked readers
+    std::atomic<bool> snapshot_wanted_{false};
+    std::atomic<bool> closed_{false};
+};
+
+#endif